@@ -4,12 +4,14 @@
 #include "guis/GuiInfoPopup.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
+#include "utils/ThreadPool.h"
 #include "views/gamelist/IGameListView.h"
 #include "views/gamelist/ISimpleGameListView.h"
 #include "views/ViewController.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "PlayStatsJournal.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include "ThemeData.h"
@@ -178,6 +180,8 @@ void CollectionSystemManager::updateSystemsList()
 {
 	// remove all Collection Systems
 	removeCollectionsFromDisplayedSystems();
+	// populate the enabled ones not populated yet
+	populateCollections();
 	// add custom enabled ones
 	addEnabledCollectionsToDisplayedSystems(&mCustomCollectionSystemsData, false);
 
@@ -214,13 +218,6 @@ void CollectionSystemManager::updateSystemsList()
 	// finally, add random
 	addEnabledCollectionsToDisplayedSystems(&mAutoCollectionSystemsData, true);
 
-	// create views for collections, before reload
-	for(auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
-	{
-		if ((*sysIt)->isCollection())
-			ViewController::get()->getGameListView((*sysIt));
-	}
-
 	// if we were editing a custom collection, and it's no longer enabled, exit edit mode
 	if(mIsEditingCustom && !mEditingCollectionSystemData->isEnabled)
 	{
@@ -268,7 +265,7 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			// found and we are removing
 			if (name == "favorites" && file->metadata.get("favorite") == "false") {
 				// need to check if still marked as favorite, if not remove
-				ViewController::get()->getGameListView(curSys).get()->remove(collectionEntry, false, true);
+				removeCollectionEntry(curSys, collectionEntry, true);
 			}
 			else
 			{
@@ -280,13 +277,15 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 		else
 		{
 			// we didn't find it here - we need to check if we should add it
-			if (name == "recent" && file->metadata.get("playcount") > "0" && includeFileInAutoCollections(file) ||
+			if (name == "recent" && PlayStatsJournal::getInstance()->getPlayCount(file) > 0 && includeFileInAutoCollections(file) ||
 				name == "favorites" && file->metadata.get("favorite") == "true") {
 				CollectionFileData* newGame = new CollectionFileData(file, curSys);
 				rootFolder->addChild(newGame);
 				fileIndex->addToIndex(newGame);
 				ViewController::get()->onFileChanged(file, FILE_METADATA_CHANGED);
-				ViewController::get()->getGameListView(curSys)->onFileChanged(newGame, FILE_METADATA_CHANGED);
+				std::shared_ptr<IGameListView> view = ViewController::get()->findGameListView(curSys);
+				if (view)
+					view->onFileChanged(newGame, FILE_METADATA_CHANGED);
 			}
 		}
 		rootFolder->sort(getSortTypeFromString(mCollectionSystemDeclsIndex[name].defaultSort));
@@ -295,7 +294,9 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, CollectionS
 			trimCollectionCount(rootFolder, LAST_PLAYED_MAX, false);
 			ViewController::get()->onFileChanged(rootFolder, FILE_METADATA_CHANGED);
 			// Force re-calculation of cursor position
-			ViewController::get()->getGameListView(curSys)->setViewportTop(TextListComponent<FileData>::REFRESH_LIST_CURSOR_POS);
+			std::shared_ptr<IGameListView> view = ViewController::get()->findGameListView(curSys);
+			if (view)
+				view->setViewportTop(TextListComponent<FileData>::REFRESH_LIST_CURSOR_POS);
 		}
 		else
 			ViewController::get()->onFileChanged(rootFolder, FILE_SORTED);
@@ -312,7 +313,7 @@ void CollectionSystemManager::trimCollectionCount(FileData* rootFolder, int limi
 			std::shuffle(games.begin(), games.end(), SystemData::sURNG);
 
 		CollectionFileData* gameToRemove = (CollectionFileData*)games.back();
-		ViewController::get()->getGameListView(curSys).get()->remove(gameToRemove, false, false);
+		removeCollectionEntry(curSys, gameToRemove, false);
 	}
 	ViewController::get()->onFileChanged(rootFolder, FILE_REMOVED);
 }
@@ -338,7 +339,7 @@ void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 				sysDataIt->second.needsSave = true;
 				FileData* collectionEntry = children.at(key);
 				SystemData* systemViewToUpdate = getSystemToView(sysDataIt->second.system);
-				ViewController::get()->getGameListView(systemViewToUpdate).get()->remove(collectionEntry, false, true);
+				removeCollectionEntry(systemViewToUpdate, collectionEntry, true);
 			}
 		}
 	}
@@ -527,7 +528,7 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 				{
 					systemViewToUpdate->getIndex()->removeFromIndex(collectionEntry);
 				}
-				ViewController::get()->getGameListView(systemViewToUpdate).get()->remove(collectionEntry, false, true);
+				removeCollectionEntry(systemViewToUpdate, collectionEntry, true);
 			}
 			else
 			{
@@ -590,6 +591,17 @@ bool CollectionSystemManager::toggleGameInCollection(FileData* file)
 }
 
 
+// removes a collection entry through the view showing it, a view not built yet is left alone as it is built from
+// the folder once needed
+void CollectionSystemManager::removeCollectionEntry(SystemData* systemToView, FileData* entry, bool refreshView)
+{
+	std::shared_ptr<IGameListView> view = ViewController::get()->findGameListView(systemToView);
+	if (view)
+		view->remove(entry, false, refreshView);
+	else
+		delete entry; // removes it from its parent
+}
+
 SystemData* CollectionSystemManager::getSystemToView(SystemData* sys)
 {
 	SystemData* systemToView = sys;
@@ -639,7 +651,7 @@ void CollectionSystemManager::recreateCollection(SystemData* sysData)
 
 	// while there are games there, remove them from the view and system
 	while(rootFolder->getChildrenByFilename().size() > 0)
-		ViewController::get()->getGameListView(systemViewToUpdate).get()->remove(rootFolder->getChildrenByFilename().begin()->second, false, false);
+		removeCollectionEntry(systemViewToUpdate, rootFolder->getChildrenByFilename().begin()->second, false);
 
 	colSysData->isPopulated = false;
 	if (sysDecl.isCustom)
@@ -651,8 +663,9 @@ void CollectionSystemManager::recreateCollection(SystemData* sysData)
 	ViewController::get()->onFileChanged(systemViewToUpdate->getRootFolder(), FILE_SORTED);
 
 	// Workaround to force video to play
-	FileData* cursor = ViewController::get()->getGameListView(systemViewToUpdate)->getCursor();
-	ViewController::get()->getGameListView(systemViewToUpdate)->setCursor(cursor, true);
+	std::shared_ptr<IGameListView> view = ViewController::get()->findGameListView(systemViewToUpdate);
+	if (view)
+		view->setCursor(view->getCursor(), true);
 
 
 }
@@ -806,25 +819,26 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 }
 
 void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sourceSystem, FileData* rootFolder,
-	FileFilterIndex* index, std::map<std::string, std::map<std::string, int>> mapsForRandomColl, int defaultValue)
+	FileFilterIndex* index, const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl, int defaultValue)
 {
 
 	int gamesForSourceSystem = defaultValue;
 	for (auto& m : mapsForRandomColl)
 	{
 		// m.first unused
-		std::map<std::string, int> collMap = m.second;
-		if (collMap.find(sourceSystem->getFullName()) != collMap.end())
+		const std::map<std::string, int>& collMap = m.second;
+		auto maxIt = collMap.find(sourceSystem->getFullName());
+		if (maxIt != collMap.cend())
 		{
-			int maxForSys = collMap[sourceSystem->getFullName()];
+			int maxForSys = maxIt->second;
 			// we won't add more than the max and less than 0
 			gamesForSourceSystem = Math::max(Math::min(RANDOM_SYSTEM_MAX, maxForSys), 0);
 			break;
 		}
 	}
 
-	// load exclusion collection
-	std::unordered_map<std::string,FileData*> exclusionMap;
+	// load exclusion collection, its files are looked up in place
+	const std::unordered_map<std::string,FileData*>* exclusionMap = NULL;
 	std::string exclusionCollection = Settings::getInstance()->getString("RandomCollectionExclusionCollection");
 	auto sysDataIt = mCustomCollectionSystemsData.find(exclusionCollection);
 
@@ -834,7 +848,7 @@ void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sou
 			populateCustomCollection(&(sysDataIt->second));
 		}
 
-		exclusionMap = mCustomCollectionSystemsData[exclusionCollection].system->getRootFolder()->getChildrenByFilename();
+		exclusionMap = &sysDataIt->second.system->getRootFolder()->getChildrenByFilename();
 
 	}
 
@@ -850,7 +864,7 @@ void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sou
 		FileData* randomGame = sourceSystem->getRandomGame()->getSourceFileData();
 		CollectionFileData* newGame = NULL;
 
-		if(exclusionMap.find(randomGame->getFullPath()) == exclusionMap.end())
+		if(!exclusionMap || exclusionMap->find(randomGame->getFullPath()) == exclusionMap->cend())
 		{
 			// Not in the exclusion collection
 			newGame = new CollectionFileData(randomGame, newSys);
@@ -880,7 +894,7 @@ void CollectionSystemManager::addRandomGames(SystemData* newSys, SystemData* sou
 	}
 }
 
-void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<std::string, std::map<std::string, int>> mapsForRandomColl)
+void CollectionSystemManager::populateRandomCollectionFromCollections(const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl)
 {
 	CollectionSystemData* sysData = &mAutoCollectionSystemsData[RANDOM_COLL_ID];
 	SystemData* newSys = sysData->system;
@@ -891,7 +905,7 @@ void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<s
 	// iterate the auto collections map
 	for(auto &c : mAutoCollectionSystemsData)
 	{
-		CollectionSystemData csd = c.second;
+		CollectionSystemData& csd = c.second;
 		// we can't add games from the random collection to the random collection
 		if (csd.decl.type != AUTO_RANDOM)
 		{
@@ -907,7 +921,7 @@ void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<s
 	// iterate the custom collections map
 	for(auto &c : mCustomCollectionSystemsData)
 	{
-		CollectionSystemData csd = c.second;
+		CollectionSystemData& csd = c.second;
 		// collections might not be populated
 		if (!csd.isPopulated)
 			populateCustomCollection(&csd);
@@ -917,77 +931,224 @@ void CollectionSystemManager::populateRandomCollectionFromCollections(std::map<s
 	}
 }
 
+// populates the enabled collections not populated yet, all of them when the random collection picks from
+// them. "all games" goes first, custom collections look their games up in it. The other collections only
+// read the game systems and "all games" and write nothing but themselves, they are filled in parallel.
+// Random picks from the others and is populated last.
+void CollectionSystemManager::populateCollections()
+{
+	CollectionSystemData* randomData = &mAutoCollectionSystemsData[RANDOM_COLL_ID];
+	const bool forRandom = randomData->isEnabled && !randomData->isPopulated;
+
+	std::vector<CollectionSystemData*> autoPending;
+	std::vector<CollectionSystemData*> customPending;
+
+	for(auto it = mAutoCollectionSystemsData.begin(); it != mAutoCollectionSystemsData.end(); it++)
+	{
+		if (it->second.decl.type != AUTO_RANDOM && it->second.decl.type != AUTO_ALL_GAMES && !it->second.isPopulated && (forRandom || it->second.isEnabled))
+			autoPending.push_back(&(it->second));
+	}
+
+	for(auto it = mCustomCollectionSystemsData.begin(); it != mCustomCollectionSystemsData.end(); it++)
+	{
+		if (!it->second.isPopulated && (forRandom || it->second.isEnabled))
+			customPending.push_back(&(it->second));
+	}
+
+	CollectionSystemData* allData = &mAutoCollectionSystemsData["all"];
+	const bool allPending = !allData->isPopulated && (forRandom || allData->isEnabled || !customPending.empty());
+
+	if (!allPending && autoPending.empty() && customPending.empty() && !forRandom)
+		return;
+
+	const Uint32 start = SDL_GetTicks();
+
+	if (allPending)
+	{
+		populateAutoCollection(allData);
+		LOG(LogDebug) << "Populated collection 'all' with " << allData->system->getRootFolder()->getChildren().size() << " games in " << (SDL_GetTicks() - start) << "ms";
+	}
+
+	// shared by every custom collection, nothing is added to "all games" until they are done
+	const std::unordered_map<std::string, FileData*>& allFilesMap = allData->system->getRootFolder()->getChildrenByFilename();
+
+	std::vector<Uint32> autoTimes(autoPending.size(), 0);
+	std::vector<Uint32> customTimes(customPending.size(), 0);
+	std::vector<char> customFilled(customPending.size(), 0);
+
+	const Uint32 parallelStart = SDL_GetTicks();
+
+	Utils::ThreadPool* pool = NULL;
+	if (std::thread::hardware_concurrency() > 2 && Settings::getInstance()->getBool("ThreadedLoading"))
+		pool = new Utils::ThreadPool();
+
+	for (size_t i = 0; i < autoPending.size(); i++)
+	{
+		CollectionSystemData* sysData = autoPending[i];
+		Uint32* time = &autoTimes[i];
+		auto work = [this, sysData, time]
+		{
+			const Uint32 taskStart = SDL_GetTicks();
+			fillAutoCollection(sysData);
+			*time = SDL_GetTicks() - taskStart;
+		};
+
+		if (pool)
+			pool->queueWorkItem(work);
+		else
+			work();
+	}
+
+	for (size_t i = 0; i < customPending.size(); i++)
+	{
+		CollectionSystemData* sysData = customPending[i];
+		Uint32* time = &customTimes[i];
+		char* filled = &customFilled[i];
+		auto work = [this, sysData, time, filled, &allFilesMap]
+		{
+			const Uint32 taskStart = SDL_GetTicks();
+			*filled = fillCustomCollection(sysData, allFilesMap);
+			*time = SDL_GetTicks() - taskStart;
+		};
+
+		if (pool)
+			pool->queueWorkItem(work);
+		else
+			work();
+	}
+
+	if (pool)
+	{
+		pool->wait();
+		delete pool;
+	}
+
+	const Uint32 parallelTime = SDL_GetTicks() - parallelStart;
+
+	// trimming creates views and describing picks random games, both stay on this thread
+	for (size_t i = 0; i < autoPending.size(); i++)
+	{
+		finishAutoCollection(autoPending[i]);
+		LOG(LogDebug) << "Populated collection '" << autoPending[i]->system->getName() << "' with " << autoPending[i]->system->getRootFolder()->getChildren().size() << " games in " << autoTimes[i] << "ms";
+	}
+
+	for (size_t i = 0; i < customPending.size(); i++)
+	{
+		if (!customFilled[i])
+			continue;
+
+		updateCollectionFolderMetadata(customPending[i]->system);
+		customPending[i]->isPopulated = true;
+		LOG(LogDebug) << "Populated collection '" << customPending[i]->system->getName() << "' with " << customPending[i]->system->getRootFolder()->getChildren().size() << " games in " << customTimes[i] << "ms";
+	}
+
+	if (forRandom)
+	{
+		const Uint32 randomStart = SDL_GetTicks();
+		populateAutoCollection(randomData);
+		LOG(LogDebug) << "Populated collection '" << RANDOM_COLL_ID << "' with " << randomData->system->getRootFolder()->getChildren().size() << " games in " << (SDL_GetTicks() - randomStart) << "ms";
+	}
+
+	LOG(LogInfo) << "Populated " << (autoPending.size() + customPending.size() + (allPending ? 1 : 0) + (forRandom ? 1 : 0)) << " collections in " << (SDL_GetTicks() - start)
+		<< "ms, " << (autoPending.size() + customPending.size()) << " of them in parallel in " << parallelTime << "ms";
+}
+
 // populates an Automatic Collection System
 void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData)
+{
+	if (sysData->decl.type == AUTO_RANDOM)
+		fillRandomCollection(sysData);
+	else
+		fillAutoCollection(sysData);
+
+	finishAutoCollection(sysData);
+}
+
+// adds the games of every game system matching an automatic collection other than random
+void CollectionSystemManager::fillAutoCollection(CollectionSystemData* sysData)
 {
 	SystemData* newSys = sysData->system;
-	CollectionSystemDecl sysDecl = sysData->decl;
+	const CollectionSystemDecl& sysDecl = sysData->decl;
 	FileData* rootFolder = newSys->getRootFolder();
 	FileFilterIndex* index = newSys->getIndex();
 
-	std::map<std::string, std::map<std::string, int>> mapsForRandomColl;
-	if (sysDecl.type == AUTO_RANDOM)
-	{
-		// user may have defined a custom collection with the same name as a system name, thus keeping maps in another map
-		std::map<std::string, int> randomSystems = Settings::getInstance()->getMap("RandomCollectionSystems");
-		mapsForRandomColl["RandomCollectionSystems"] = randomSystems;
-		std::map<std::string, int> randomAutoColl = Settings::getInstance()->getMap("RandomCollectionSystemsAuto");
-		mapsForRandomColl["RandomCollectionSystemsAuto"] = randomAutoColl;
-		std::map<std::string, int> randomCustColl = Settings::getInstance()->getMap("RandomCollectionSystemsCustom");
-		mapsForRandomColl["RandomCollectionSystemsCustom"] = randomCustColl;
-	}
 	// Only iterate through game systems, not collections yet
 	for(auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
 	{
 		// we won't iterate all collections
 		if ((*sysIt)->isGameSystem() && !(*sysIt)->isCollection())
 		{
-			if (sysDecl.type == AUTO_RANDOM)
-			{
-				addRandomGames(newSys, *sysIt, rootFolder, index, mapsForRandomColl, DEFAULT_RANDOM_SYSTEM_GAMES);
-			}
-			else
+			std::vector<FileData*> files = (*sysIt)->getRootFolder()->getFilesRecursive(GAME);
+
+			for(auto gameIt = files.cbegin(); gameIt != files.cend(); gameIt++)
 			{
-				std::vector<FileData*> files = (*sysIt)->getRootFolder()->getFilesRecursive(GAME);
+				bool include = includeFileInAutoCollections(*gameIt);
+				switch(sysDecl.type) {
+					case AUTO_LAST_PLAYED:
+						include = include && PlayStatsJournal::getInstance()->getPlayCount(*gameIt) > 0;
+						break;
+					case AUTO_FAVORITES:
+						// we may still want to add files we don't want in auto collections in "favorites"
+						include = (*gameIt)->metadata.get("favorite") == "true";
+						break;
+					case AUTO_ALL_GAMES:
+						break;
+					default:
+						// No-op to prevent compiler warnings
+						// Getting here means that the file is not part of a pre-defined collection.
+						include = false;
+						break;
+				}
 
-				for(auto gameIt = files.cbegin(); gameIt != files.cend(); gameIt++)
+				if (include)
 				{
-					bool include = includeFileInAutoCollections(*gameIt);
-					switch(sysDecl.type) {
-						case AUTO_LAST_PLAYED:
-							include = include && (*gameIt)->metadata.get("playcount") > "0";
-							break;
-						case AUTO_FAVORITES:
-							// we may still want to add files we don't want in auto collections in "favorites"
-							include = (*gameIt)->metadata.get("favorite") == "true";
-							break;
-						case AUTO_ALL_GAMES:
-							break;
-						default:
-							// No-op to prevent compiler warnings
-							// Getting here means that the file is not part of a pre-defined collection.
-							include = false;
-							break;
-					}
-
-					if (include)
-					{
-						CollectionFileData* newGame = new CollectionFileData(*gameIt, newSys);
-						rootFolder->addChild(newGame);
-						index->addToIndex(newGame);
-					}
+					CollectionFileData* newGame = new CollectionFileData(*gameIt, newSys);
+					rootFolder->addChild(newGame);
+					index->addToIndex(newGame);
 				}
 			}
 		}
 	}
 
+	// sort before optional trimming, if collection is displayed
+	if (sysData->isEnabled)
+		rootFolder->sort(getSortTypeFromString(sysDecl.defaultSort));
+}
+
+// adds random games of the game systems and the other collections, populating those as needed
+void CollectionSystemManager::fillRandomCollection(CollectionSystemData* sysData)
+{
+	SystemData* newSys = sysData->system;
+	const CollectionSystemDecl& sysDecl = sysData->decl;
+	FileData* rootFolder = newSys->getRootFolder();
+	FileFilterIndex* index = newSys->getIndex();
+
+	// user may have defined a custom collection with the same name as a system name, thus keeping maps in another map
+	std::map<std::string, std::map<std::string, int>> mapsForRandomColl;
+	mapsForRandomColl["RandomCollectionSystems"] = Settings::getInstance()->getMap("RandomCollectionSystems");
+	mapsForRandomColl["RandomCollectionSystemsAuto"] = Settings::getInstance()->getMap("RandomCollectionSystemsAuto");
+	mapsForRandomColl["RandomCollectionSystemsCustom"] = Settings::getInstance()->getMap("RandomCollectionSystemsCustom");
+
+	// Only iterate through game systems, not collections yet
+	for(auto sysIt = SystemData::sSystemVector.cbegin(); sysIt != SystemData::sSystemVector.cend(); sysIt++)
+	{
+		// we won't iterate all collections
+		if ((*sysIt)->isGameSystem() && !(*sysIt)->isCollection())
+			addRandomGames(newSys, *sysIt, rootFolder, index, mapsForRandomColl, DEFAULT_RANDOM_SYSTEM_GAMES);
+	}
+
 	// here we finish populating the Random collection based on other Collections
-	if (sysDecl.type == AUTO_RANDOM)
-		populateRandomCollectionFromCollections(mapsForRandomColl);
+	populateRandomCollectionFromCollections(mapsForRandomColl);
 
 	// sort before optional trimming, if collection is displayed
 	if (sysData->isEnabled)
 		rootFolder->sort(getSortTypeFromString(sysDecl.defaultSort));
+}
+
+// trims a filled automatic collection to its maximum size
+void CollectionSystemManager::finishAutoCollection(CollectionSystemData* sysData)
+{
+	const CollectionSystemDecl& sysDecl = sysData->decl;
 
 	if (sysData->isEnabled && (sysDecl.type == AUTO_LAST_PLAYED || sysDecl.type == AUTO_RANDOM))
 	{
@@ -995,7 +1156,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		if (sysDecl.type == AUTO_RANDOM)
 			trimValue = Settings::getInstance()->getInt("RandomCollectionMaxGames");
 		if (trimValue > 0)
-			trimCollectionCount(rootFolder, trimValue, sysDecl.type == AUTO_RANDOM);
+			trimCollectionCount(sysData->system->getRootFolder(), trimValue, sysDecl.type == AUTO_RANDOM);
 	}
 
 	sysData->isPopulated = true;
@@ -1003,15 +1164,25 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 
 // populates a Custom Collection System
 void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sysData)
+{
+	if (!fillCustomCollection(sysData, getAllGamesCollection()->getRootFolder()->getChildrenByFilename()))
+		return;
+
+	updateCollectionFolderMetadata(sysData->system);
+	sysData->isPopulated = true;
+}
+
+// adds the games listed in a custom collection's config file, looked up in allFilesMap
+bool CollectionSystemManager::fillCustomCollection(CollectionSystemData* sysData, const std::unordered_map<std::string, FileData*>& allFilesMap)
 {
 	SystemData* newSys = sysData->system;
-	CollectionSystemDecl sysDecl = sysData->decl;
+	const CollectionSystemDecl& sysDecl = sysData->decl;
 	std::string path = getCustomCollectionConfigPath(newSys->getName());
 
 	if(!Utils::FileSystem::exists(path))
 	{
 		LOG(LogInfo) << "Couldn't find custom collection config file at " << path;
-		return;
+		return false;
 	}
 	LOG(LogInfo) << "Loading custom collection config file at " << path;
 
@@ -1021,9 +1192,6 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 	// get Configuration for this Custom System
 	std::ifstream input(path);
 
-	// get all files map
-	std::unordered_map<std::string,FileData*> allFilesMap = getAllGamesCollection()->getRootFolder()->getChildrenByFilename();
-
 	// iterate list of files in config file
 	for(std::string gameKey; getline(input, gameKey); )
 	{
@@ -1040,8 +1208,7 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 		}
 	}
 	rootFolder->sort(getSortTypeFromString(sysDecl.defaultSort));
-	updateCollectionFolderMetadata(newSys);
-	sysData->isPopulated = true;
+	return true;
 }
 
 /* Handle System View removal and insertion of Collections */
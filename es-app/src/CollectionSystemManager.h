@@ -5,6 +5,7 @@
 #include <map>
 #include <SDL_timer.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class FileData;
@@ -126,11 +127,18 @@ private:
 	void initAutoCollectionSystems();
 	void initCustomCollectionSystems();
 	SystemData* createNewCollectionEntry(std::string name, CollectionSystemDecl sysDecl, const CollectionFlags flags);
+	void populateCollections();
 	void populateAutoCollection(CollectionSystemData* sysData);
 	void populateCustomCollection(CollectionSystemData* sysData);
+	// fill*Collection() add and sort the games, the other collections may be filled at the same time
+	void fillAutoCollection(CollectionSystemData* sysData);
+	bool fillCustomCollection(CollectionSystemData* sysData, const std::unordered_map<std::string, FileData*>& allFilesMap);
+	void fillRandomCollection(CollectionSystemData* sysData);
+	void finishAutoCollection(CollectionSystemData* sysData);
 	void addRandomGames(SystemData* newSys, SystemData* sourceSystem, FileData* rootFolder, FileFilterIndex* index,
-		std::map<std::string, std::map<std::string, int>> mapsForRandomColl, int defaultValue);
-	void populateRandomCollectionFromCollections(std::map<std::string, std::map<std::string, int>> mapsForRandomColl);
+		const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl, int defaultValue);
+	void populateRandomCollectionFromCollections(const std::map<std::string, std::map<std::string, int>>& mapsForRandomColl);
+	void removeCollectionEntry(SystemData* systemToView, FileData* entry, bool refreshView);
 
 	void removeCollectionsFromDisplayedSystems();
 	void addEnabledCollectionsToDisplayedSystems(std::map<std::string, CollectionSystemData>* colSystemData, bool processRandom);
@@ -10,23 +10,33 @@
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
+#include "MediaIndex.h"
 #include "platform.h"
+#include "PlayStatsJournal.h"
 #include "Scripting.h"
 #include "SystemData.h"
 #include "VolumeControl.h"
 #include "Window.h"
 #include <assert.h>
 
+std::atomic<unsigned int> FileData::sDisplayGeneration(1);
+const std::vector<FileData*> FileData::sNoChildren;
+const std::unordered_map<std::string, FileData*> FileData::sNoChildrenByFilename;
+
 FileData::FileData(FileType type, const std::string& path, SystemEnvironmentData* envData, SystemData* system)
-	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mType(type), mPath(path), mSystem(system), mEnvData(envData), mSourceFileData(NULL), mParent(NULL), mFolder(type == FOLDER ? new Folder() : NULL), metadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if(metadata.get("name").empty())
 		metadata.set("name", getDisplayName());
-	mSystemName = system->getName();
 	metadata.resetChangedFlag();
 }
 
+FileData::FileData(FileData* source, SystemData* system)
+	: mType(source->getType()), mSystem(system), mEnvData(source->getSystemEnvData()), mSourceFileData(source), mParent(NULL), mFolder(source->getType() == FOLDER ? new Folder() : NULL), metadata(source->metadata)
+{
+}
+
 FileData::~FileData()
 {
 	if(mParent)
@@ -35,12 +45,17 @@ FileData::~FileData()
 	if(mType == GAME)
 		mSystem->getIndex()->removeFromIndex(this);
 
-	mChildren.clear();
+	delete mFolder;
+}
+
+const std::string& FileData::getSystemName() const
+{
+	return (mSourceFileData ? mSourceFileData : this)->getSystem()->getName();
 }
 
 std::string FileData::getDisplayName() const
 {
-	std::string stem = Utils::FileSystem::getStem(mPath);
+	std::string stem = Utils::FileSystem::getStem(getPath());
 	if(mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO))
 		stem = MameNames::getInstance()->getRealName(stem);
 
@@ -52,6 +67,28 @@ std::string FileData::getCleanName() const
 	return Utils::String::removeParenthesis(this->getDisplayName());
 }
 
+// resolved once, these are called for every entry that is displayed
+static bool useLocalArt()
+{
+	static const SettingHandle<bool> localArt = Settings::getInstance()->getHandle(SettingKeys::LocalArt);
+	return localArt;
+}
+
+// local media is looked up in the MediaIndex, the images folder is listed once instead of stat'ing every candidate
+static std::string findLocalMedia(const std::string& startPath, const std::string& name, const char* const* extList, int extCount)
+{
+	MediaIndex* index = MediaIndex::getInstance();
+
+	for(int i = 0; i < extCount; i++)
+	{
+		std::string path = startPath + "/images/" + name + extList[i];
+		if(index->exists(path))
+			return path;
+	}
+
+	return "";
+}
+
 const std::string FileData::getThumbnailPath() const
 {
 	std::string thumbnail = metadata.get("thumbnail");
@@ -62,18 +99,10 @@ const std::string FileData::getThumbnailPath() const
 		thumbnail = metadata.get("image");
 
 		// no image, try to use local image
-		if(thumbnail.empty() && Settings::getInstance()->getBool("LocalArt"))
+		if(thumbnail.empty() && useLocalArt())
 		{
-			const char* extList[2] = { ".png", ".jpg" };
-			for(int i = 0; i < 2; i++)
-			{
-				if(thumbnail.empty())
-				{
-					std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-					if(Utils::FileSystem::exists(path))
-						thumbnail = path;
-				}
-			}
+			const char* extList[2] = { "-image.png", "-image.jpg" };
+			thumbnail = findLocalMedia(mEnvData->mStartPath, getDisplayName(), extList, 2);
 		}
 	}
 
@@ -95,34 +124,80 @@ const std::string& FileData::getSortName()
 
 const std::vector<FileData*>& FileData::getChildrenListToDisplay() {
 
+	if (!mFolder)
+		return sNoChildren;
+
 	FileFilterIndex* idx = CollectionSystemManager::get()->getSystemToView(mSystem)->getIndex();
 	if (idx->isFiltered()) {
-		mFilteredChildren.clear();
-		for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+		// only filtered again once the children or a filter changed
+		if (mFolder->filteredGeneration != sDisplayGeneration)
 		{
-			if (idx->showFile((*it))) {
-				mFilteredChildren.push_back(*it);
+			mFolder->filteredChildren.clear();
+			for(auto it = mFolder->children.cbegin(); it != mFolder->children.cend(); it++)
+			{
+				if (idx->showFile((*it))) {
+					mFolder->filteredChildren.push_back(*it);
+				}
 			}
+			mFolder->filteredGeneration = sDisplayGeneration;
 		}
 
-		return mFilteredChildren;
+		return mFolder->filteredChildren;
 	}
 	else
 	{
-		return mChildren;
+		return mFolder->children;
 	}
 }
 
+static unsigned char getFirstLetter(FileData* file)
+{
+	const std::string& name = file->getSortName();
+	return name.empty() ? 0 : (unsigned char)toupper((unsigned char)name[0]);
+}
+
+int FileData::getFirstIndexOfLetter(unsigned char letter)
+{
+	if (!mFolder)
+		return -1;
+
+	const std::vector<FileData*>& children = getChildrenListToDisplay();
+	std::vector<int>& firstIndexByLetter = mFolder->firstIndexByLetter;
+
+	for(int attempt = 0; attempt < 2; attempt++)
+	{
+		if (mFolder->letterGeneration != sDisplayGeneration || firstIndexByLetter.empty())
+		{
+			firstIndexByLetter.assign(256, -1);
+			for(int i = 0; i < (int)children.size(); i++)
+			{
+				int& first = firstIndexByLetter[getFirstLetter(children[i])];
+				if (first == -1)
+					first = i;
+			}
+			mFolder->letterGeneration = sDisplayGeneration;
+		}
+
+		// names may change without the list being touched, e.g. by scraping, so the entry found is checked
+		const int index = firstIndexByLetter[letter];
+		if (index == -1 || (index < (int)children.size() && getFirstLetter(children[index]) == letter))
+			return index;
+
+		firstIndexByLetter.clear();
+	}
+
+	return -1;
+}
+
 const std::string FileData::getVideoPath() const
 {
 	std::string video = metadata.get("video");
 
 	// no video, try to use local video
-	if(video.empty() && Settings::getInstance()->getBool("LocalArt"))
+	if(video.empty() && useLocalArt())
 	{
-		std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-video.mp4";
-		if(Utils::FileSystem::exists(path))
-			video = path;
+		const char* extList[1] = { "-video.mp4" };
+		video = findLocalMedia(mEnvData->mStartPath, getDisplayName(), extList, 1);
 	}
 
 	return video;
@@ -133,18 +208,10 @@ const std::string FileData::getMarqueePath() const
 	std::string marquee = metadata.get("marquee");
 
 	// no marquee, try to use local marquee
-	if(marquee.empty() && Settings::getInstance()->getBool("LocalArt"))
+	if(marquee.empty() && useLocalArt())
 	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(marquee.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-marquee" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					marquee = path;
-			}
-		}
+		const char* extList[2] = { "-marquee.png", "-marquee.jpg" };
+		marquee = findLocalMedia(mEnvData->mStartPath, getDisplayName(), extList, 2);
 	}
 
 	return marquee;
@@ -157,16 +224,8 @@ const std::string FileData::getImagePath() const
 	// no image, try to use local image
 	if(image.empty())
 	{
-		const char* extList[2] = { ".png", ".jpg" };
-		for(int i = 0; i < 2; i++)
-		{
-			if(image.empty())
-			{
-				std::string path = mEnvData->mStartPath + "/images/" + getDisplayName() + "-image" + extList[i];
-				if(Utils::FileSystem::exists(path))
-					image = path;
-			}
-		}
+		const char* extList[2] = { "-image.png", "-image.jpg" };
+		image = findLocalMedia(mEnvData->mStartPath, getDisplayName(), extList, 2);
 	}
 
 	return image;
@@ -176,8 +235,9 @@ std::vector<FileData*> FileData::getFilesRecursive(unsigned int typeMask, bool d
 {
 	std::vector<FileData*> out;
 	FileFilterIndex* idx = mSystem->getIndex();
+	const std::vector<FileData*>& children = getChildren();
 
-	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+	for(auto it = children.cbegin(); it != children.cend(); it++)
 	{
 		if((*it)->getType() & typeMask)
 		{
@@ -201,7 +261,7 @@ std::string FileData::getKey() {
 
 const bool FileData::isArcadeAsset()
 {
-	const std::string stem = Utils::FileSystem::getStem(mPath);
+	const std::string stem = Utils::FileSystem::getStem(getPath());
 	return (
 		(mSystem && (mSystem->hasPlatformId(PlatformIds::ARCADE) || mSystem->hasPlatformId(PlatformIds::NEOGEO)))
 		&&
@@ -220,11 +280,12 @@ void FileData::addChild(FileData* file)
 	assert(file->getParent() == NULL);
 
 	const std::string key = file->getKey();
-	if (mChildrenByFilename.find(key) == mChildrenByFilename.cend())
+	if (mFolder->childrenByFilename.find(key) == mFolder->childrenByFilename.cend())
 	{
-		mChildrenByFilename[key] = file;
-		mChildren.push_back(file);
+		mFolder->childrenByFilename[key] = file;
+		mFolder->children.push_back(file);
 		file->mParent = this;
+		invalidateDisplayLists();
 	}
 }
 
@@ -232,13 +293,14 @@ void FileData::removeChild(FileData* file)
 {
 	assert(mType == FOLDER);
 	assert(file->getParent() == this);
-	mChildrenByFilename.erase(file->getKey());
-	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+	mFolder->childrenByFilename.erase(file->getKey());
+	for(auto it = mFolder->children.cbegin(); it != mFolder->children.cend(); it++)
 	{
 		if(*it == file)
 		{
 			file->mParent = NULL;
-			mChildren.erase(it);
+			mFolder->children.erase(it);
+			invalidateDisplayLists();
 			return;
 		}
 	}
@@ -250,10 +312,17 @@ void FileData::removeChild(FileData* file)
 
 void FileData::sort(ComparisonFunction& comparator, bool ascending)
 {
+	if (!mFolder)
+		return;
+
+	invalidateDisplayLists();
+
+	std::vector<FileData*>& children = mFolder->children;
+
 	if (ascending)
 	{
-		std::stable_sort(mChildren.begin(), mChildren.end(), comparator);
-		for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
+		std::stable_sort(children.begin(), children.end(), comparator);
+		for(auto it = children.cbegin(); it != children.cend(); it++)
 		{
 			if((*it)->getChildren().size() > 0)
 				(*it)->sort(comparator, ascending);
@@ -261,8 +330,8 @@ void FileData::sort(ComparisonFunction& comparator, bool ascending)
 	}
 	else
 	{
-		std::stable_sort(mChildren.rbegin(), mChildren.rend(), comparator);
-		for(auto it = mChildren.rbegin(); it != mChildren.rend(); it++)
+		std::stable_sort(children.rbegin(), children.rend(), comparator);
+		for(auto it = children.rbegin(); it != children.rend(); it++)
 		{
 			if((*it)->getChildren().size() > 0)
 				(*it)->sort(comparator, ascending);
@@ -272,8 +341,11 @@ void FileData::sort(ComparisonFunction& comparator, bool ascending)
 
 void FileData::sort(const SortType& type)
 {
+	if (!mFolder)
+		return;
+
 	sort(*type.comparisonFunction, type.ascending);
-	mSortDesc = type.description;
+	mFolder->sortDesc = type.description;
 }
 
 void FileData::launchGame(Window* window)
@@ -283,7 +355,8 @@ void FileData::launchGame(Window* window)
 	AudioManager::getInstance()->deinit();
 	VolumeControl::getInstance()->deinit();
 	InputManager::getInstance()->deinit();
-	window->deinit();
+	// keep what is on display in RAM, coming back from the game does not need to decode it again
+	window->deinit(true);
 
 	std::string command = mEnvData->mLaunchCommand;
 
@@ -299,6 +372,8 @@ void FileData::launchGame(Window* window)
 	Scripting::fireEvent("game-start", rom, basename, name);
 
 	LOG(LogInfo) << "	" << command;
+	// the log should be complete should the emulator take the system down with it
+	Log::flush();
 	int exitCode = runSystemCommand(command);
 
 	if(exitCode != 0)
@@ -308,6 +383,9 @@ void FileData::launchGame(Window* window)
 
 	Scripting::fireEvent("game-end");
 
+	// the emulator or a script may have added media, only the directories changed meanwhile are listed again
+	MediaIndex::getInstance()->refresh();
+
 	window->init();
 	InputManager::getInstance()->init();
 	VolumeControl::getInstance()->init();
@@ -322,20 +400,16 @@ void FileData::launchGame(Window* window)
 
 	//update last played time
 	gameToUpdate->metadata.set("lastplayed", Utils::Time::DateTime(Utils::Time::now()));
-	CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
 
-	gameToUpdate->mSystem->onMetaDataSavePoint();
+	// a single append instead of rewriting the gamelist, the journal is compacted into it later on
+	PlayStatsJournal::getInstance()->record(gameToUpdate);
+	CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
 }
 
 CollectionFileData::CollectionFileData(FileData* file, SystemData* system)
-	: FileData(file->getSourceFileData()->getType(), file->getSourceFileData()->getPath(), file->getSourceFileData()->getSystemEnvData(), system)
+	: FileData(file->getSourceFileData(), system), mDirty(true)
 {
 	// we use this constructor to create a clone of the filedata, and change its system
-	mSourceFileData = file->getSourceFileData();
-	refreshMetadata();
-	mParent = NULL;
-	metadata = mSourceFileData->metadata;
-	mSystemName = mSourceFileData->getSystem()->getName();
 }
 
 CollectionFileData::~CollectionFileData()
@@ -369,7 +443,8 @@ const std::string& CollectionFileData::getName()
 		mDirty = false;
 	}
 
-	if (Settings::getInstance()->getBool("CollectionShowSystemInfo"))
+	static const SettingHandle<bool> showSystemInfo = Settings::getInstance()->getHandle(SettingKeys::CollectionShowSystemInfo);
+	if (showSystemInfo)
 		return mCollectionFileName;
 	return mSourceFileData->metadata.get("name");
 }
@@ -4,6 +4,7 @@
 
 #include "utils/FileSystemUtil.h"
 #include "MetaData.h"
+#include <atomic>
 #include <unordered_map>
 
 class SystemData;
@@ -39,10 +40,11 @@ public:
 	virtual const std::string& getName();
 	virtual const std::string& getSortName();
 	inline FileType getType() const { return mType; }
-	inline const std::string& getPath() const { return mPath; }
+	// collection entries share the path of their source file
+	inline const std::string& getPath() const { return mSourceFileData ? mSourceFileData->mPath : mPath; }
 	inline FileData* getParent() const { return mParent; }
-	inline const std::unordered_map<std::string, FileData*>& getChildrenByFilename() const { return mChildrenByFilename; }
-	inline const std::vector<FileData*>& getChildren() const { return mChildren; }
+	inline const std::unordered_map<std::string, FileData*>& getChildrenByFilename() const { return mFolder ? mFolder->childrenByFilename : sNoChildrenByFilename; }
+	inline const std::vector<FileData*>& getChildren() const { return mFolder ? mFolder->children : sNoChildren; }
 	inline SystemData* getSystem() const { return mSystem; }
 	inline SystemEnvironmentData* getSystemEnvData() const { return mEnvData; }
 	virtual const std::string getThumbnailPath() const;
@@ -51,6 +53,10 @@ public:
 	virtual const std::string getImagePath() const;
 
 	const std::vector<FileData*>& getChildrenListToDisplay();
+	// index in getChildrenListToDisplay() of the first child whose sort name starts with letter (upper case), -1 if none
+	int getFirstIndexOfLetter(unsigned char letter);
+	// call when children, their order or a filter change, the cached display lists are rebuilt on their next use
+	static void invalidateDisplayLists() { ++sDisplayGeneration; }
 	std::vector<FileData*> getFilesRecursive(unsigned int typeMask, bool displayedOnly = false) const;
 
 	void addChild(FileData* file); // Error if mType != FOLDER
@@ -65,7 +71,8 @@ public:
 	inline std::string getFullPath() { return getPath(); };
 	inline std::string getFileName() { return Utils::FileSystem::getFileName(getPath()); };
 	virtual FileData* getSourceFileData();
-	inline std::string getSystemName() const { return mSystemName; };
+	// name of the system the file belongs to, the source file's system for collection entries
+	const std::string& getSystemName() const;
 
 	// Returns our best guess at the "real" name for this file (will attempt to perform MAME name translation)
 	std::string getDisplayName() const;
@@ -87,24 +94,41 @@ public:
 	};
 
 	void sort(const SortType& type);
-	std::string getSortDescription() { return mSortDesc; }
+	std::string getSortDescription() { return mFolder ? mFolder->sortDesc : ""; }
 	MetaDataList metadata;
 
 protected:
+	// creates a copy of source belonging to system, sharing source's path
+	FileData(FileData* source, SystemData* system);
+
 	FileData* mSourceFileData;
 	FileData* mParent;
-	std::string mSystemName;
 
 private:
+	// what only folders hold, games leave it out
+	struct Folder
+	{
+		Folder() : filteredGeneration(0), letterGeneration(0) { }
+
+		std::unordered_map<std::string,FileData*> childrenByFilename;
+		std::vector<FileData*> children;
+		std::vector<FileData*> filteredChildren;
+		std::vector<int> firstIndexByLetter; // by upper case first letter of the sort name, empty until asked for
+		unsigned int filteredGeneration;
+		unsigned int letterGeneration;
+		std::string sortDesc;
+	};
+
 	void sort(ComparisonFunction& comparator, bool ascending = true);
 	FileType mType;
-	std::string mPath;
+	std::string mPath; // empty for collection entries
 	SystemEnvironmentData* mEnvData;
 	SystemData* mSystem;
-	std::unordered_map<std::string,FileData*> mChildrenByFilename;
-	std::vector<FileData*> mChildren;
-	std::vector<FileData*> mFilteredChildren;
-	std::string mSortDesc;
+	Folder* mFolder; // NULL unless mType is FOLDER
+
+	static std::atomic<unsigned int> sDisplayGeneration; // games are indexed by the loader threads
+	static const std::vector<FileData*> sNoChildren;
+	static const std::unordered_map<std::string, FileData*> sNoChildrenByFilename;
 };
 
 class CollectionFileData : public FileData
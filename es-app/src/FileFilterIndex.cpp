@@ -184,6 +184,8 @@ std::string FileFilterIndex::getIndexableKey(FileData* game, FilterIndexType typ
 
 void FileFilterIndex::addToIndex(FileData* game)
 {
+	// the game may be shown or hidden by the current filter now
+	FileData::invalidateDisplayLists();
 	manageGenreEntryInIndex(game);
 	managePlayerEntryInIndex(game);
 	managePubDevEntryInIndex(game);
@@ -195,6 +197,7 @@ void FileFilterIndex::addToIndex(FileData* game)
 
 void FileFilterIndex::removeFromIndex(FileData* game)
 {
+	FileData::invalidateDisplayLists();
 	manageGenreEntryInIndex(game, true);
 	managePlayerEntryInIndex(game, true);
 	managePubDevEntryInIndex(game, true);
@@ -206,6 +209,8 @@ void FileFilterIndex::removeFromIndex(FileData* game)
 
 void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>* values)
 {
+	FileData::invalidateDisplayLists();
+
 	// test if it exists before setting
 	if(type == NONE)
 	{
@@ -233,6 +238,7 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 
 void FileFilterIndex::clearAllFilters()
 {
+	FileData::invalidateDisplayLists();
 	for (std::vector<FilterDataDecl>::const_iterator it = filterDataDecl.cbegin(); it != filterDataDecl.cend(); ++it )
 	{
 		FilterDataDecl filterData = (*it);
@@ -1,10 +1,9 @@
 #include "Gamelist.h"
 
-#include <chrono>
-
 #include "utils/FileSystemUtil.h"
 #include "FileData.h"
 #include "FileFilterIndex.h"
+#include "GamelistWriter.h"
 #include "Log.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -107,6 +106,9 @@ void parseGamelist(SystemData* system)
 	std::string xmlpath = system->getGamelistPath(false);
 	const std::vector<std::string> allowedExtensions = system->getExtensions();
 
+	// pending writes have to land first or a reload would see stale data
+	GamelistWriter::getInstance()->flush();
+
 	if(!Utils::FileSystem::exists(xmlpath))
 		return;
 
@@ -175,172 +177,11 @@ void parseGamelist(SystemData* system)
 	}
 }
 
-void addFileDataNode(pugi::xml_node& parent, const FileData* file, const char* tag, SystemData* system)
-{
-	//create game and add to parent node
-	pugi::xml_node newNode = parent.append_child(tag);
-
-	//write metadata
-	file->metadata.appendToXML(newNode, true, system->getStartPath());
-
-	if(newNode.children().begin() == newNode.child("name") //first element is name
-		&& ++newNode.children().begin() == newNode.children().end() //theres only one element
-		&& newNode.child("name").text().get() == file->getDisplayName()) //the name is the default
-	{
-		//if the only info is the default name, don't bother with this node
-		//delete it and ultimately do nothing
-		parent.remove_child(newNode);
-	}else{
-		//there's something useful in there so we'll keep the node, add the path
-
-		// try and make the path relative if we can so things still work if we change the rom folder location in the future
-		std::string relPath = Utils::FileSystem::createRelativePath(file->getPath(), system->getStartPath(), false, true);
-		newNode.prepend_child("path").text().set(relPath.c_str());
-	}
-}
-
 void updateGamelist(SystemData* system)
 {
-	//We do this by reading the XML again, adding changes and then writing it back,
-	//because there might be information missing in our systemdata which would then miss in the new XML.
-	//We have the complete information for every game though, so we can simply remove a game
-	//we already have in the system from the XML, and then add it back from its GameData information...
-
 	if(Settings::getInstance()->getBool("IgnoreGamelist"))
 		return;
 
-	pugi::xml_document doc;
-	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
-
-	std::string relativeTo = system->getStartPath();
-
-	if(Utils::FileSystem::exists(xmlReadPath))
-	{
-		//parse an existing file first
-		pugi::xml_parse_result result = doc.load_file(xmlReadPath.c_str());
-
-		if(!result)
-		{
-			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
-			return;
-		}
-
-		root = doc.child("gameList");
-		if(!root)
-		{
-			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
-			return;
-		}
-	}else{
-		//set up an empty gamelist to append to
-		root = doc.append_child("gameList");
-	}
-
-	std::vector<FileData*> changedGames;
-	std::vector<FileData*> changedFolders;
-
-	//now we have all the information from the XML. now iterate through all our games and add information from there
-	FileData* rootFolder = system->getRootFolder();
-	if (rootFolder != nullptr)
-	{
-		int numUpdated = 0;
-
-		std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
-
-		// Stage 1: iterate through all files in memory, checking for changes
-		for(std::vector<FileData*>::const_iterator fit = files.cbegin(); fit != files.cend(); ++fit)
-		{
-
-			// do not touch if it wasn't changed anyway
-			if (!(*fit)->metadata.wasChanged())
-				continue;
-
-			// adding item to changed list
-			if ((*fit)->getType() == GAME)
-			{
-				changedGames.push_back((*fit));
-			}
-			else
-			{
-				changedFolders.push_back((*fit));
-			}
-		}
-
-
-		// Stage 2: iterate XML if needed, to remove and add changed items
-		const char* tagList[2] = { "game", "folder" };
-		FileType typeList[2] = { GAME, FOLDER };
-		std::vector<FileData*> changedList[2] = { changedGames, changedFolders };
-
-		for(int i = 0; i < 2; i++)
-		{
-			const char* tag = tagList[i];
-			std::vector<FileData*> changes = changedList[i];
-
-			// check for changed items of this type
-			if (changes.size() > 0) {
-				// check if the item already exists in the XML
-				// if it does, remove all corresponding items before adding
-				for(pugi::xml_node fileNode = root.child(tag); fileNode; )
-				{
-					pugi::xml_node pathNode = fileNode.child("path");
-
-					// we need this as we were deleting the iterator and things would become inconsistent
-					pugi::xml_node nextNode = fileNode.next_sibling(tag);
-
-					if(!pathNode)
-					{
-						LOG(LogError) << "<" << tag << "> node contains no <path> child!";
-						continue;
-					}
-
-					std::string xmlpath = pathNode.text().get();
-					// apply the same transformation as in Gamelist::parseGamelist
-					xmlpath = Utils::FileSystem::resolveRelativePath(xmlpath, relativeTo, false, true);
-
-					for(std::vector<FileData*>::const_iterator cfit = changes.cbegin(); cfit != changes.cend(); ++cfit)
-					{
-						if(xmlpath == (*cfit)->getPath())
-						{
-							// found it
-							root.remove_child(fileNode);
-							break;
-						}
-					}
-					fileNode = nextNode;
-
-				}
-
-				// add items to XML
-				for(std::vector<FileData*>::const_iterator cfit = changes.cbegin(); cfit != changes.cend(); ++cfit)
-				{
-					// it was either removed or never existed to begin with; either way, we can add it now
-					addFileDataNode(root, *cfit, tag, system);
-					++numUpdated;
-				}
-			}
-		}
-
-		// now write the file
-
-		if (numUpdated > 0) {
-			const auto startTs = std::chrono::system_clock::now();
-
-			//make sure the folders leading up to this path exist (or the write will fail)
-			std::string xmlWritePath(system->getGamelistPath(true));
-			Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
-
-			LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
-
-			if (!doc.save_file(xmlWritePath.c_str())) {
-				LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-			}
-
-			const auto endTs = std::chrono::system_clock::now();
-			LOG(LogInfo) << "Saved gamelist.xml for system \"" << system->getName() << "\" in " << std::chrono::duration_cast<std::chrono::milliseconds>(endTs - startTs).count() << " ms";
-		}
-	}else{
-		LOG(LogError) << "Found no root folder for system \"" << system->getName() << "\"!";
-	}
+	// only snapshots the changes, the file is merged and written by the writer thread
+	GamelistWriter::getInstance()->queue(system);
 }
@@ -0,0 +1,502 @@
+#include "GamelistWriter.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/ProfilingUtil.h"
+#include "FileData.h"
+#include "Log.h"
+#include "SystemData.h"
+#include <pugixml.hpp>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#if defined(_WIN32)
+#include <Windows.h>
+#else // _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif // !_WIN32
+
+#define COALESCE_DELAY_MS 1000
+#define MAX_WRITE_ATTEMPTS 3
+
+GamelistWriter* GamelistWriter::sInstance = nullptr;
+
+void GamelistWriter::init()
+{
+	if(!sInstance)
+		sInstance = new GamelistWriter();
+
+} // init
+
+void GamelistWriter::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+GamelistWriter* GamelistWriter::getInstance()
+{
+	if(!sInstance)
+		sInstance = new GamelistWriter();
+
+	return sInstance;
+
+} // getInstance
+
+GamelistWriter::GamelistWriter() : mWriting(0), mFlushing(false), mExit(false), mLastLatency(0), mMaxLatency(0)
+{
+	mThread = new std::thread(&GamelistWriter::threadProc, this);
+
+} // GamelistWriter
+
+GamelistWriter::~GamelistWriter()
+{
+	// everything still queued is written before the thread exits
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+	}
+	mEvent.notify_one();
+	mThread->join();
+	delete mThread;
+
+	for(auto it = mFailed.cbegin(); it != mFailed.cend(); ++it)
+		LOG(LogError) << "Gamelist for system \"" << it->second.systemName << "\" could not be written, " << it->second.entries.size() << " changed entries are lost";
+
+} // ~GamelistWriter
+
+void GamelistWriter::queue(SystemData* _system)
+{
+	FileData* rootFolder = _system->getRootFolder();
+	if(!rootFolder)
+	{
+		LOG(LogError) << "Found no root folder for system \"" << _system->getName() << "\"!";
+		return;
+	}
+
+	// only the in-memory copy happens here, everything touching the disk is done by the writer thread
+	std::vector<FileData*> files = rootFolder->getFilesRecursive(GAME | FOLDER);
+	std::vector<FileData*> changed;
+
+	for(auto it = files.cbegin(); it != files.cend(); ++it)
+	{
+		if((*it)->metadata.wasChanged())
+			changed.push_back(*it);
+	}
+
+	if(changed.empty())
+		return;
+
+	const std::string writePath = _system->getGamelistPath(true);
+
+	//make sure the folders leading up to this path exist (or the write will fail)
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(writePath));
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto jobIt = mPending.find(writePath);
+	if(jobIt == mPending.cend())
+	{
+		Job& job        = mPending[writePath];
+		job.systemName  = _system->getName();
+		job.readPath    = _system->getGamelistPath(false);
+		job.writePath   = writePath;
+		job.startPath   = _system->getStartPath();
+		job.firstQueued = std::chrono::steady_clock::now();
+		job.snapshots   = 0;
+		job.attempts    = 0;
+
+		// changes whose write failed earlier go along, the snapshots taken below are newer
+		auto failedIt = mFailed.find(writePath);
+		if(failedIt != mFailed.cend())
+		{
+			job.entries     = failedIt->second.entries;
+			job.firstQueued = failedIt->second.firstQueued;
+			mFailed.erase(failedIt);
+		}
+
+		jobIt = mPending.find(writePath);
+	}
+
+	Job& job = jobIt->second;
+	++job.snapshots;
+
+	for(auto it = changed.cbegin(); it != changed.cend(); ++it)
+	{
+		Entry entry((*it)->metadata.getType());
+		entry.metadata    = (*it)->metadata;
+		entry.displayName = (*it)->getDisplayName();
+
+		auto entryIt = job.entries.find((*it)->getPath());
+		if(entryIt != job.entries.cend())
+			entryIt->second = entry;
+		else
+			job.entries.insert(std::make_pair((*it)->getPath(), entry));
+
+		// the snapshot now owns this change, later saves only pick up newer ones. It stays queued until
+		// it was written, a failed write hands it back to the queue instead of dropping it
+		(*it)->metadata.resetChangedFlag();
+	}
+
+	mLastQueued = std::chrono::steady_clock::now();
+	mEvent.notify_one();
+
+} // queue
+
+bool GamelistWriter::flush(SystemData* _system)
+{
+	// taken before locking, getGamelistPath() may create directories
+	const std::string writePath = _system ? _system->getGamelistPath(true) : std::string();
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!mPending.empty() || mWriting)
+	{
+		mFlushing = true;
+		mEvent.notify_one();
+		mDone.wait(lock, [this] { return mPending.empty() && !mWriting; });
+		mFlushing = false;
+	}
+
+	// retries are done by now, what still failed waits for the next change to its gamelist
+	return _system ? (mFailed.find(writePath) == mFailed.cend()) : mFailed.empty();
+
+} // flush
+
+void GamelistWriter::whenWritten(const std::vector<SystemData*>& _systems, const std::function<void()>& _callback)
+{
+	Waiter waiter;
+	waiter.callback = _callback;
+
+	for(auto it = _systems.cbegin(); it != _systems.cend(); ++it)
+		waiter.writePaths.insert((*it)->getGamelistPath(true));
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		// queue() leaves out systems without changes, nothing is going to be written for those
+		for(auto it = waiter.writePaths.begin(); it != waiter.writePaths.end(); )
+		{
+			if((mPending.find(*it) == mPending.cend()) && (mFailed.find(*it) == mFailed.cend()) && (*it != mWritingPath))
+				it = waiter.writePaths.erase(it);
+			else
+				++it;
+		}
+
+		if(!waiter.writePaths.empty())
+		{
+			mWaiters.push_back(waiter);
+			return;
+		}
+	}
+
+	_callback();
+
+} // whenWritten
+
+unsigned int GamelistWriter::getPendingCount()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return (unsigned int)mPending.size() + mWriting;
+
+} // getPendingCount
+
+unsigned int GamelistWriter::getLastLatency()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mLastLatency;
+
+} // getLastLatency
+
+unsigned int GamelistWriter::getMaxLatency()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mMaxLatency;
+
+} // getMaxLatency
+
+void GamelistWriter::threadProc()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while(true)
+	{
+		mEvent.wait(lock, [this] { return mExit || !mPending.empty(); });
+
+		if(mPending.empty())
+			return;
+
+		// coalesce bursts, wait until no new changes arrived for a while unless someone is waiting for us
+		while(!mExit && !mFlushing)
+		{
+			const auto deadline = mLastQueued + std::chrono::milliseconds(COALESCE_DELAY_MS);
+			if(std::chrono::steady_clock::now() >= deadline)
+				break;
+
+			mEvent.wait_until(lock, deadline);
+		}
+
+		Job job = mPending.begin()->second;
+		mPending.erase(mPending.begin());
+		mWritingPath = job.writePath;
+		++mWriting;
+
+		lock.unlock();
+		const bool written = write(job);
+		lock.lock();
+
+		mWritingPath.clear();
+
+		if(!written)
+		{
+			--mWriting;
+			requeue(job);
+			mDone.notify_all();
+			continue;
+		}
+
+		// a change queued while writing is pending again and keeps its waiters waiting
+		std::vector<std::function<void()>> callbacks;
+		if(mPending.find(job.writePath) == mPending.cend())
+		{
+			for(auto it = mWaiters.begin(); it != mWaiters.end(); )
+			{
+				it->writePaths.erase(job.writePath);
+				if(it->writePaths.empty())
+				{
+					callbacks.push_back(it->callback);
+					it = mWaiters.erase(it);
+				}
+				else
+					++it;
+			}
+		}
+
+		if(!callbacks.empty())
+		{
+			lock.unlock();
+			for(auto it = callbacks.cbegin(); it != callbacks.cend(); ++it)
+				(*it)();
+			lock.lock();
+		}
+
+		const unsigned int latency = (unsigned int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - job.firstQueued).count();
+		mLastLatency = latency;
+		mMaxLatency  = std::max(mMaxLatency, latency);
+		--mWriting;
+
+		LOG(LogInfo) << "Gamelist for system \"" << job.systemName << "\" written " << latency << " ms after the first change (" << job.snapshots << " updates coalesced, " << mPending.size() << " gamelists pending)";
+
+		mDone.notify_all();
+	}
+
+} // threadProc
+
+void GamelistWriter::requeue(const Job& _job)
+{
+	// mMutex must be held by the caller
+	Job job = _job;
+	++job.attempts;
+
+	// snapshots queued while writing are newer, the failed ones only fill in what they do not cover
+	auto pendingIt = mPending.find(job.writePath);
+	if(pendingIt != mPending.cend())
+	{
+		for(auto it = pendingIt->second.entries.cbegin(); it != pendingIt->second.entries.cend(); ++it)
+		{
+			auto entryIt = job.entries.find(it->first);
+			if(entryIt != job.entries.cend())
+				entryIt->second = it->second;
+			else
+				job.entries.insert(*it);
+		}
+
+		job.snapshots += pendingIt->second.snapshots;
+		mPending.erase(pendingIt);
+	}
+
+	if(job.attempts < MAX_WRITE_ATTEMPTS)
+	{
+		LOG(LogWarning) << "Writing the gamelist for system \"" << job.systemName << "\" failed, retrying (attempt " << (job.attempts + 1) << " of " << MAX_WRITE_ATTEMPTS << ")";
+		mPending[job.writePath] = job;
+		mLastQueued = std::chrono::steady_clock::now();
+		return;
+	}
+
+	// kept for the next change to this gamelist instead of retrying a broken file forever
+	LOG(LogError) << "Giving up writing the gamelist for system \"" << job.systemName << "\" for now, " << job.entries.size() << " changed entries are written with its next change";
+	job.attempts = 0;
+	mFailed[job.writePath] = job;
+
+} // requeue
+
+static const char* getTag(MetaDataListType _type)
+{
+	return (_type == FOLDER_METADATA) ? "folder" : "game";
+}
+
+static void addFileDataNode(pugi::xml_node& _parent, pugi::xml_node& _replace, const std::string& _path, const MetaDataList& _metadata, const std::string& _displayName, const std::string& _startPath)
+{
+	//create game and add to parent node, next to the one it replaces if there is one
+	const char*    tag     = getTag(_metadata.getType());
+	pugi::xml_node newNode = _replace ? _parent.insert_child_before(tag, _replace) : _parent.append_child(tag);
+
+	//write metadata
+	_metadata.appendToXML(newNode, true, _startPath);
+
+	if(newNode.children().begin() == newNode.child("name") //first element is name
+		&& ++newNode.children().begin() == newNode.children().end() //theres only one element
+		&& newNode.child("name").text().get() == _displayName) //the name is the default
+	{
+		//if the only info is the default name, don't bother with this node
+		//delete it and ultimately do nothing
+		_parent.remove_child(newNode);
+	}else{
+		//there's something useful in there so we'll keep the node, add the path
+
+		// try and make the path relative if we can so things still work if we change the rom folder location in the future
+		std::string relPath = Utils::FileSystem::createRelativePath(_path, _startPath, false, true);
+		newNode.prepend_child("path").text().set(relPath.c_str());
+	}
+
+	if(_replace)
+		_parent.remove_child(_replace);
+}
+
+static bool replaceFile(const std::string& _tempPath, const std::string& _path)
+{
+#if defined(_WIN32)
+	return MoveFileExA(_tempPath.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else // _WIN32
+	// make sure the data is on disk before the rename makes it visible
+	int fd = open(_tempPath.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+	const bool synced = fsync(fd) == 0;
+	close(fd);
+
+	if(!synced || (rename(_tempPath.c_str(), _path.c_str()) != 0))
+		return false;
+
+	// and persist the rename itself
+	fd = open(Utils::FileSystem::getParent(_path).c_str(), O_RDONLY);
+	if(fd >= 0)
+	{
+		fsync(fd);
+		close(fd);
+	}
+
+	return true;
+#endif // !_WIN32
+}
+
+bool GamelistWriter::write(const Job& _job)
+{
+	ProfileZone("gamelist write");
+
+	//We do this by reading the XML again, adding changes and then writing it back,
+	//because there might be information missing in our systemdata which would then miss in the new XML.
+	//We have the complete information for every game though, so we can simply remove a game
+	//we already have in the system from the XML, and then add it back from its GameData information...
+
+	const auto startTs = std::chrono::steady_clock::now();
+
+	pugi::xml_document doc;
+	pugi::xml_node root;
+
+	// Utils::FileSystem::exists caches its answer for good, a gamelist created meanwhile would still
+	// be reported missing, let the parser tell us about a missing file instead
+	pugi::xml_parse_result result = doc.load_file(_job.readPath.c_str());
+
+	if(result.status != pugi::status_file_not_found)
+	{
+		//parse an existing file first
+		if(!result)
+		{
+			LOG(LogError) << "Error parsing XML file \"" << _job.readPath << "\"!\n	" << result.description();
+			return false;
+		}
+
+		root = doc.child("gameList");
+		if(!root)
+		{
+			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << _job.readPath << "\"!";
+			return false;
+		}
+	}else{
+		//set up an empty gamelist to append to
+		doc.reset();
+		root = doc.append_child("gameList");
+	}
+
+	// index the existing nodes once, keyed on their path normalized the same way Gamelist::parseGamelist does,
+	// so the merge costs one lookup per changed entry instead of comparing every node against every change
+	std::unordered_map<std::string, pugi::xml_node> index;
+	index.reserve(_job.entries.size());
+
+	for(pugi::xml_node fileNode = root.first_child(); fileNode; )
+	{
+		// we need this as we may be deleting the node and things would become inconsistent
+		pugi::xml_node nextNode = fileNode.next_sibling();
+		const char*    tag      = fileNode.name();
+
+		if(strcmp(tag, "game") && strcmp(tag, "folder"))
+		{
+			fileNode = nextNode;
+			continue;
+		}
+
+		pugi::xml_node pathNode = fileNode.child("path");
+		if(!pathNode)
+		{
+			LOG(LogError) << "<" << tag << "> node contains no <path> child!";
+			fileNode = nextNode;
+			continue;
+		}
+
+		std::string xmlpath = Utils::FileSystem::resolveRelativePath(pathNode.text().get(), _job.startPath, false, true);
+
+		// only nodes of changed entries are of interest, a duplicate of one of them is dropped
+		auto entryIt = _job.entries.find(xmlpath);
+		if((entryIt != _job.entries.cend()) && !strcmp(tag, getTag(entryIt->second.metadata.getType())))
+		{
+			if(!index.insert(std::make_pair(std::move(xmlpath), fileNode)).second)
+				root.remove_child(fileNode);
+		}
+
+		fileNode = nextNode;
+	}
+
+	int numUpdated = 0;
+
+	for(auto it = _job.entries.cbegin(); it != _job.entries.cend(); ++it)
+	{
+		auto nodeIt = index.find(it->first);
+		pugi::xml_node oldNode = (nodeIt != index.cend()) ? nodeIt->second : pugi::xml_node();
+
+		// existing entries are replaced in place to keep the document order stable, new ones are appended
+		addFileDataNode(root, oldNode, it->first, it->second.metadata, it->second.displayName, _job.startPath);
+		++numUpdated;
+	}
+
+	LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << _job.readPath << "'";
+
+	// never write in place, a crash or power cut during the write would leave a truncated gamelist behind
+	const std::string tempPath = _job.writePath + ".tmp";
+	if(!doc.save_file(tempPath.c_str()) || !replaceFile(tempPath, _job.writePath))
+	{
+		LOG(LogError) << "Error saving gamelist.xml to \"" << _job.writePath << "\" (for system " << _job.systemName << ")!";
+		remove(tempPath.c_str());
+		return false;
+	}
+
+	const auto endTs = std::chrono::steady_clock::now();
+	LOG(LogInfo) << "Saved gamelist.xml for system \"" << _job.systemName << "\" in " << std::chrono::duration_cast<std::chrono::milliseconds>(endTs - startTs).count() << " ms";
+	return true;
+
+} // write
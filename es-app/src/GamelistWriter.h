@@ -0,0 +1,105 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_WRITER_H
+#define ES_APP_GAMELIST_WRITER_H
+
+#include "MetaData.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+class SystemData;
+
+//
+// Writes gamelist.xml files on a background thread.
+//
+// queue() runs on the UI thread and only copies the metadata of the changed games and folders of
+// a system. Updates for the same system are coalesced until no new ones arrived for a short while,
+// then the gamelist is merged and replaced atomically (temporary file, fsync, rename) so a power
+// cut never leaves a truncated file behind. flush() and deinit() block until everything queued
+// has been written. A write that fails is retried a few times. After that its snapshot is kept
+// and written along with the next change to the same gamelist, so no edit is dropped silently.
+//
+class GamelistWriter
+{
+public:
+
+	static void            init       ();
+	static void            deinit     ();
+	static GamelistWriter* getInstance();
+
+	// Snapshots the changed entries of _system and schedules the write, resets their changed flags
+	void queue(SystemData* _system);
+	// Blocks until all queued gamelists have been written or given up on. Returns false if the gamelist of
+	// _system, or any gamelist without one, is left unwritten
+	bool flush(SystemData* _system = nullptr);
+	// Calls _callback once the gamelists of _systems queued so far have been written, on the writer thread or
+	// right away if none of them is waiting to be written. A gamelist given up on keeps it waiting until written.
+	void whenWritten(const std::vector<SystemData*>& _systems, const std::function<void()>& _callback);
+
+	unsigned int getPendingCount();
+	unsigned int getLastLatency (); // ms from the first queued change to the file being replaced
+	unsigned int getMaxLatency  ();
+
+private:
+
+	struct Entry
+	{
+		Entry(MetaDataListType _type) : metadata(_type) { }
+
+		MetaDataList metadata;
+		std::string  displayName;
+	};
+
+	struct Waiter
+	{
+		std::set<std::string> writePaths; // not written yet
+		std::function<void()> callback;
+	};
+
+	struct Job
+	{
+		std::string                           systemName;
+		std::string                           readPath;
+		std::string                           writePath;
+		std::string                           startPath;
+		std::map<std::string, Entry>          entries; // by absolute path, the newest snapshot wins, ordered so new nodes are appended deterministically
+		std::chrono::steady_clock::time_point firstQueued;
+		unsigned int                          snapshots;
+		unsigned int                          attempts;
+	};
+
+	 GamelistWriter();
+	~GamelistWriter();
+
+	void threadProc();
+	bool write     (const Job& _job);
+	void requeue   (const Job& _job);
+
+	static GamelistWriter* sInstance;
+
+	std::map<std::string, Job>            mPending; // by gamelist write path
+	std::map<std::string, Job>            mFailed;  // by gamelist write path, merged into the next job for it
+	std::list<Waiter>                     mWaiters;
+	std::string                           mWritingPath;
+	std::chrono::steady_clock::time_point mLastQueued;
+
+	std::thread*            mThread;
+	std::mutex              mMutex;
+	std::condition_variable mEvent;
+	std::condition_variable mDone;
+	unsigned int            mWriting;
+	bool                    mFlushing;
+	bool                    mExit;
+
+	unsigned int mLastLatency;
+	unsigned int mMaxLatency;
+
+}; // GamelistWriter
+
+#endif // ES_APP_GAMELIST_WRITER_H
@@ -0,0 +1,244 @@
+#include "MediaIndex.h"
+
+#include "resources/ResourceManager.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+
+MediaIndex* MediaIndex::sInstance = nullptr;
+
+void MediaIndex::init()
+{
+	if(!sInstance)
+		sInstance = new MediaIndex();
+
+} // init
+
+void MediaIndex::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+MediaIndex* MediaIndex::getInstance()
+{
+	if(!sInstance)
+		sInstance = new MediaIndex();
+
+	return sInstance;
+
+} // getInstance
+
+MediaIndex::MediaIndex()
+{
+} // MediaIndex
+
+MediaIndex::~MediaIndex()
+{
+	LOG(LogDebug) << "MediaIndex: " << mDirectories.size() << " directories indexed";
+
+} // ~MediaIndex
+
+void MediaIndex::split(const std::string& _path, std::string& _directory, std::string& _file)
+{
+	const std::string path  = Utils::FileSystem::getGenericPath(_path);
+	const size_t      slash = path.find_last_of('/');
+
+	if(slash == std::string::npos)
+	{
+		_directory = ".";
+		_file      = path;
+		return;
+	}
+
+	_directory = path.substr(0, slash);
+	_file      = path.substr(slash + 1);
+
+} // split
+
+MediaIndex::Directory MediaIndex::list(const std::string& _directory)
+{
+	// the times are taken first, a file added while listing is picked up by the next refresh()
+	Directory directory;
+	directory.listed   = time(nullptr);
+	directory.modified = Utils::FileSystem::getModificationTime(_directory);
+
+	const Utils::FileSystem::stringList content = Utils::FileSystem::getDirContent(_directory);
+	directory.files.reserve(content.size());
+	directory.folded.reserve(content.size());
+
+	for(auto it = content.cbegin(); it != content.cend(); ++it)
+	{
+		const std::string file = Utils::FileSystem::getFileName(*it);
+		directory.folded.insert(Utils::String::toLower(file));
+		directory.files.insert(file);
+	}
+
+	return directory;
+
+} // list
+
+bool MediaIndex::find(const std::string& _directory, const std::string& _file, bool& _exists)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = mDirectories.find(_directory);
+		if(it == mDirectories.cend())
+			return false;
+
+		_exists = it->second.files.find(_file) != it->second.files.cend();
+		if(_exists || (it->second.folded.find(Utils::String::toLower(_file)) == it->second.folded.cend()))
+			return true;
+	}
+
+	// only differs in case from a listed file, whether that is the same one depends on the file system
+	_exists = Utils::FileSystem::isRegularFile(_directory + "/" + _file);
+
+	if(_exists)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = mDirectories.find(_directory);
+		if(it != mDirectories.cend())
+			it->second.files.insert(_file);
+	}
+
+	return true;
+
+} // find
+
+bool MediaIndex::exists(const std::string& _path)
+{
+	if(_path.empty())
+		return false;
+
+	std::string directory;
+	std::string file;
+	split(_path, directory, file);
+
+	bool found = false;
+	if(find(directory, file, found))
+		return found;
+
+	// listed without holding the lock, lookups in other directories go on meanwhile
+	Directory listed = list(directory);
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDirectories.insert(std::make_pair(directory, std::move(listed)));
+	}
+
+	find(directory, file, found);
+	return found;
+
+} // exists
+
+bool MediaIndex::lookup(const std::string& _path, bool& _exists)
+{
+	_exists = false;
+
+	if(_path.empty())
+		return true;
+
+	std::string directory;
+	std::string file;
+	split(_path, directory, file);
+
+	return find(directory, file, _exists);
+
+} // lookup
+
+void MediaIndex::index(const std::string& _directory)
+{
+	const std::string directory = Utils::FileSystem::getGenericPath(_directory);
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		if(mDirectories.find(directory) != mDirectories.cend())
+			return;
+	}
+
+	Directory listed = list(directory);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDirectories.insert(std::make_pair(directory, std::move(listed)));
+
+} // index
+
+void MediaIndex::refresh()
+{
+	std::map<std::string, std::pair<time_t, time_t>> directories; // modified, listed
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for(auto it = mDirectories.cbegin(); it != mDirectories.cend(); ++it)
+			directories[it->first] = std::make_pair(it->second.modified, it->second.listed);
+	}
+
+	unsigned int refreshed = 0;
+
+	for(auto it = directories.cbegin(); it != directories.cend(); ++it)
+	{
+		// modification times may only count seconds, a change in the second of the listing or just before it
+		// leaves the time unchanged and may have been missed, such a listing is only trusted once repeated later
+		const time_t modified = Utils::FileSystem::getModificationTime(it->first);
+		if((modified == it->second.first) && (modified < (it->second.second - 1)))
+			continue;
+
+		Directory listed = list(it->first);
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDirectories[it->first] = std::move(listed);
+		++refreshed;
+	}
+
+	if(refreshed)
+	{
+		LOG(LogInfo) << "MediaIndex: " << refreshed << " of " << directories.size() << " directories changed, listed again";
+		ResourceManager::getInstance()->invalidatePaths();
+	}
+
+} // refresh
+
+void MediaIndex::add(const std::string& _path)
+{
+	std::string directory;
+	std::string file;
+	split(_path, directory, file);
+
+	ResourceManager::getInstance()->invalidatePaths();
+
+	// directories not indexed yet are listed on their first lookup, which will find the file
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto it = mDirectories.find(directory);
+	if(it != mDirectories.cend())
+	{
+		it->second.folded.insert(Utils::String::toLower(file));
+		it->second.files.insert(file);
+	}
+
+} // add
+
+void MediaIndex::remove(const std::string& _path)
+{
+	std::string directory;
+	std::string file;
+	split(_path, directory, file);
+
+	ResourceManager::getInstance()->invalidatePaths();
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// a folded name left behind only costs a check on disk
+	auto it = mDirectories.find(directory);
+	if(it != mDirectories.cend())
+		it->second.files.erase(file);
+
+} // remove
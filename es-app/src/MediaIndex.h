@@ -0,0 +1,66 @@
+#pragma once
+#ifndef ES_APP_MEDIA_INDEX_H
+#define ES_APP_MEDIA_INDEX_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_set>
+
+//
+// Answers whether a media file exists from a single listing of its directory.
+//
+// A directory is listed the first time a file in it is asked for, after that every lookup is answered from
+// memory without touching the file system. refresh() lists again only the directories modified since,
+// media written or removed by ES itself is recorded with add() and remove() right away.
+//
+// Names are compared exactly. A name that only differs in case from a listed one is checked on disk, as the file
+// system holding it may not tell the two apart, and remembered if found.
+//
+// All functions may be called from any thread.
+//
+class MediaIndex
+{
+public:
+
+	static void        init       ();
+	static void        deinit     ();
+	static MediaIndex* getInstance();
+
+	bool exists (const std::string& _path);
+	// Like exists() but never lists, returns false if the directory of _path is not indexed yet
+	bool lookup (const std::string& _path, bool& _exists);
+	// Lists _directory unless it is indexed already, to build the index ahead of the first lookup
+	void index  (const std::string& _directory);
+	// Lists every indexed directory again that was modified since it was listed
+	void refresh();
+	void add    (const std::string& _path);
+	void remove (const std::string& _path);
+
+private:
+
+	struct Directory
+	{
+		std::unordered_set<std::string> files;
+		std::unordered_set<std::string> folded;   // lower case names, to catch lookups differing only in case
+		time_t                          modified;
+		time_t                          listed;
+	};
+
+	 MediaIndex();
+	~MediaIndex();
+
+	static void      split(const std::string& _path, std::string& _directory, std::string& _file);
+	static Directory list (const std::string& _directory);
+
+	bool find(const std::string& _directory, const std::string& _file, bool& _exists);
+
+	static MediaIndex* sInstance;
+
+	std::mutex                       mMutex;
+	std::map<std::string, Directory> mDirectories; // by path
+
+}; // MediaIndex
+
+#endif // ES_APP_MEDIA_INDEX_H
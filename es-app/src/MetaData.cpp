@@ -4,6 +4,7 @@
 #include "utils/TimeUtil.h"
 #include "Log.h"
 #include <pugixml.hpp>
+#include <unordered_map>
 
 MetaDataDecl gameDecls[] = {
 	// key,         type,                   default,            statistic,  name in GuiMetaDataEd,  prompt in GuiMetaDataEd
@@ -67,12 +68,33 @@ const std::vector<MetaDataDecl>& getMDDByType(MetaDataListType type)
 
 
 
+static std::unordered_map<std::string, int> buildIndex(MetaDataListType type)
+{
+	std::unordered_map<std::string, int> index;
+	const std::vector<MetaDataDecl>& mdd = getMDDByType(type);
+	for(size_t i = 0; i < mdd.size(); i++)
+		index[mdd[i].key] = (int)i;
+	return index;
+}
+
+int MetaDataList::getIndex(MetaDataListType type, const std::string& key)
+{
+	static const std::unordered_map<std::string, int> gameIndex = buildIndex(GAME_METADATA);
+	static const std::unordered_map<std::string, int> folderIndex = buildIndex(FOLDER_METADATA);
+
+	const std::unordered_map<std::string, int>& index = (type == FOLDER_METADATA) ? folderIndex : gameIndex;
+	auto it = index.find(key);
+	return (it != index.cend()) ? it->second : -1;
+}
+
+// a new list counts as changed, just like setting every default one by one did
 MetaDataList::MetaDataList(MetaDataListType type)
-	: mType(type), mWasChanged(false)
+	: mType(type), mWasChanged(true)
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
+	mValues.reserve(mdd.size());
 	for(auto iter = mdd.cbegin(); iter != mdd.cend(); iter++)
-		set(iter->key, iter->defaultValue);
+		mValues.push_back(iter->defaultValue);
 }
 
 
@@ -106,35 +128,41 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 {
 	const std::vector<MetaDataDecl>& mdd = getMDD();
 
-	for(auto mddIter = mdd.cbegin(); mddIter != mdd.cend(); mddIter++)
+	for(size_t i = 0; i < mdd.size(); i++)
 	{
-		auto mapIter = mMap.find(mddIter->key);
-		if(mapIter != mMap.cend())
-		{
-			// we have this value!
-			// if it's just the default (and we ignore defaults), don't write it
-			if(ignoreDefaults && mapIter->second == mddIter->defaultValue)
-				continue;
+		const MetaDataDecl& decl = mdd[i];
 
-			// try and make paths relative if we can
-			std::string value = mapIter->second;
-			if (mddIter->type == MD_PATH)
-				value = Utils::FileSystem::createRelativePath(value, relativeTo, true, true);
+		// if it's just the default (and we ignore defaults), don't write it
+		if(ignoreDefaults && mValues[i] == decl.defaultValue)
+			continue;
 
-			parent.append_child(mapIter->first.c_str()).text().set(value.c_str());
-		}
+		// try and make paths relative if we can
+		std::string value = mValues[i];
+		if (decl.type == MD_PATH)
+			value = Utils::FileSystem::createRelativePath(value, relativeTo, true, true);
+
+		parent.append_child(decl.key.c_str()).text().set(value.c_str());
 	}
 }
 
 void MetaDataList::set(const std::string& key, const std::string& value)
 {
-	mMap[key] = value;
+	const int index = getIndex(mType, key);
+	if(index >= 0)
+		mValues[index] = value;
+	else
+		mExtra[key] = value;
 	mWasChanged = true;
 }
 
 const std::string& MetaDataList::get(const std::string& key) const
 {
-	return mMap.at(key);
+	const int index = getIndex(mType, key);
+	if(index >= 0)
+		return mValues[index];
+
+	// throws like a lookup of a key that was never set always did
+	return mExtra.at(key);
 }
 
 int MetaDataList::getInt(const std::string& key) const
@@ -63,8 +63,14 @@ public:
 	inline const std::vector<MetaDataDecl>& getMDD() const { return getMDDByType(getType()); }
 
 private:
+	// index of key in the MDD of type, -1 if it is not declared
+	static int getIndex(MetaDataListType type, const std::string& key);
+
 	MetaDataListType mType;
-	std::map<std::string, std::string> mMap;
+	// the values of the declared keys in MDD order, the keys themselves are shared by every list of a type
+	std::vector<std::string> mValues;
+	// keys not declared for the type, empty unless someone sets one
+	std::map<std::string, std::string> mExtra;
 	bool mWasChanged;
 };
 
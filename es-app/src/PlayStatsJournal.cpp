@@ -0,0 +1,279 @@
+#include "PlayStatsJournal.h"
+
+#include "utils/FileSystemUtil.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "GamelistWriter.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+#define COMPACT_RECORDS 100
+
+PlayStatsJournal* PlayStatsJournal::sInstance = nullptr;
+
+void PlayStatsJournal::init()
+{
+	if(!sInstance)
+		sInstance = new PlayStatsJournal();
+
+} // init
+
+void PlayStatsJournal::deinit()
+{
+	if(sInstance)
+	{
+		sInstance->compact();
+
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+PlayStatsJournal* PlayStatsJournal::getInstance()
+{
+	if(!sInstance)
+		sInstance = new PlayStatsJournal();
+
+	return sInstance;
+
+} // getInstance
+
+PlayStatsJournal::PlayStatsJournal() : mAppended(0)
+{
+	load();
+
+} // PlayStatsJournal
+
+PlayStatsJournal::~PlayStatsJournal()
+{
+	if(mStream.is_open())
+		mStream.close();
+
+} // ~PlayStatsJournal
+
+std::string PlayStatsJournal::getJournalPath()
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/playstats.journal";
+
+} // getJournalPath
+
+std::string PlayStatsJournal::getCompactingPath()
+{
+	return getJournalPath() + ".compacting";
+
+} // getCompactingPath
+
+bool PlayStatsJournal::isEnabled()
+{
+	return !Settings::getInstance()->getBool("IgnoreGamelist") && (Settings::getInstance()->getString("SaveGamelistsMode") != "never");
+
+} // isEnabled
+
+void PlayStatsJournal::load()
+{
+	// a journal moved aside whose gamelists were not written yet goes first, the current one holds newer records
+	load(getCompactingPath());
+	load(getJournalPath());
+
+	LOG(LogInfo) << "Loaded " << mAppended << " play statistics records";
+
+} // load
+
+void PlayStatsJournal::load(const std::string& _path)
+{
+	std::ifstream stream(_path);
+	if(!stream.is_open())
+		return;
+
+	std::string line;
+	while(std::getline(stream, line))
+	{
+		// system <tab> playcount <tab> lastplayed <tab> path, the path comes last as it may contain tabs
+		const size_t first  = line.find('\t');
+		const size_t second = (first  != std::string::npos) ? line.find('\t', first + 1)  : std::string::npos;
+		const size_t third  = (second != std::string::npos) ? line.find('\t', second + 1) : std::string::npos;
+
+		if(third == std::string::npos)
+		{
+			// most likely cut short by a crash or power cut while appending
+			LOG(LogWarning) << "Ignoring malformed play statistics record \"" << line << "\"";
+			continue;
+		}
+
+		Record& record    = mRecords[line.substr(0, first)][line.substr(third + 1)];
+		record.playCount  = atoi(line.substr(first + 1, second - first - 1).c_str());
+		record.lastPlayed = line.substr(second + 1, third - second - 1);
+		++mAppended;
+	}
+
+} // load
+
+void PlayStatsJournal::apply(SystemData* _system)
+{
+	auto systemIt = mRecords.find(_system->getName());
+	if(systemIt == mRecords.cend())
+		return;
+
+	const std::unordered_map<std::string, FileData*>& children = _system->getRootFolder()->getChildrenByFilename();
+	std::unordered_map<std::string, FileData*>        games;
+
+	for(auto it = systemIt->second.cbegin(); it != systemIt->second.cend(); ++it)
+	{
+		FileData* game = nullptr;
+
+		// most games live in the root folder, the others are indexed by path on the first miss
+		auto childIt = children.find(Utils::FileSystem::getFileName(it->first));
+		if((childIt != children.cend()) && (childIt->second->getPath() == it->first))
+			game = childIt->second;
+		else
+		{
+			if(games.empty())
+			{
+				std::vector<FileData*> files = _system->getRootFolder()->getFilesRecursive(GAME);
+				for(auto fileIt = files.cbegin(); fileIt != files.cend(); ++fileIt)
+					games[(*fileIt)->getPath()] = *fileIt;
+			}
+
+			auto gameIt = games.find(it->first);
+			if(gameIt != games.cend())
+				game = gameIt->second;
+		}
+
+		// the game is gone, its statistics are dropped with the next compaction
+		if(!game)
+			continue;
+
+		// marks the metadata as changed, so the next gamelist save picks the statistics up as well
+		game->metadata.set("playcount", std::to_string(static_cast<long long>(it->second.playCount)));
+		game->metadata.set("lastplayed", it->second.lastPlayed);
+	}
+
+} // apply
+
+void PlayStatsJournal::record(FileData* _game)
+{
+	if(!isEnabled())
+		return;
+
+	FileData*          game = _game->getSourceFileData();
+	const std::string& path = game->getPath();
+
+	Record& record    = mRecords[game->getSystem()->getName()][path];
+	record.playCount  = game->metadata.getInt("playcount");
+	record.lastPlayed = game->metadata.get("lastplayed");
+
+	if(!mStream.is_open())
+		mStream.open(getJournalPath(), std::ios_base::out | std::ios_base::app);
+
+	mStream << game->getSystem()->getName() << '\t' << record.playCount << '\t' << record.lastPlayed << '\t' << path << '\n';
+	mStream.flush();
+
+	if(!mStream)
+	{
+		LOG(LogError) << "Error appending to play statistics journal \"" << getJournalPath() << "\"";
+		mStream.close();
+		game->getSystem()->onMetaDataSavePoint();
+		return;
+	}
+
+	// gamelists saved "on exit" are not written before, the journal is what keeps the statistics until then
+	if((++mAppended >= COMPACT_RECORDS) && (Settings::getInstance()->getString("SaveGamelistsMode") == "always"))
+		compactAsync();
+
+} // record
+
+void PlayStatsJournal::queueGamelists(std::vector<SystemData*>& _systems)
+{
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); ++it)
+	{
+		if(!(*it)->isCollection() && (mRecords.find((*it)->getName()) != mRecords.cend()))
+		{
+			updateGamelist(*it);
+			_systems.push_back(*it);
+		}
+	}
+
+} // queueGamelists
+
+void PlayStatsJournal::compactAsync()
+{
+	// still waiting for the gamelists of the previous compaction, this one is tried again with the next launch
+	const std::string compactingPath = getCompactingPath();
+	if(std::ifstream(compactingPath).is_open())
+		return;
+
+	if(mStream.is_open())
+		mStream.close();
+
+	// launches from now on go to a new journal, the one moved aside holds what is being written
+	if(rename(getJournalPath().c_str(), compactingPath.c_str()) != 0)
+	{
+		LOG(LogError) << "Error moving play statistics journal \"" << getJournalPath() << "\" aside";
+		return;
+	}
+
+	std::vector<SystemData*> systems;
+	queueGamelists(systems);
+
+	LOG(LogInfo) << "Compacting " << mAppended << " play statistics records into " << systems.size() << " gamelists";
+
+	// the metadata holds everything that was journaled, getPlayCount() falls back to it
+	mRecords.clear();
+	mAppended = 0;
+
+	GamelistWriter::getInstance()->whenWritten(systems, [compactingPath]
+	{
+		remove(compactingPath.c_str());
+	});
+
+} // compactAsync
+
+void PlayStatsJournal::compact()
+{
+	if(!isEnabled())
+		return;
+
+	std::vector<SystemData*> systems;
+	queueGamelists(systems);
+
+	// the journals may only be emptied once the gamelists hold their records, else they are replayed on the next start
+	if(!GamelistWriter::getInstance()->flush())
+	{
+		LOG(LogError) << "Not all gamelists could be written, keeping the play statistics journal";
+		return;
+	}
+
+	if(mAppended)
+		LOG(LogInfo) << "Compacted " << mAppended << " play statistics records into the gamelists";
+
+	if(mStream.is_open())
+		mStream.close();
+
+	remove(getJournalPath().c_str());
+	remove(getCompactingPath().c_str());
+
+	mRecords.clear();
+	mAppended = 0;
+
+} // compact
+
+int PlayStatsJournal::getPlayCount(FileData* _game)
+{
+	FileData* game = _game->getSourceFileData();
+
+	auto systemIt = mRecords.find(game->getSystem()->getName());
+	if(systemIt != mRecords.cend())
+	{
+		auto it = systemIt->second.find(game->getPath());
+		if(it != systemIt->second.cend())
+			return it->second.playCount;
+	}
+
+	return game->metadata.getInt("playcount");
+
+} // getPlayCount
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef ES_APP_PLAY_STATS_JOURNAL_H
+#define ES_APP_PLAY_STATS_JOURNAL_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+class FileData;
+class SystemData;
+
+//
+// Records play statistics in ~/.emulationstation/playstats.journal instead of rewriting gamelist.xml.
+//
+// Every launch appends a single line holding the system, the play count, the last played time and
+// the path of the game. The journal is replayed into the metadata when a system is loaded and compacted
+// into the gamelists on exit, after which it starts over empty. With gamelists saved "always" it is also
+// compacted after a number of launches without waiting for the writes: the journal is moved aside and a
+// new one started, the moved one is removed by the gamelist writer once it wrote all of its systems.
+// Until then both are replayed on the next start. Nothing is journaled when gamelists are ignored or never saved.
+//
+class PlayStatsJournal
+{
+public:
+
+	static void              init       ();
+	static void              deinit     ();
+	static PlayStatsJournal* getInstance();
+
+	// Applies the journaled statistics of _system to its games, called once its gamelist is parsed
+	void apply       (SystemData* _system);
+	// Appends the current play count and last played time of _game
+	void record      (FileData* _game);
+	// Writes all journaled statistics into the gamelists and empties the journal once they are on disk, blocks
+	void compact     ();
+	int  getPlayCount(FileData* _game);
+
+private:
+
+	struct Record
+	{
+		int         playCount;
+		std::string lastPlayed;
+	};
+
+	 PlayStatsJournal();
+	~PlayStatsJournal();
+
+	static std::string getJournalPath   ();
+	static std::string getCompactingPath();
+	static bool        isEnabled        ();
+
+	void load          ();
+	void load          (const std::string& _path);
+	void compactAsync  ();
+	void queueGamelists(std::vector<SystemData*>& _systems);
+
+	static PlayStatsJournal* sInstance;
+
+	std::map<std::string, std::map<std::string, Record>> mRecords; // by system name and game path, not yet compacted
+	std::ofstream                                        mStream;
+	unsigned int                                         mAppended;
+
+}; // PlayStatsJournal
+
+#endif // ES_APP_PLAY_STATS_JOURNAL_H
@@ -1,46 +1,64 @@
 #include "ScraperCmdLine.h"
 
+#include "scrapers/ScraperPipeline.h"
+#include "utils/FileSystemUtil.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "GamelistWriter.h"
 #include "Log.h"
-#include "platform.h"
+#include "Settings.h"
 #include "SystemData.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <set>
 #include <signal.h>
-#if defined(__linux__)
-#include <unistd.h>
-#elif defined(WIN32)
-#include <Windows.h>
-#endif
+#include <thread>
+
+#define POLL_INTERVAL_MS   10
+#define REPORT_INTERVAL_MS 2000
 
 std::ostream& out = std::cout;
 
+static volatile sig_atomic_t interrupted = 0;
+
 void handle_interrupt_signal(int /*p*/)
 {
-	sleep(50);
-
-	LOG(LogInfo) << "Interrupt received during scrape...";
-
-	SystemData::deleteSystems();
+	// the first interrupt stops after writing what was scraped so far, a second one kills us right away
+	interrupted = 1;
+	signal(SIGINT, SIG_DFL);
+}
 
-	exit(1);
+static std::string getCheckpointPath()
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/scraper.checkpoint";
 }
 
-int run_scraper_cmdline()
+static std::string getCheckpointKey(SystemData* system, FileData* game)
 {
-	out << "EmulationStation scraper\n";
-	out << "========================\n";
-	out << "\n";
+	return system->getName() + "\t" + game->getPath();
+}
 
-	signal(SIGINT, handle_interrupt_signal);
+// every line names a game that was done by a previous run, as "system <tab> path"
+static std::set<std::string> loadCheckpoint()
+{
+	std::set<std::string> finished;
+	std::ifstream stream(getCheckpointPath());
 
-	//==================================================================================
-	//filter
-	//==================================================================================
-	enum FilterChoice
+	std::string line;
+	while(std::getline(stream, line))
 	{
-		FILTER_MISSING_IMAGES,
-		FILTER_ALL
-	};
+		if(line.find('\t') != std::string::npos)
+			finished.insert(line);
+	}
 
+	return finished;
+}
+
+static int askFilter()
+{
 	int filter_choice;
 	do {
 		out << "Select filter for games to be scraped:\n";
@@ -52,11 +70,11 @@ int run_scraper_cmdline()
 	} while(filter_choice < FILTER_MISSING_IMAGES || filter_choice > FILTER_ALL);
 
 	out << "\n";
+	return filter_choice;
+}
 
-	//==================================================================================
-	//platforms
-	//==================================================================================
-
+static std::vector<SystemData*> askSystems()
+{
 	std::vector<SystemData*> systems;
 
 	out << "You can scrape only specific platforms, or scrape all of them.\n";
@@ -70,6 +88,9 @@ int run_scraper_cmdline()
 		out << "Will scrape all platforms.\n";
 		for(auto i = SystemData::sSystemVector.cbegin(); i != SystemData::sSystemVector.cend(); i++)
 		{
+			if((*i)->isCollection())
+				continue;
+
 			out << "   " << (*i)->getName() << " (" << (*i)->getGameCount() << " games)\n";
 			systems.push_back(*i);
 		}
@@ -83,6 +104,9 @@ int run_scraper_cmdline()
 		do {
 			for(auto i = SystemData::sSystemVector.cbegin(); i != SystemData::sSystemVector.cend(); i++)
 			{
+				if((*i)->isCollection())
+					continue;
+
 				if(std::find(systems.cbegin(), systems.cend(), (*i)) != systems.cend())
 					out << " C ";
 				else
@@ -99,7 +123,7 @@ int run_scraper_cmdline()
 			bool found = false;
 			for(auto i = SystemData::sSystemVector.cbegin(); i != SystemData::sSystemVector.cend(); i++)
 			{
-				if((*i)->getName() == sys_name)
+				if(!(*i)->isCollection() && (*i)->getName() == sys_name)
 				{
 					systems.push_back(*i);
 					found = true;
@@ -113,178 +137,248 @@ int run_scraper_cmdline()
 		} while(true);
 	}
 
-	//==================================================================================
-	//manual mode
-	//==================================================================================
-
 	out << "\n";
-	out << "You can let the scraper try to automatically choose the best result, or\n";
-	out << "you can manually approve each result. This \"manual mode\" is much more accurate.\n";
-	out << "It is highly recommended you use manual mode unless you have a very large collection.\n";
-	out << "Scrape in manual mode? (y/n)\n";
+	return systems;
+}
 
-	std::string manual_mode_str;
-	std::getline(std::cin, manual_mode_str);
+static bool findSystems(const std::vector<std::string>& names, std::vector<SystemData*>& systems)
+{
+	const bool all = names.empty() || (std::find(names.cbegin(), names.cend(), "all") != names.cend());
 
-	bool manual_mode = false;
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
+	{
+		if(!(*it)->isCollection() && (all || (std::find(names.cbegin(), names.cend(), (*it)->getName()) != names.cend())))
+			systems.push_back(*it);
+	}
 
-	if(manual_mode_str == "y" || manual_mode_str == "Y")
+	if(all)
+		return true;
+
+	bool found = true;
+	for(auto it = names.cbegin(); it != names.cend(); it++)
 	{
-		manual_mode = true;
-		out << "Scraping in manual mode!\n";
-	}else{
-		out << "Scraping in automatic mode!\n";
+		auto sysIt = std::find_if(systems.cbegin(), systems.cend(), [it](SystemData* system) { return system->getName() == *it; });
+		if(sysIt == systems.cend())
+		{
+			std::cerr << "System \"" << *it << "\" not found.\n";
+			found = false;
+		}
 	}
 
-	//==================================================================================
-	//scraping
-	//==================================================================================
+	return found;
+}
+
+static void reportProgress(const ScraperPipeline& pipeline, const std::chrono::steady_clock::time_point& start)
+{
+	const double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+	const unsigned int completed = pipeline.getCompletedCount();
+	const double rate = (elapsed > 0) ? (completed / elapsed) : 0;
+
+	out << "   " << completed << " of " << pipeline.getTotalCount() << " games done ("
+		<< pipeline.getSuccessfulCount() << " scraped, " << pipeline.getSkippedCount() << " skipped), "
+		<< std::fixed << std::setprecision(2) << rate << " games/s";
+
+	if(rate > 0 && completed < pipeline.getTotalCount())
+		out << ", about " << (int)((pipeline.getTotalCount() - completed) / rate) << " s left";
+
 	out << "\n";
-	out << "Alright, let's do this thing!\n";
-	out << "=============================\n";
+	out.flush();
+}
 
-	/*
-	std::shared_ptr<Scraper> scraper = Settings::getInstance()->getScraper();
-	for(auto sysIt = systems.cbegin(); sysIt != systems.cend(); sysIt++)
+// scrapes a single system and writes its gamelist once, returns false if interrupted
+static bool scrapeSystem(SystemData* system, int filter, const std::set<std::string>& finished, std::ofstream& checkpoint, unsigned int& scraped, unsigned int& skipped)
+{
+	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
+	std::queue<ScraperSearchParams> searches;
+	unsigned int filtered = 0;
+	unsigned int resumed = 0;
+
+	for(auto it = files.cbegin(); it != files.cend(); it++)
 	{
-		std::vector<FileData*> files = (*sysIt)->getRootFolder()->getFilesRecursive(GAME);
+		if(finished.find(getCheckpointKey(system, *it)) != finished.cend())
+		{
+			++resumed;
+			continue;
+		}
+
+		//maybe should also check if the image file exists/is a URL
+		if(filter == FILTER_MISSING_IMAGES && !(*it)->metadata.get("image").empty())
+		{
+			++filtered;
+			continue;
+		}
 
 		ScraperSearchParams params;
-		params.system = (*sysIt);
+		params.system = system;
+		params.game = *it;
+		searches.push(params);
+	}
+
+	out << system->getFullName() << " (" << system->getName() << "): " << searches.size() << " games to scrape";
+	if(filtered)
+		out << ", " << filtered << " already have images";
+	if(resumed)
+		out << ", " << resumed << " done by a previous run";
+	out << "\n";
+
+	if(searches.empty())
+		return true;
+
+	std::vector<std::string> done;
+
+	ScraperPipeline pipeline(searches);
+	pipeline.setCompletedCallback([&done](const ScraperSearchParams& params, bool success)
+	{
+		// failed games are tried again by --scrape-resume, the failure may have been a passing network error
+		if(success)
+			done.push_back(getCheckpointKey(params.system, params.game));
 
-		for(auto gameIt = files.cbegin(); gameIt != files.cend(); gameIt++)
+		out << "   " << Utils::FileSystem::getFileName(params.game->getPath());
+		if(success)
+			out << " -> " << params.game->metadata.get("name") << "\n";
+		else
+			out << " - no result, skipped\n";
+	});
+
+	const auto start = std::chrono::steady_clock::now();
+	auto lastReport = start;
+
+	while(!pipeline.isDone() && !interrupted)
+	{
+		pipeline.update();
+
+		const auto now = std::chrono::steady_clock::now();
+		if((now - lastReport) >= std::chrono::milliseconds(REPORT_INTERVAL_MS))
 		{
-			params.nameOverride = "";
-			params.game = *gameIt;
+			reportProgress(pipeline, start);
+			lastReport = now;
+		}
 
-			//print original search term
-			out << getCleanFileName(params.game->getPath()) << "...\n";
+		std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+	}
 
-			//need to take into account filter_choice
-			if(filter_choice == FILTER_MISSING_IMAGES)
-			{
-				if(!params.game->metadata.get("image").empty()) //maybe should also check if the image file exists/is a URL
-				{
-					out << "   Skipping, metadata \"image\" entry is not empty.\n";
-					continue;
-				}
-			}
+	if(interrupted)
+	{
+		out << "Interrupted, writing what was scraped so far...\n";
+		pipeline.stop();
+	}
 
-			//actually get some results
-			do {
-				std::vector<MetaDataList> mdls = scraper->getResults(params);
+	// a single write for the whole system, the checkpoint only lists games once their metadata is on disk
+	pipeline.commit();
+	if(GamelistWriter::getInstance()->flush(system))
+	{
+		for(auto it = done.cbegin(); it != done.cend(); it++)
+			checkpoint << *it << '\n';
+		checkpoint.flush();
+	}
+	else
+	{
+		out << "The gamelist of " << system->getName() << " could not be written, its games are scraped again on resume\n";
+	}
 
-				//no results
-				if(mdls.size() == 0)
-				{
-					if(manual_mode)
-					{
-						//in manual mode let the user enter a custom search
-						out << "   NO RESULTS FOUND! Enter a new name to search for, or nothing to skip.\n";
+	reportProgress(pipeline, start);
 
-						std::getline(std::cin, params.nameOverride);
+	scraped += pipeline.getSuccessfulCount();
+	skipped += pipeline.getSkippedCount();
 
-						if(params.nameOverride.empty())
-						{
-							out << "   Skipping...\n";
-							break;
-						}
+	return !interrupted;
+}
 
-						continue;
+int run_scraper_cmdline(const ScraperCmdLineOptions& options)
+{
+	out << "EmulationStation scraper\n";
+	out << "========================\n";
+	out << "\n";
 
-					}else{
-						out << "   NO RESULTS FOUND! Skipping...\n";
-						break;
-					}
-				}
+	if(!isValidConfiguredScraper())
+	{
+		std::cerr << "Configured scraper \"" << Settings::getInstance()->getString("Scraper") << "\" is unavailable.\n";
+		return 1;
+	}
 
-				//some results
-				if(manual_mode)
-				{
-					//print list of choices
-					for(unsigned int i = 0; i < mdls.size(); i++)
-					{
-						out << "   " << i << " - " << mdls.at(i).get("name") << "\n";
-					}
-
-					int choice = -1;
-					std::string choice_str;
-
-					out << "Your choice: ";
-
-					std::getline(std::cin, choice_str);
-					std::stringstream choice_buff(choice_str); //convert to int
-					choice_buff >> choice;
-
-					if(choice >= 0 && choice < (int)mdls.size())
-					{
-						params.game->metadata = mdls.at(choice);
-						break;
-					}else{
-						out << "Invalid choice.\n";
-						continue;
-					}
-
-				}else{
-					//automatic mode
-					//always choose the first choice
-					out << "   name -> " << mdls.at(0).get("name") << "\n";
-					params.game->metadata = mdls.at(0);
-					break;
-				}
+	if(Settings::getInstance()->getBool("IgnoreGamelist"))
+		out << "Gamelists are ignored, nothing scraped will be saved!\n\n";
 
-			} while(true);
+	// nothing is asked for once any option was given, so it can run unattended
+	const bool batch = (options.filter != -1) || !options.systems.empty() || options.resume;
 
-			out << "===================\n";
-		}
+	//==================================================================================
+	//filter
+	//==================================================================================
+	int filter_choice = options.filter;
+	if(filter_choice == -1)
+		filter_choice = batch ? FILTER_MISSING_IMAGES : askFilter();
+
+	//==================================================================================
+	//platforms
+	//==================================================================================
+	std::vector<SystemData*> systems;
+	if(batch)
+	{
+		if(!findSystems(options.systems, systems))
+			return 1;
+	}else{
+		systems = askSystems();
 	}
 
-	out << "\n\n";
-	out << "Downloading boxart...\n";
+	if(options.jobs > 0)
+		Settings::getInstance()->setInt("ScraperParallelSearches", options.jobs);
 
-	for(auto sysIt = systems.cbegin(); sysIt != systems.cend(); sysIt++)
+	//==================================================================================
+	//checkpoint
+	//==================================================================================
+	std::set<std::string> finished;
+	if(options.resume)
 	{
-		std::vector<FileData*> files = (*sysIt)->getRootFolder()->getFilesRecursive(GAME);
+		finished = loadCheckpoint();
+		out << "Resuming, " << finished.size() << " games were done by a previous run.\n";
+	}
 
-		for(auto gameIt = files.cbegin(); gameIt != files.cend(); gameIt++)
-		{
-			FileData* game = *gameIt;
-			const std::vector<MetaDataDecl>& mdd = game->metadata.getMDD();
-			for(auto i = mdd.cbegin(); i != mdd.cend(); i++)
-			{
-				std::string key = i->key;
-				std::string url = game->metadata.get(key);
+	std::ofstream checkpoint(getCheckpointPath(), std::ios_base::out | (options.resume ? std::ios_base::app : std::ios_base::trunc));
+	if(!checkpoint.is_open())
+		LOG(LogWarning) << "Could not open scraper checkpoint \"" << getCheckpointPath() << "\", an interrupted run can not be resumed";
 
-				if(i->type == MD_IMAGE_PATH && HttpReq::isUrl(url))
-				{
-					std::string urlShort = url.substr(0, url.length() > 35 ? 35 : url.length());
-					if(url.length() != urlShort.length()) urlShort += "...";
-
-					out << "   " << game->metadata.get("name") << " [from: " << urlShort << "]...\n";
-
-					ScraperSearchParams p;
-					p.game = game;
-					p.system = *sysIt;
-					game->metadata.set(key, downloadImage(url, getSaveAsPath(p, key, url)));
-					if(game->metadata.get(key).empty())
-					{
-						out << "     FAILED! Skipping.\n";
-						game->metadata.set(key, url); //result URL to what it was if download failed, retry some other time
-					}
-				}
-			}
+	//==================================================================================
+	//scraping
+	//==================================================================================
+	out << "\n";
+	out << "Scraping " << systems.size() << " system" << ((systems.size() != 1) ? "s" : "") << " with "
+		<< Settings::getInstance()->getInt("ScraperParallelSearches") << " parallel searches using " << Settings::getInstance()->getString("Scraper") << "\n";
+	out << "Press Ctrl+C to stop, the games scraped so far are saved and can be resumed with --scrape-resume.\n";
+	out << "=============================\n";
+
+	signal(SIGINT, handle_interrupt_signal);
+
+	const auto start = std::chrono::steady_clock::now();
+	unsigned int scraped = 0;
+	unsigned int skipped = 0;
+	bool completed = true;
+
+	for(auto sysIt = systems.cbegin(); sysIt != systems.cend(); sysIt++)
+	{
+		if(!scrapeSystem(*sysIt, filter_choice, finished, checkpoint, scraped, skipped))
+		{
+			completed = false;
+			break;
 		}
 	}
 
+	signal(SIGINT, SIG_DFL);
+	checkpoint.close();
+
+	// the checkpoint is only of use to resume an interrupted run
+	if(completed)
+		remove(getCheckpointPath().c_str());
+
+	const long long elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start).count();
 
 	out << "\n\n";
 	out << "==============================\n";
-	out << "SCRAPE COMPLETE!\n";
+	out << (completed ? "SCRAPE COMPLETE!\n" : "SCRAPE INTERRUPTED!\n");
+	out << scraped << " games scraped, " << skipped << " skipped in " << elapsed << " s\n";
 	out << "==============================\n";
-	*/
 
-	out << "\n\n";
-	out << "ACTUALLY THIS IS STILL TODO\n";
+	LOG(LogInfo) << "Command line scraper " << (completed ? "finished" : "interrupted") << ", " << scraped << " games scraped, " << skipped << " skipped in " << elapsed << " s";
 
-	return 0;
+	return completed ? 0 : 1;
 }
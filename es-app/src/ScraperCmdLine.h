@@ -2,6 +2,26 @@
 #ifndef ES_APP_SCRAPER_CMD_LINE_H
 #define ES_APP_SCRAPER_CMD_LINE_H
 
-int run_scraper_cmdline();
+#include <string>
+#include <vector>
+
+enum ScraperFilterChoice
+{
+	FILTER_MISSING_IMAGES,
+	FILTER_ALL
+};
+
+// Set from the --scrape-* arguments, anything left unset is asked for unless another one was given
+struct ScraperCmdLineOptions
+{
+	ScraperCmdLineOptions() : filter(-1), jobs(0), resume(false) {};
+
+	int filter;                       // ScraperFilterChoice, -1 if not given
+	std::vector<std::string> systems; // system names, "all" for every system
+	int jobs;                         // parallel searches, 0 keeps the setting
+	bool resume;                      // skip the games finished by an interrupted run
+};
+
+int run_scraper_cmdline(const ScraperCmdLineOptions& options);
 
 #endif // ES_APP_SCRAPER_CMD_LINE_H
@@ -7,6 +7,7 @@
 #include "Gamelist.h"
 #include "Log.h"
 #include "platform.h"
+#include "PlayStatsJournal.h"
 #include "Settings.h"
 #include "ThemeData.h"
 #include "views/UIModeController.h"
@@ -38,7 +39,10 @@ SystemData::SystemData(const std::string& name, const std::string& fullName, Sys
 			populateFolder(mRootFolder);
 
 		if(!Settings::getInstance()->getBool("IgnoreGamelist"))
+		{
 			parseGamelist(this);
+			PlayStatsJournal::getInstance()->apply(this);
+		}
 
 		mRootFolder->sort(FileSorts::SortTypes.at(0));
 
@@ -13,6 +13,7 @@
 #include "FileData.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "MediaIndex.h"
 #include "PowerSaver.h"
 #include "Scripting.h"
 #include "Sound.h"
@@ -27,6 +28,25 @@
 
 static int lastIndex = 0;
 
+// the main thread only asks the MediaIndex what it knows already, a directory it did not list yet is handed to
+// the background prefetch and the media counts as pending until then
+static bool mediaExists(const std::string& _path, bool& _pending)
+{
+	MediaIndex* index  = MediaIndex::getInstance();
+	bool        exists = false;
+
+	_pending = false;
+	if(index->lookup(_path, exists))
+		return exists;
+
+	// nothing left to hand it to
+	if(!ViewController::get()->prefetchMedia(Utils::FileSystem::getParent(Utils::FileSystem::getGenericPath(_path))))
+		return index->exists(_path);
+
+	_pending = true;
+	return false;
+}
+
 SystemScreenSaver::SystemScreenSaver(Window* window) :
 	mVideoScreensaver(NULL),
 	mImageScreensaver(NULL),
@@ -236,19 +256,20 @@ void SystemScreenSaver::startScreenSaver(SystemData* system)
 		std::string path = "";
 		pickRandomVideo(path, mCurrentGame != NULL);
 
+		bool pending = false;
 		int retry = 200;
-		while(retry > 0 && ((path.empty() || !Utils::FileSystem::exists(path)) || mCurrentGame == NULL))
+		while(retry > 0 && (!mediaExists(path, pending) || mCurrentGame == NULL))
 		{
 			retry--;
 			pickRandomVideo(path);
 		}
 
-		if (!path.empty() && Utils::FileSystem::exists(path))
+		if (mediaExists(path, pending))
 		{
 			setVideoScreensaver(path);
 			if (mCurrentGame != NULL)
 			{
-				Scripting::fireEvent("screensaver-game-select", mCurrentGame->getSystem()->getName(), mCurrentGame->getPath(), mCurrentGame->getName(), "randomvideo");
+				Scripting::fireEventAsync("screensaver-game-select", mCurrentGame->getSystem()->getName(), mCurrentGame->getPath(), mCurrentGame->getName(), "randomvideo");
 			}
 			return;
 		}
@@ -291,7 +312,7 @@ void SystemScreenSaver::startScreenSaver(SystemData* system)
 
 		if (mCurrentGame != NULL)
 		{
-			Scripting::fireEvent("screensaver-game-select", mCurrentGame->getSystem()->getName(), mCurrentGame->getFileName(), mCurrentGame->getName(), "slideshow");
+			Scripting::fireEventAsync("screensaver-game-select", mCurrentGame->getSystem()->getName(), mCurrentGame->getFileName(), mCurrentGame->getName(), "slideshow");
 		}
 		return;
 	}
@@ -399,15 +420,18 @@ void SystemScreenSaver::backgroundIndexing()
 	SystemData* all = CollectionSystemManager::get()->getAllGamesCollection();
 	std::vector<FileData*> files = all->getRootFolder()->getFilesRecursive(GAME);
 
+	// every media directory is listed once into the MediaIndex, the remaining lookups are answered from memory
+	MediaIndex* index = MediaIndex::getInstance();
+
 	const auto startTs = std::chrono::system_clock::now();
 	for ( ; lastIndex < files.size(); lastIndex++)
 	{
 		if(mExit)
 			break;
-		Utils::FileSystem::exists(files.at(lastIndex)->getVideoPath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getMarqueePath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getThumbnailPath());
-		Utils::FileSystem::exists(files.at(lastIndex)->getImagePath());
+		index->exists(files.at(lastIndex)->getVideoPath());
+		index->exists(files.at(lastIndex)->getMarqueePath());
+		index->exists(files.at(lastIndex)->getThumbnailPath());
+		index->exists(files.at(lastIndex)->getImagePath());
 	}
 	auto endTs = std::chrono::system_clock::now();
 	LOG(LogDebug) << "Indexed a total of " << lastIndex << " entries in " << std::chrono::duration_cast<std::chrono::milliseconds>(endTs - startTs).count() << " ms. Stopping.";
@@ -438,6 +462,8 @@ void SystemScreenSaver::pickGameListNode(const char *nodeName)
 	FileData *itf = nullptr;
 	bool found =  false;
 	int missCtr = 0;
+	// candidates whose media directory is still being indexed get another chance on the next pick
+	std::vector<FileData*> pendingFiles;
 	while (!found)
 	{
 		if (mAllFiles.empty())
@@ -454,21 +480,31 @@ void SystemScreenSaver::pickGameListNode(const char *nodeName)
 
 		itf = mAllFiles.back();
 		mAllFiles.pop_back();
-		if ((strcmp(nodeName, "video") == 0 && itf->getVideoPath() != "") ||
-			(strcmp(nodeName, "image") == 0 && itf->getImagePath() != ""))
+		// media named in the metadata may be gone, the index tells without touching the disk
+		bool pending = false;
+		if ((strcmp(nodeName, "video") == 0 && mediaExists(itf->getVideoPath(), pending)) ||
+			(strcmp(nodeName, "image") == 0 && mediaExists(itf->getImagePath(), pending)))
 		{
 			found = true;
 		}
 		else
 		{
+			if (pending)
+				pendingFiles.push_back(itf);
+
 			missCtr++;
 			if (missCtr == mAllFilesSize)
+			{
 				// avoid looping forever when no candidate exist
 				// with image/video path set
+				mAllFiles.insert(mAllFiles.begin(), pendingFiles.cbegin(), pendingFiles.cend());
 				return;
+			}
 		}
 	}
 
+	mAllFiles.insert(mAllFiles.begin(), pendingFiles.cbegin(), pendingFiles.cend());
+
 	mCurrentGame = itf;
 }
 
@@ -24,6 +24,8 @@ class TextListComponent : public IList<TextListData, T>
 {
 protected:
 	using IList<TextListData, T>::mEntries;
+	using IList<TextListData, T>::mMaterialized;
+	using IList<TextListData, T>::getEntryAt;
 	using IList<TextListData, T>::listUpdate;
 	using IList<TextListData, T>::listInput;
 	using IList<TextListData, T>::listRenderTitleOverlay;
@@ -64,15 +66,13 @@ public:
 	inline void setFont(const std::shared_ptr<Font>& font)
 	{
 		mFont = font;
-		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		resetTextCaches();
 	}
 
 	inline void setUppercase(bool uppercase)
 	{
 		mUppercase = uppercase;
-		for(auto it = mEntries.begin(); it != mEntries.end(); it++)
-			it->data.textCache.reset();
+		resetTextCaches();
 	}
 
 	inline void setSelectorHeight(float selectorScale) { mSelectorHeight = selectorScale; }
@@ -97,6 +97,7 @@ private:
 	float mHorizontalMargin;
 
 	int viewportTop();
+	void resetTextCaches();
 	std::function<void(CursorState state)> mCursorChangedCallback;
 
 	std::shared_ptr<Font> mFont;
@@ -191,7 +192,7 @@ void TextListComponent<T>::render(const Transform4x4f& parentTrans)
 
 	for(int i = mViewportTop; i < listCutoff; i++)
 	{
-		typename IList<TextListData, T>::Entry& entry = mEntries.at((unsigned int)i);
+		typename IList<TextListData, T>::Entry& entry = getEntryAt(i);
 
 		unsigned int color;
 		if(mCursor == i && mSelectedColor)
@@ -330,12 +331,15 @@ void TextListComponent<T>::update(int deltaTime)
 
 	if(!isScrolling() && size() > 0)
 	{
+		const int prevMarqueeOffset  = mMarqueeOffset;
+		const int prevMarqueeOffset2 = mMarqueeOffset2;
+
 		// always reset the marquee offsets
 		mMarqueeOffset  = 0;
 		mMarqueeOffset2 = 0;
 
 		// if we're not scrolling and this object's text goes outside our size, marquee it!
-		auto name = mEntries.at((unsigned int)mCursor).name;
+		auto name = getEntryAt(mCursor).name;
 		const float textLength = mFont->sizeText(mUppercase ? Utils::String::toUpper(name) : name).x();
 		const float limit      = mSize.x() - mHorizontalMargin * 2;
 
@@ -360,6 +364,9 @@ void TextListComponent<T>::update(int deltaTime)
 			if(mMarqueeOffset > (scrollLength - (limit - returnLength)))
 				mMarqueeOffset2 = (int)(mMarqueeOffset - (scrollLength + returnLength));
 		}
+
+		if((mMarqueeOffset != prevMarqueeOffset) || (mMarqueeOffset2 != prevMarqueeOffset2))
+			Window::invalidate();
 	}
 
 	GuiComponent::update(deltaTime);
@@ -378,6 +385,15 @@ void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned i
 	static_cast<IList< TextListData, T >*>(this)->add(entry);
 }
 
+template <typename T>
+void TextListComponent<T>::resetTextCaches()
+{
+	for(auto it = mEntries.begin(); it != mEntries.end(); it++)
+		it->data.textCache.reset();
+	for(auto it = mMaterialized.begin(); it != mMaterialized.end(); it++)
+		it->second.data.textCache.reset();
+}
+
 template <typename T>
 void TextListComponent<T>::onCursorChanged(const CursorState& state)
 {
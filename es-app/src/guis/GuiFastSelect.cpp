@@ -142,23 +142,32 @@ void GuiFastSelect::updateGameListSort()
 
 void GuiFastSelect::updateGameListCursor()
 {
-	const std::vector<FileData*>& list = mGameList->getCursor()->getParent()->getChildrenListToDisplay();
-
 	// only skip by letter when the sort mode is alphabetical
 	const FileData::SortType& sort = FileSorts::SortTypes.at(mSortId);
 	if(sort.comparisonFunction != &FileSorts::compareName)
 		return;
 
-	// find the first entry in the list that either exactly matches our target letter or is beyond our target letter
-	for(auto it = list.cbegin(); it != list.cend(); it++)
-	{
-		char check = (*it)->getName().empty() ? 'A' : (*it)->getName()[0];
+	FileData* folder = mGameList->getCursor()->getParent();
+	const unsigned char letter = LETTERS[mLetterId];
 
-		// if there's an exact match or we've passed it, set the cursor to this one
-		if(check == LETTERS[mLetterId] || (sort.ascending && check > LETTERS[mLetterId]) || (!sort.ascending && check < LETTERS[mLetterId]))
+	// find the first entry that either exactly matches our target letter or is beyond our target letter,
+	// which is the first one of the nearest letter after it when ascending and the earliest of all letters up to it when descending
+	int index = -1;
+	if(sort.ascending)
+	{
+		for(int c = letter; c < 256 && index == -1; c++)
+			index = folder->getFirstIndexOfLetter((unsigned char)c);
+	}
+	else
+	{
+		for(int c = 0; c <= letter; c++)
 		{
-			mGameList->setCursor(*it);
-			break;
+			const int first = folder->getFirstIndexOfLetter((unsigned char)c);
+			if(first != -1 && (index == -1 || first < index))
+				index = first;
 		}
 	}
+
+	if(index != -1)
+		mGameList->setCursor(folder->getChildrenListToDisplay().at(index));
 }
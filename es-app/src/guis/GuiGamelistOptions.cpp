@@ -44,19 +44,14 @@ GuiGamelistOptions::GuiGamelistOptions(Window* window, SystemData* system) : Gui
 			}
 
 			mJumpToLetterList = std::make_shared<LetterList>(mWindow, "JUMP TO ...", false);
+			FileData* folder = getGamelist()->getCursor()->getParent();
 			for (char c = startChar; c <= endChar; c++)
 			{
 				// check if c is a valid first letter in current list
-				const std::vector<FileData*>& files = getGamelist()->getCursor()->getParent()->getChildrenListToDisplay();
-				for (auto file : files)
+				if (folder->getFirstIndexOfLetter(c) != -1)
 				{
-					char candidate = (char)toupper(file->getSortName()[0]);
-					if (c == candidate)
-					{
-						mJumpToLetterList->add(std::string(1, c), c, (c == curChar) || outOfRange);
-						outOfRange = false; // only override selection on very first c == candidate match
-						break;
-					}
+					mJumpToLetterList->add(std::string(1, c), c, (c == curChar) || outOfRange);
+					outOfRange = false; // only override selection on very first c == candidate match
 				}
 			}
 
@@ -279,32 +274,10 @@ void GuiGamelistOptions::jumpToLetter()
 	char letter = mJumpToLetterList->getSelected();
 	IGameListView* gamelist = getGamelist();
 
-	// this is a really shitty way to get a list of files
-	const std::vector<FileData*>& files = gamelist->getCursor()->getParent()->getChildrenListToDisplay();
-
-	long min = 0;
-	long max = (long)files.size() - 1;
-	long mid = 0;
-
-	while(max >= min)
-	{
-		mid = ((max - min) / 2) + min;
-
-		// game somehow has no first character to check
-		if(files.at(mid)->getName().empty())
-			continue;
-
-		char checkLetter = (char)toupper(files.at(mid)->getSortName()[0]);
-
-		if(checkLetter < letter)
-			min = mid + 1;
-		else if(checkLetter > letter || (mid > 0 && (letter == toupper(files.at(mid - 1)->getSortName()[0]))))
-			max = mid - 1;
-		else
-			break; //exact match found
-	}
-
-	gamelist->setCursor(files.at(mid));
+	FileData* folder = gamelist->getCursor()->getParent();
+	const int index = folder->getFirstIndexOfLetter(letter);
+	if(index != -1)
+		gamelist->setCursor(folder->getChildrenListToDisplay().at(index));
 
 	// flag to force default sort order "name, asc", if user changed the sortorder in the options dialog
 	mJumpToSelected = true;
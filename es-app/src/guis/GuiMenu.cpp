@@ -343,8 +343,8 @@ void GuiMenu::openUISettings()
 				FileData* root = (*it)->getRootFolder();
 				root->sort(getSortTypeFromString(root->getSortName()));
 
-				//Notify that the root folder was sorted
-				ViewController::get()->getGameListView((*it))->onFileChanged(root, FILE_SORTED);
+				//Notify that the root folder was sorted, views not built yet will be sorted when built
+				ViewController::get()->onFileChanged(root, FILE_SORTED);
 			}
 
 			//Display popup to inform user
@@ -5,11 +5,13 @@
 #include "components/ScraperSearchComponent.h"
 #include "components/TextComponent.h"
 #include "guis/GuiMsgBox.h"
+#include "scrapers/ScraperPipeline.h"
 #include "views/ViewController.h"
 #include "Gamelist.h"
 #include "PowerSaver.h"
 #include "SystemData.h"
 #include "Window.h"
+#include <algorithm>
 
 GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchParams>& searches, bool approveResults) :
 	GuiComponent(window), mBackground(window, ":/frame.png"), mGrid(window, Vector2i(1, 5)),
@@ -38,12 +40,19 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	mSubtitle = std::make_shared<TextComponent>(mWindow, "subtitle text", Font::get(FONT_SIZE_SMALL), 0x888888FF, ALIGN_CENTER);
 	mGrid.setEntry(mSubtitle, Vector2i(0, 2), false, true);
 
-	mSearchComp = std::make_shared<ScraperSearchComponent>(mWindow,
-		approveResults ? ScraperSearchComponent::ALWAYS_ACCEPT_MATCHING_CRC : ScraperSearchComponent::ALWAYS_ACCEPT_FIRST_RESULT);
-	mSearchComp->setAcceptCallback(std::bind(&GuiScraperMulti::acceptResult, this, std::placeholders::_1));
-	mSearchComp->setSkipCallback(std::bind(&GuiScraperMulti::skip, this));
-	mSearchComp->setCancelCallback(std::bind(&GuiScraperMulti::finish, this));
-	mGrid.setEntry(mSearchComp, Vector2i(0, 3), mSearchComp->getSearchType() != ScraperSearchComponent::ALWAYS_ACCEPT_FIRST_RESULT, true);
+	if(approveResults)
+	{
+		mSearchComp = std::make_shared<ScraperSearchComponent>(mWindow, ScraperSearchComponent::ALWAYS_ACCEPT_MATCHING_CRC);
+		mSearchComp->setAcceptCallback(std::bind(&GuiScraperMulti::acceptResult, this, std::placeholders::_1));
+		mSearchComp->setSkipCallback(std::bind(&GuiScraperMulti::skip, this));
+		mSearchComp->setCancelCallback(std::bind(&GuiScraperMulti::finish, this));
+		mGrid.setEntry(mSearchComp, Vector2i(0, 3), true, true);
+	}else{
+		// nothing to approve, several games are scraped at once and only the progress is shown
+		mPipeline = std::unique_ptr<ScraperPipeline>(new ScraperPipeline(mSearchQueue));
+		mLastScraped = std::make_shared<TextComponent>(mWindow, "", Font::get(FONT_SIZE_SMALL), 0x777777FF, ALIGN_CENTER);
+		mGrid.setEntry(mLastScraped, Vector2i(0, 3), false, true);
+	}
 
 	std::vector< std::shared_ptr<ButtonComponent> > buttons;
 
@@ -68,7 +77,10 @@ GuiScraperMulti::GuiScraperMulti(Window* window, const std::queue<ScraperSearchP
 	setSize(Renderer::getScreenWidth() * 0.95f, Renderer::getScreenHeight() * 0.849f);
 	setPosition((Renderer::getScreenWidth() - mSize.x()) / 2, (Renderer::getScreenHeight() - mSize.y()) / 2);
 
-	doNextSearch();
+	if(mPipeline)
+		updateProgress();
+	else
+		doNextSearch();
 }
 
 GuiScraperMulti::~GuiScraperMulti()
@@ -89,6 +101,40 @@ void GuiScraperMulti::onSizeChanged()
 	mGrid.setSize(mSize);
 }
 
+void GuiScraperMulti::update(int deltaTime)
+{
+	GuiComponent::update(deltaTime);
+
+	if(!mPipeline || !mIsProcessing)
+		return;
+
+	mPipeline->update();
+	updateProgress();
+
+	if(mPipeline->isDone())
+		finish();
+}
+
+void GuiScraperMulti::updateProgress()
+{
+	mCurrentGame = mPipeline->getCompletedCount();
+	mTotalSuccessful = mPipeline->getSuccessfulCount();
+	mTotalSkipped = mPipeline->getSkippedCount();
+
+	std::stringstream ss;
+	ss << "GAME " << std::min(mCurrentGame + 1, mTotalGames) << " OF " << mTotalGames << " - " << mPipeline->getInFlightCount() << " IN PROGRESS";
+	mSubtitle->setText(ss.str());
+
+	const ScraperSearchParams* last = mPipeline->getLastCompleted();
+	if(last)
+	{
+		mSystem->setText(Utils::String::toUpper(last->system->getFullName()));
+		mLastScraped->setText("LAST: " + Utils::String::toUpper(Utils::FileSystem::getFileName(last->game->getPath())));
+	}else{
+		mSystem->setText(Utils::String::toUpper(mSearchQueue.front().system->getFullName()));
+	}
+}
+
 void GuiScraperMulti::doNextSearch()
 {
 	if(mSearchQueue.empty())
@@ -114,7 +160,7 @@ void GuiScraperMulti::acceptResult(const ScraperSearchResult& result)
 	ScraperSearchParams& search = mSearchQueue.front();
 
 	search.game->metadata = result.mdl;
-	updateGamelist(search.system);
+	mScrapedSystems.insert(search.system);
 
 	mSearchQueue.pop();
 	mCurrentGame++;
@@ -132,6 +178,19 @@ void GuiScraperMulti::skip()
 
 void GuiScraperMulti::finish()
 {
+	// everything scraped so far is kept, the gamelists are written once for the whole run
+	if(mPipeline)
+	{
+		mPipeline->stop();
+		mPipeline->commit();
+		mTotalSuccessful = mPipeline->getSuccessfulCount();
+		mTotalSkipped = mPipeline->getSkippedCount();
+	}
+
+	for(auto it = mScrapedSystems.cbegin(); it != mScrapedSystems.cend(); it++)
+		updateGamelist(*it);
+	mScrapedSystems.clear();
+
 	std::stringstream ss;
 	if(mTotalSuccessful == 0)
 	{
@@ -6,7 +6,9 @@
 #include "components/NinePatchComponent.h"
 #include "scrapers/Scraper.h"
 #include "GuiComponent.h"
+#include <set>
 
+class ScraperPipeline;
 class ScraperSearchComponent;
 class TextComponent;
 
@@ -17,6 +19,7 @@ public:
 	virtual ~GuiScraperMulti();
 
 	void onSizeChanged() override;
+	void update(int deltaTime) override;
 	std::vector<HelpPrompt> getHelpPrompts() override;
 
 private:
@@ -24,6 +27,8 @@ private:
 	void skip();
 	void doNextSearch();
 
+	void updateProgress();
+
 	void finish();
 
 	unsigned int mTotalGames;
@@ -31,6 +36,10 @@ private:
 	unsigned int mTotalSuccessful;
 	unsigned int mTotalSkipped;
 	std::queue<ScraperSearchParams> mSearchQueue;
+	std::set<SystemData*> mScrapedSystems;
+
+	// scrapes without user interaction when results do not need to be approved
+	std::unique_ptr<ScraperPipeline> mPipeline;
 
 	NinePatchComponent mBackground;
 	ComponentGrid mGrid;
@@ -39,6 +48,7 @@ private:
 	std::shared_ptr<TextComponent> mSystem;
 	std::shared_ptr<TextComponent> mSubtitle;
 	std::shared_ptr<ScraperSearchComponent> mSearchComp;
+	std::shared_ptr<TextComponent> mLastScraped;
 	std::shared_ptr<ComponentGrid> mButtonGrid;
 };
 
@@ -3,20 +3,29 @@
 
 #include "guis/GuiDetectDevice.h"
 #include "guis/GuiMsgBox.h"
+#include "resources/SVGCache.h"
+#include "scrapers/ScraperCache.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/ProfilingUtil.h"
+#include "utils/StringUtil.h"
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
 #include "EmulationStation.h"
+#include "GamelistWriter.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
+#include "MediaIndex.h"
 #include "platform.h"
+#include "PlayStatsJournal.h"
 #include "PowerSaver.h"
 #include "ScraperCmdLine.h"
+#include "Scripting.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include "SystemScreenSaver.h"
+#include "ThemeCache.h"
+#include "VideoMetaDataCache.h"
 #include <SDL_events.h>
 #include <SDL_main.h>
 #include <SDL_timer.h>
@@ -28,7 +37,10 @@
 
 #include <FreeImage.h>
 
+#define IDLE_FRAME_TIME 16 // ms to wait for input between updates while nothing needs to be drawn
+
 bool scrape_cmdline = false;
+ScraperCmdLineOptions scrape_options;
 
 bool parseArgs(int argc, char* argv[])
 {
@@ -153,6 +165,43 @@ bool parseArgs(int argc, char* argv[])
 		}else if(strcmp(argv[i], "--scrape") == 0)
 		{
 			scrape_cmdline = true;
+		}else if(strcmp(argv[i], "--scrape-filter") == 0)
+		{
+			if(i >= argc - 1 || (strcmp(argv[i + 1], "missing") != 0 && strcmp(argv[i + 1], "all") != 0))
+			{
+				std::cerr << "Invalid scrape filter supplied.";
+				return false;
+			}
+
+			scrape_options.filter = (strcmp(argv[i + 1], "all") == 0) ? FILTER_ALL : FILTER_MISSING_IMAGES;
+			scrape_cmdline = true;
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-systems") == 0)
+		{
+			if(i >= argc - 1)
+			{
+				std::cerr << "Invalid scrape systems supplied.";
+				return false;
+			}
+
+			scrape_options.systems = Utils::String::delimitedStringToVector(argv[i + 1], ",");
+			scrape_cmdline = true;
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-jobs") == 0)
+		{
+			if(i >= argc - 1 || atoi(argv[i + 1]) <= 0)
+			{
+				std::cerr << "Invalid number of scrape jobs supplied.";
+				return false;
+			}
+
+			scrape_options.jobs = atoi(argv[i + 1]);
+			scrape_cmdline = true;
+			i++; // skip the argument value
+		}else if(strcmp(argv[i], "--scrape-resume") == 0)
+		{
+			scrape_options.resume = true;
+			scrape_cmdline = true;
 		}else if(strcmp(argv[i], "--max-vram") == 0)
 		{
 			int maxVRAM = atoi(argv[i + 1]);
@@ -226,7 +275,12 @@ bool parseArgs(int argc, char* argv[])
 				"                               .emulationstation/es_settings.cfg, aso.\n"
 				"                               Subfolder .emulationstation/ will be created.\n"
 				"\nScrape mode:\n"
-				"--scrape                       scrape using command line interface\n\n"
+				"--scrape                       scrape using command line interface\n"
+				"--scrape-filter missing|all    scrape games missing images or all games,\n"
+				"                               asks nothing when any --scrape-* is given\n"
+				"--scrape-systems NAME[,NAME]   systems to scrape, or all (default)\n"
+				"--scrape-jobs N                number of parallel searches\n"
+				"--scrape-resume                skip games done by an interrupted scrape\n\n"
 				"Note: Switches marked (p) will be persisted in es_settings.cfg when any\n"
 				"setting is changed via EmulationStation UI.\n\n"
 				"Please refer to the online documentation for additional information:\n"
@@ -352,6 +406,13 @@ int main(int argc, char* argv[])
 	ViewController::init(&window);
 	CollectionSystemManager::init(&window);
 	MameNames::init();
+	VideoMetaDataCache::init();
+	SVGCache::init();
+	ThemeCache::init();
+	GamelistWriter::init();
+	PlayStatsJournal::init();
+	ScraperCache::init();
+	MediaIndex::init();
 	window.pushGui(ViewController::get());
 
 	bool splashScreen = Settings::getInstance()->getBool("SplashScreen");
@@ -372,7 +433,7 @@ int main(int argc, char* argv[])
 	}
 
 	const char* errorMsg = NULL;
-	if(!loadSystemConfigFile(splashScreen ? &window : nullptr, &errorMsg))
+	if(!loadSystemConfigFile((splashScreen && !scrape_cmdline) ? &window : nullptr, &errorMsg))
 	{
 		// something went terribly wrong
 		if(errorMsg == NULL)
@@ -383,6 +444,13 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 
+		// there is no window to show it in
+		if(scrape_cmdline)
+		{
+			std::cerr << errorMsg << "\n";
+			return 1;
+		}
+
 		// we can't handle es_systems.cfg file problems inside ES itself, so display the error message then quit
 		window.pushGui(new GuiMsgBox(&window,
 			errorMsg,
@@ -396,11 +464,16 @@ int main(int argc, char* argv[])
 	//run the command line scraper then quit
 	if(scrape_cmdline)
 	{
-		return run_scraper_cmdline();
+		const int result = run_scraper_cmdline(scrape_options);
+
+		// the scraper waited for its gamelists to be written, this only stops the writer thread
+		ScraperCache::deinit();
+		GamelistWriter::deinit();
+		MediaIndex::deinit();
+		return result;
 	}
 
-	// preload what we can right away instead of waiting for the user to select it
-	// this makes for no delays when accessing content, but a longer startup time
+	// gamelist views are built when their system is approached, not all of them up front
 	ViewController::get()->preload();
 
 	if(splashScreen)
@@ -419,17 +492,33 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	LOG(LogInfo) << "Startup took " << SDL_GetTicks() << " ms";
+
 	int lastTime = SDL_GetTicks();
 	int ps_time = SDL_GetTicks();
 
+	// 0 renders as fast as the swap interval allows
+	const int maxFrameRate = Settings::getInstance()->getInt("MaxFPS");
+	const int frameTime = maxFrameRate > 0 ? 1000 / maxFrameRate : IDLE_FRAME_TIME;
+
 	bool running = true;
+	bool idle = false;
 
 	while(running)
 	{
 		SDL_Event event;
 		bool ps_standby = PowerSaver::getState() && (int) SDL_GetTicks() - ps_time > PowerSaver::getMode();
+		bool gotEvent;
+
+		if(ps_standby)
+			gotEvent = SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) != 0;
+		else if(idle)
+			// nothing was drawn last time, sleep until the next input but keep the update timers ticking
+			gotEvent = SDL_WaitEventTimeout(&event, frameTime) != 0;
+		else
+			gotEvent = SDL_PollEvent(&event) != 0;
 
-		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
+		if(gotEvent)
 		{
 			do
 			{
@@ -469,22 +558,53 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
-		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+		{
+			ProfileZone("frame");
+
+			window.update(deltaTime);
+
+			// skip drawing and swapping when the previous frame is still up to date
+			idle = !window.isRenderRequired();
+			if(!idle)
+			{
+				window.render();
+
+				ProfileZone("swap");
+				Renderer::swapBuffers();
+			}
+		}
 
-		Log::flush();
+		// give the rest of the frame back when a frame rate cap is set
+		if(!idle && maxFrameRate > 0)
+		{
+			int renderTime = (int)SDL_GetTicks() - curTime;
+			if(renderTime >= 0 && renderTime < frameTime)
+				SDL_Delay(frameTime - renderTime);
+		}
 	}
 
 	while(window.peekGui() != ViewController::get())
 		delete window.peekGui();
 
+	// the media index goes away below
+	ViewController::get()->stopPrefetching();
+
 	InputManager::getInstance()->deinit();
 	window.deinit();
+	Scripting::deinit();
 
+	VideoMetaDataCache::deinit();
+	SVGCache::deinit();
+	ThemeCache::deinit();
 	MameNames::deinit();
+	// compacts the journal, the systems and the gamelist writer are still needed for that
+	PlayStatsJournal::deinit();
+	ScraperCache::deinit();
 	CollectionSystemManager::deinit();
 	SystemData::deleteSystems();
+	// after the systems, they queue their changes when saving on exit
+	GamelistWriter::deinit();
+	MediaIndex::deinit();
 
 	// call this ONLY when linking with FreeImage as a static library
 #ifdef FREEIMAGE_LIB
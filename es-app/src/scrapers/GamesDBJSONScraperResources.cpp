@@ -6,6 +6,7 @@
 #include "Log.h"
 
 #include "scrapers/GamesDBJSONScraperResources.h"
+#include "scrapers/Scraper.h"
 #include "utils/FileSystemUtil.h"
 
 
@@ -153,7 +154,7 @@ bool TheGamesDBJSONRequestResources::saveResource(HttpReq* req, std::unordered_m
 
 std::unique_ptr<HttpReq> TheGamesDBJSONRequestResources::fetchResource(const std::string& endpoint)
 {
-	std::string path = "https://api.thegamesdb.net/v1";
+	std::string path = getScraperUrl("https://api.thegamesdb.net/v1");
 	path += endpoint;
 	path += "?apikey=" + getApiKey();
 
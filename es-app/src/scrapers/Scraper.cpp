@@ -1,9 +1,11 @@
 #include "scrapers/Scraper.h"
 
+#include "scrapers/ScraperCache.h"
 #include "FileData.h"
 #include "GamesDBJSONScraper.h"
 #include "ScreenScraper.h"
 #include "Log.h"
+#include "MediaIndex.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include <FreeImage.h>
@@ -106,19 +108,57 @@ ScraperRequest::ScraperRequest(std::vector<ScraperSearchResult>& resultsWrite) :
 
 // ScraperHttpRequest
 ScraperHttpRequest::ScraperHttpRequest(std::vector<ScraperSearchResult>& resultsWrite, const std::string& url)
-	: ScraperRequest(resultsWrite)
+	: ScraperRequest(resultsWrite), mUrl(url)
 {
 	setStatus(ASYNC_IN_PROGRESS);
-	mReq = std::unique_ptr<HttpReq>(new HttpReq(url));
+
+	// a fresh cached response needs no request at all, a stale one is revalidated if the server gave us an ETag
+	std::string etag;
+	if(ScraperCache::getInstance()->getResponse(url, mCachedContent, etag))
+		return;
+
+	std::vector<std::string> headers;
+	if(!etag.empty())
+		headers.push_back("If-None-Match: " + etag);
+
+	mReq = std::unique_ptr<HttpReq>(new HttpReq(url, headers));
 }
 
 void ScraperHttpRequest::update()
 {
+	if(mStatus != ASYNC_IN_PROGRESS)
+		return;
+
+	if(!mReq)
+	{
+		setStatus(ASYNC_DONE); // if process() has an error, status will be changed to ASYNC_ERROR
+		process(mCachedContent, mResults);
+		mCachedContent.clear();
+		return;
+	}
+
 	HttpReq::Status status = mReq->status();
 	if(status == HttpReq::REQ_SUCCESS)
 	{
+		const long code = mReq->getResponseCode();
+		std::string content;
+
+		if(code == 304 && !ScraperCache::getInstance()->revalidateResponse(mUrl, content))
+		{
+			// the cached response went missing meanwhile, the empty 304 body is nothing to process
+			mReq = std::unique_ptr<HttpReq>(new HttpReq(mUrl));
+			return;
+		}
+
+		if(code != 304)
+			content = mReq->getContent();
+
 		setStatus(ASYNC_DONE); // if process() has an error, status will be changed to ASYNC_ERROR
-		process(mReq, mResults);
+		process(content, mResults);
+
+		// only what could be processed is worth keeping
+		if(code == 200 && mStatus == ASYNC_DONE)
+			ScraperCache::getInstance()->putResponse(mUrl, content, mReq->getHeader("etag"));
 		return;
 	}
 
@@ -143,22 +183,7 @@ MDResolveHandle::MDResolveHandle(const ScraperSearchResult& result, const Scrape
 {
 	if(!result.imageUrl.empty())
 	{
-
-		std::string ext;
-
-		// If we have a file extension returned by the scraper, then use it.
-		// Otherwise, try to guess it by the name of the URL, which point to an image.
-		if (!result.imageType.empty())
-		{
-			ext = result.imageType;
-		}else{
-			size_t dot = result.imageUrl.find_last_of('.');
-
-			if (dot != std::string::npos)
-				ext = result.imageUrl.substr(dot, std::string::npos);
-		}
-
-		std::string imgPath = getSaveAsPath(search, "image", ext);
+		std::string imgPath = getImageSaveAsPath(result, search);
 
 		mFuncs.push_back(ResolvePair(downloadImageAsync(result.imageUrl, imgPath), [this, imgPath]
 		{
@@ -200,21 +225,74 @@ std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url,
 }
 
 ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight) :
-	mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight), mReq(new HttpReq(url))
+	mUrl(url), mSavePath(path), mMaxWidth(maxWidth), mMaxHeight(maxHeight)
 {
+	ScraperCache* cache = ScraperCache::getInstance();
+
+	// written by an earlier run from the same image, nothing left to do
+	if(cache->isMediaWritten(url, path))
+	{
+		setStatus(ASYNC_DONE);
+		return;
+	}
+
+	// a stale image is revalidated if the server gave us an ETag
+	std::string etag;
+	if(cache->getMedia(url, mCachedContent, etag))
+		return;
+
+	std::vector<std::string> headers;
+	if(!etag.empty())
+		headers.push_back("If-None-Match: " + etag);
+
+	mReq = std::unique_ptr<HttpReq>(new HttpReq(url, headers));
 }
 
 void ImageDownloadHandle::update()
 {
-	if(mReq->status() == HttpReq::REQ_IN_PROGRESS)
+	if(mStatus != ASYNC_IN_PROGRESS)
 		return;
 
-	if(mReq->status() != HttpReq::REQ_SUCCESS)
+	std::string content;
+
+	if(mReq)
 	{
-		std::stringstream ss;
-		ss << "Network error: " << mReq->getErrorMsg();
-		setError(ss.str());
-		return;
+		if(mReq->status() == HttpReq::REQ_IN_PROGRESS)
+			return;
+
+		if(mReq->status() != HttpReq::REQ_SUCCESS)
+		{
+			std::stringstream ss;
+			ss << "Network error: " << mReq->getErrorMsg();
+			setError(ss.str());
+			return;
+		}
+
+		const long code = mReq->getResponseCode();
+
+		if(code == 304 && !ScraperCache::getInstance()->revalidateMedia(mUrl, content))
+		{
+			// the cached image went missing meanwhile, the empty 304 body is nothing to write
+			mReq = std::unique_ptr<HttpReq>(new HttpReq(mUrl));
+			return;
+		}
+
+		if(code != 304 && code != 200)
+		{
+			// an error page is no image, neither to cache nor to write
+			std::stringstream ss;
+			ss << "HTTP error " << code;
+			setError(ss.str());
+			return;
+		}
+
+		if(code == 200)
+		{
+			content = mReq->getContent();
+			ScraperCache::getInstance()->putMedia(mUrl, content, mReq->getHeader("etag"));
+		}
+	}else{
+		content.swap(mCachedContent);
 	}
 
 	// download is done, save it to disk
@@ -225,7 +303,6 @@ void ImageDownloadHandle::update()
 		return;
 	}
 
-	const std::string& content = mReq->getContent();
 	stream.write(content.data(), content.length());
 	stream.close();
 	if(stream.bad())
@@ -241,6 +318,8 @@ void ImageDownloadHandle::update()
 		return;
 	}
 
+	ScraperCache::getInstance()->setMediaWritten(mUrl, mSavePath);
+	MediaIndex::getInstance()->add(mSavePath);
 	setStatus(ASYNC_DONE);
 }
 
@@ -321,3 +400,44 @@ std::string getSaveAsPath(const ScraperSearchParams& params, const std::string&
 	path += name + extension;
 	return path;
 }
+
+std::string getImageSaveAsPath(const ScraperSearchResult& result, const ScraperSearchParams& search)
+{
+	std::string ext;
+
+	// If we have a file extension returned by the scraper, then use it.
+	// Otherwise, try to guess it by the name of the URL, which point to an image.
+	if (!result.imageType.empty())
+	{
+		ext = result.imageType;
+	}else{
+		size_t dot = result.imageUrl.find_last_of('.');
+
+		if (dot != std::string::npos)
+			ext = result.imageUrl.substr(dot, std::string::npos);
+	}
+
+	return getSaveAsPath(search, "image", ext);
+}
+
+std::string getScraperUrl(const std::string& url)
+{
+	const std::string& host = Settings::getInstance()->getString("ScraperHostOverride");
+	if(host.empty())
+		return url;
+
+	// keep the path, only scheme and host are replaced
+	const size_t scheme = url.find("://");
+	const size_t path = (scheme != std::string::npos) ? url.find('/', scheme + 3) : std::string::npos;
+
+	return host + ((path != std::string::npos) ? url.substr(path) : "");
+}
+
+std::string getUrlHost(const std::string& url)
+{
+	const size_t scheme = url.find("://");
+	const size_t start = (scheme != std::string::npos) ? (scheme + 3) : 0;
+	const size_t end = url.find_first_of("/?#", start);
+
+	return url.substr(start, (end != std::string::npos) ? (end - start) : std::string::npos);
+}
@@ -85,10 +85,13 @@ public:
 	virtual void update() override;
 
 protected:
-	virtual void process(const std::unique_ptr<HttpReq>& req, std::vector<ScraperSearchResult>& results) = 0;
+	virtual void process(const std::string& content, std::vector<ScraperSearchResult>& results) = 0;
 
 private:
+	// not set if the response came from the cache
 	std::unique_ptr<HttpReq> mReq;
+	std::string mUrl;
+	std::string mCachedContent;
 };
 
 // a request to get a list of results
@@ -146,7 +149,10 @@ public:
 	void update() override;
 
 private:
+	// not set if the image came from the cache
 	std::unique_ptr<HttpReq> mReq;
+	std::string mUrl;
+	std::string mCachedContent;
 	std::string mSavePath;
 	int mMaxWidth;
 	int mMaxHeight;
@@ -156,6 +162,16 @@ private:
 //Will create the "downloaded_images" and "subdirectory" directories if they do not exist.
 std::string getSaveAsPath(const ScraperSearchParams& params, const std::string& suffix, const std::string& url);
 
+//getSaveAsPath() for the image of a result, the extension is taken from the image type or else from the URL.
+std::string getImageSaveAsPath(const ScraperSearchResult& result, const ScraperSearchParams& search);
+
+//Replaces scheme and host of a scraper API URL with Settings::getString("ScraperHostOverride") if that is set,
+//so the scrapers can be pointed at a local server serving canned responses.
+std::string getScraperUrl(const std::string& url);
+
+//Returns the host part of an URL, used to rate limit requests per host.
+std::string getUrlHost(const std::string& url);
+
 //Will resize according to Settings::getInt("ScraperResizeWidth") and Settings::getInt("ScraperResizeHeight").
 std::unique_ptr<ImageDownloadHandle> downloadImageAsync(const std::string& url, const std::string& saveAs);
 
@@ -0,0 +1,523 @@
+#include "scrapers/ScraperCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include "Settings.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// evicting stops once the cache is this much below its bound, so not every store evicts again
+#define EVICT_TARGET_PERCENT 90
+
+ScraperCache* ScraperCache::sInstance = nullptr;
+
+void ScraperCache::init()
+{
+	if(!sInstance)
+		sInstance = new ScraperCache();
+
+} // init
+
+void ScraperCache::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+ScraperCache* ScraperCache::getInstance()
+{
+	if(!sInstance)
+		sInstance = new ScraperCache();
+
+	return sInstance;
+
+} // getInstance
+
+ScraperCache::ScraperCache() : mSize(0), mHits(0), mRevalidated(0), mMisses(0)
+{
+	mMaxSize  = (size_t)std::max(0, Settings::getInstance()->getInt("ScraperCacheSize")) * 1024 * 1024;
+	mTTL      = (time_t)std::max(0, Settings::getInstance()->getInt("ScraperCacheTTL")) * 60 * 60;
+	mMediaTTL = (time_t)std::max(0, Settings::getInstance()->getInt("ScraperCacheMediaTTL")) * 60 * 60;
+
+	if(!isEnabled())
+		return;
+
+	Utils::FileSystem::createDirectory(getCachePath());
+	Utils::FileSystem::createDirectory(getCachePath() + "/responses");
+	Utils::FileSystem::createDirectory(getCachePath() + "/media");
+
+	load();
+
+} // ScraperCache
+
+ScraperCache::~ScraperCache()
+{
+	if(!isEnabled())
+		return;
+
+	save();
+
+	if(mHits || mRevalidated || mMisses)
+		LOG(LogInfo) << "Scraper cache: " << mHits << " hits, " << mRevalidated << " revalidated, " << mMisses << " misses, " << (mSize / 1024) << " KiB in " << mBlobs.size() << " files";
+
+} // ~ScraperCache
+
+std::string ScraperCache::getCachePath()
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/scrapers";
+
+} // getCachePath
+
+static std::string hashToString(const std::string& _data)
+{
+	// FNV-1a, stable across runs and platforms unlike std::hash
+	unsigned long long hash = 14695981039346656037ULL;
+	for(size_t i = 0; i < _data.size(); ++i)
+	{
+		hash ^= (unsigned char)_data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	char buffer[17];
+	snprintf(buffer, sizeof(buffer), "%016llx", hash);
+	return buffer;
+
+} // hashToString
+
+std::string ScraperCache::getKey(const std::string& _url)
+{
+	static const char* credentials[] = { "devid", "devpassword", "ssid", "sspassword", "apikey" };
+
+	const size_t query = _url.find('?');
+	if(query == std::string::npos)
+		return _url;
+
+	// the same request made with other credentials is the same request
+	std::string key = _url.substr(0, query);
+	char        separator = '?';
+	size_t      start = query + 1;
+
+	while(start <= _url.size())
+	{
+		size_t end = _url.find('&', start);
+		if(end == std::string::npos)
+			end = _url.size();
+
+		const std::string param = _url.substr(start, end - start);
+		const std::string name  = param.substr(0, param.find('='));
+
+		if(!param.empty() && (std::find_if(std::begin(credentials), std::end(credentials), [&name](const char* _name) { return name == _name; }) == std::end(credentials)))
+		{
+			key += separator + param;
+			separator = '&';
+		}
+
+		start = end + 1;
+	}
+
+	return key;
+
+} // getKey
+
+bool ScraperCache::getResponse(const std::string& _url, std::string& _content, std::string& _etag)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	return isEnabled() && getEntry(mResponses, _url, mTTL, _content, _etag);
+
+} // getResponse
+
+bool ScraperCache::revalidateResponse(const std::string& _url, std::string& _content)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	return isEnabled() && revalidateEntry(mResponses, _url, _content);
+
+} // revalidateResponse
+
+void ScraperCache::putResponse(const std::string& _url, const std::string& _content, const std::string& _etag)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!isEnabled())
+		return;
+
+	const std::string key  = getKey(_url);
+	const std::string blob = "responses/" + hashToString(key);
+
+	++mMisses;
+
+	if(!writeBlob(blob, _content))
+		return;
+
+	Entry& entry  = mResponses[key];
+	entry.blob    = blob;
+	entry.etag    = _etag;
+	entry.fetched = time(nullptr);
+
+	evict();
+
+} // putResponse
+
+bool ScraperCache::getMedia(const std::string& _url, std::string& _content, std::string& _etag)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	return isEnabled() && getEntry(mMedia, _url, mMediaTTL, _content, _etag);
+
+} // getMedia
+
+bool ScraperCache::revalidateMedia(const std::string& _url, std::string& _content)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	return isEnabled() && revalidateEntry(mMedia, _url, _content);
+
+} // revalidateMedia
+
+void ScraperCache::putMedia(const std::string& _url, const std::string& _content, const std::string& _etag)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!isEnabled())
+		return;
+
+	// media is stored by its content, the same image behind another URL is not stored again
+	const std::string blob = "media/" + hashToString(_content) + "-" + std::to_string((unsigned long long)_content.size());
+
+	++mMisses;
+
+	auto blobIt = mBlobs.find(blob);
+	if(blobIt != mBlobs.cend())
+		blobIt->second.used = time(nullptr);
+	else if(!writeBlob(blob, _content))
+		return;
+
+	Entry& entry  = mMedia[getKey(_url)];
+	entry.blob    = blob;
+	entry.etag    = _etag;
+	entry.fetched = time(nullptr);
+
+	evict();
+
+} // putMedia
+
+void ScraperCache::setMediaWritten(const std::string& _url, const std::string& _path)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto it = mMedia.find(getKey(_url));
+	if(it != mMedia.cend())
+		mWritten[_path] = it->second.blob;
+
+} // setMediaWritten
+
+bool ScraperCache::isMediaWritten(const std::string& _url, const std::string& _path)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!isEnabled())
+		return false;
+
+	auto it        = mMedia.find(getKey(_url));
+	auto writtenIt = mWritten.find(_path);
+	if((it == mMedia.cend()) || (writtenIt == mWritten.cend()) || (writtenIt->second != it->second.blob))
+		return false;
+
+	// the image may have changed at the same URL meanwhile, getMedia() hands out the ETag to ask with
+	const time_t now = time(nullptr);
+	if((now - it->second.fetched) >= mMediaTTL)
+		return false;
+
+	// Utils::FileSystem::exists caches its answers, the file may have been removed since
+	FILE* file = fopen(_path.c_str(), "rb");
+	if(!file)
+		return false;
+	fclose(file);
+
+	mBlobs[it->second.blob].used = now;
+	++mHits;
+	return true;
+
+} // isMediaWritten
+
+bool ScraperCache::getEntry(std::map<std::string, Entry>& _entries, const std::string& _url, time_t _ttl, std::string& _content, std::string& _etag)
+{
+	auto it = _entries.find(getKey(_url));
+	if(it == _entries.end())
+		return false;
+
+	const time_t now = time(nullptr);
+	if((now - it->second.fetched) >= _ttl)
+	{
+		// stale, worth revalidating only while there is something left to confirm
+		if(hasBlob(it->second.blob))
+			_etag = it->second.etag;
+		else
+			_entries.erase(it);
+		return false;
+	}
+
+	if(!readBlob(it->second.blob, _content))
+	{
+		_entries.erase(it);
+		return false;
+	}
+
+	mBlobs[it->second.blob].used = now;
+	++mHits;
+	return true;
+
+} // getEntry
+
+bool ScraperCache::revalidateEntry(std::map<std::string, Entry>& _entries, const std::string& _url, std::string& _content)
+{
+	auto it = _entries.find(getKey(_url));
+	if(it == _entries.end())
+		return false;
+
+	if(!readBlob(it->second.blob, _content))
+	{
+		_entries.erase(it);
+		return false;
+	}
+
+	const time_t now = time(nullptr);
+	it->second.fetched = now;
+	mBlobs[it->second.blob].used = now;
+	++mRevalidated;
+	return true;
+
+} // revalidateEntry
+
+bool ScraperCache::hasBlob(const std::string& _blob)
+{
+	if(mBlobs.find(_blob) == mBlobs.cend())
+		return false;
+
+	std::ifstream stream(getCachePath() + "/" + _blob, std::ios_base::in | std::ios_base::binary);
+	if(!stream.is_open())
+	{
+		// removed behind our back, forget about it
+		mSize -= mBlobs[_blob].size;
+		mBlobs.erase(_blob);
+		return false;
+	}
+
+	return true;
+
+} // hasBlob
+
+bool ScraperCache::readBlob(const std::string& _blob, std::string& _content)
+{
+	if(mBlobs.find(_blob) == mBlobs.cend())
+		return false;
+
+	std::ifstream stream(getCachePath() + "/" + _blob, std::ios_base::in | std::ios_base::binary);
+	if(!stream.is_open())
+	{
+		// removed behind our back, forget about it
+		mSize -= mBlobs[_blob].size;
+		mBlobs.erase(_blob);
+		return false;
+	}
+
+	_content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return !stream.bad();
+
+} // readBlob
+
+bool ScraperCache::writeBlob(const std::string& _blob, const std::string& _content)
+{
+	const std::string path = getCachePath() + "/" + _blob;
+
+	std::ofstream stream(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	stream.write(_content.data(), _content.size());
+	stream.close();
+
+	auto it = mBlobs.find(_blob);
+	if(it != mBlobs.cend())
+	{
+		mSize -= it->second.size;
+		mBlobs.erase(it);
+	}
+
+	if(stream.fail())
+	{
+		LOG(LogWarning) << "Could not write scraper cache file \"" << path << "\"";
+		remove(path.c_str());
+		return false;
+	}
+
+	Blob& blob = mBlobs[_blob];
+	blob.size  = _content.size();
+	blob.used  = time(nullptr);
+	mSize     += blob.size;
+	return true;
+
+} // writeBlob
+
+void ScraperCache::evict()
+{
+	if(mSize <= mMaxSize)
+		return;
+
+	std::vector<std::pair<time_t, std::string>> blobs;
+	blobs.reserve(mBlobs.size());
+	for(auto it = mBlobs.cbegin(); it != mBlobs.cend(); ++it)
+		blobs.push_back(std::make_pair(it->second.used, it->first));
+	std::sort(blobs.begin(), blobs.end());
+
+	const size_t target  = mMaxSize / 100 * EVICT_TARGET_PERCENT;
+	size_t       evicted = 0;
+
+	for(auto it = blobs.cbegin(); (it != blobs.cend()) && (mSize > target); ++it)
+	{
+		remove((getCachePath() + "/" + it->second).c_str());
+		mSize -= mBlobs[it->second].size;
+		mBlobs.erase(it->second);
+		++evicted;
+	}
+
+	// drop everything referring to a removed file
+	for(auto it = mResponses.begin(); it != mResponses.end(); )
+		it = (mBlobs.find(it->second.blob) == mBlobs.cend()) ? mResponses.erase(it) : ++it;
+	for(auto it = mMedia.begin(); it != mMedia.end(); )
+		it = (mBlobs.find(it->second.blob) == mBlobs.cend()) ? mMedia.erase(it) : ++it;
+	for(auto it = mWritten.begin(); it != mWritten.end(); )
+		it = (mBlobs.find(it->second) == mBlobs.cend()) ? mWritten.erase(it) : ++it;
+
+	LOG(LogDebug) << "Evicted " << evicted << " files from the scraper cache, " << (mSize / 1024) << " KiB left";
+
+} // evict
+
+void ScraperCache::load()
+{
+	// one record per line, the free form key or path always comes last
+	//   B <tab> blob <tab> size <tab> last used
+	//   R <tab> blob <tab> fetched <tab> etag <tab> key     (response)
+	//   M <tab> blob <tab> fetched <tab> etag <tab> key     (media)
+	//   W <tab> blob <tab> path                             (file written from media)
+	std::ifstream stream(getCachePath() + "/index");
+	std::string   line;
+
+	while(std::getline(stream, line))
+	{
+		std::vector<std::string> fields;
+		size_t start = 0;
+		const size_t count = (line.compare(0, 1, "W") == 0) ? 3 : (line.compare(0, 1, "B") == 0) ? 4 : 5;
+
+		while(fields.size() < count - 1)
+		{
+			const size_t end = line.find('\t', start);
+			if(end == std::string::npos)
+				break;
+
+			fields.push_back(line.substr(start, end - start));
+			start = end + 1;
+		}
+		fields.push_back(line.substr(start));
+
+		if(fields.size() != count)
+			continue;
+
+		if(fields[0] == "B")
+		{
+			Blob& blob = mBlobs[fields[1]];
+			blob.size  = (size_t)strtoull(fields[2].c_str(), nullptr, 10);
+			blob.used  = (time_t)strtoll(fields[3].c_str(), nullptr, 10);
+			mSize     += blob.size;
+		}
+		else if((fields[0] == "R") || (fields[0] == "M"))
+		{
+			Entry& entry  = (fields[0] == "R") ? mResponses[fields[4]] : mMedia[fields[4]];
+			entry.blob    = fields[1];
+			entry.fetched = (time_t)strtoll(fields[2].c_str(), nullptr, 10);
+			entry.etag    = fields[3];
+		}
+		else if(fields[0] == "W")
+		{
+			mWritten[fields[2]] = fields[1];
+		}
+	}
+
+	// the marker is removed again by save(), finding it means the last run ended before writing its index
+	// and may have left files behind the index does not know of
+	const std::string marker = getCachePath() + "/index.open";
+	std::ifstream     markerStream(marker);
+	const bool        unclean = markerStream.is_open();
+	markerStream.close();
+
+	if(unclean)
+		removeUnknown();
+	else
+		std::ofstream(marker).close();
+
+	// a smaller bound may have been configured since
+	evict();
+
+	LOG(LogInfo) << "Scraper cache holds " << mBlobs.size() << " files, " << (mSize / 1024) << " KiB";
+
+} // load
+
+void ScraperCache::removeUnknown()
+{
+	const char* directories[] = { "responses", "media" };
+	unsigned int removed = 0;
+
+	for(const char* directory : directories)
+	{
+		const Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(getCachePath() + "/" + directory);
+		for(auto it = files.cbegin(); it != files.cend(); ++it)
+		{
+			if((mBlobs.find(std::string(directory) + "/" + Utils::FileSystem::getFileName(*it)) == mBlobs.cend()) && (remove(it->c_str()) == 0))
+				++removed;
+		}
+	}
+
+	LOG(LogInfo) << "Scraper cache was not closed cleanly, removed " << removed << " files its index does not know of";
+
+} // removeUnknown
+
+void ScraperCache::save()
+{
+	const std::string path     = getCachePath() + "/index";
+	const std::string tempPath = path + ".tmp";
+
+	std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::trunc);
+
+	for(auto it = mBlobs.cbegin(); it != mBlobs.cend(); ++it)
+		stream << "B\t" << it->first << '\t' << it->second.size << '\t' << (long long)it->second.used << '\n';
+	for(auto it = mResponses.cbegin(); it != mResponses.cend(); ++it)
+		stream << "R\t" << it->second.blob << '\t' << (long long)it->second.fetched << '\t' << it->second.etag << '\t' << it->first << '\n';
+	for(auto it = mMedia.cbegin(); it != mMedia.cend(); ++it)
+		stream << "M\t" << it->second.blob << '\t' << (long long)it->second.fetched << '\t' << it->second.etag << '\t' << it->first << '\n';
+	for(auto it = mWritten.cbegin(); it != mWritten.cend(); ++it)
+		stream << "W\t" << it->second << '\t' << it->first << '\n';
+
+	stream.close();
+
+#if defined(_WIN32)
+	// rename does not replace an existing file on Windows
+	if(!stream.fail())
+		remove(path.c_str());
+#endif // _WIN32
+
+	if(stream.fail() || (rename(tempPath.c_str(), path.c_str()) != 0))
+	{
+		LOG(LogError) << "Could not write scraper cache index \"" << path << "\"";
+		remove(tempPath.c_str());
+		return;
+	}
+
+	remove((getCachePath() + "/index.open").c_str());
+
+} // save
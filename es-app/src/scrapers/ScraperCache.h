@@ -0,0 +1,97 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_SCRAPER_CACHE_H
+#define ES_APP_SCRAPERS_SCRAPER_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <time.h>
+
+//
+// Keeps scraper responses and downloaded media in ~/.emulationstation/scrapers.
+//
+// Responses are keyed by their URL without credentials. Within ScraperCacheTTL hours a response is served
+// without asking the server again, after that it is revalidated with its ETag if the server sent one.
+// Media is stored once per content, every URL serving the same image refers to the same file. It is revalidated
+// the same way once it is older than ScraperCacheMediaTTL hours. The cache is bounded to ScraperCacheSize
+// megabytes, the least recently used files are evicted first; 0 disables the cache.
+//
+// The index is written on deinit() and trusted on the next start, a file that went missing is forgotten once
+// it is asked for. Only after a run that ended without writing the index are the cache directories listed to
+// remove the files it does not know of. All functions may be called from any thread.
+//
+class ScraperCache
+{
+public:
+
+	static void          init       ();
+	static void          deinit     ();
+	static ScraperCache* getInstance();
+
+	// Returns true and the content if _url was fetched within the TTL, else the ETag to revalidate a stale response with
+	bool getResponse       (const std::string& _url, std::string& _content, std::string& _etag);
+	// Returns true and the cached content after the server answered a revalidation with "not modified"
+	bool revalidateResponse(const std::string& _url, std::string& _content);
+	void putResponse       (const std::string& _url, const std::string& _content, const std::string& _etag);
+	// Returns true and the content if the media at _url was downloaded within the TTL, else the ETag to revalidate it with
+	bool getMedia          (const std::string& _url, std::string& _content, std::string& _etag);
+	// Returns true and the cached content after the server answered a revalidation with "not modified"
+	bool revalidateMedia   (const std::string& _url, std::string& _content);
+	void putMedia          (const std::string& _url, const std::string& _content, const std::string& _etag);
+	// Records that _path was written from the media at _url
+	void setMediaWritten   (const std::string& _url, const std::string& _path);
+	// Returns true if _path still holds what was written from the media at _url and that is within the TTL
+	bool isMediaWritten    (const std::string& _url, const std::string& _path);
+
+	static std::string getKey(const std::string& _url);
+
+private:
+
+	struct Blob
+	{
+		size_t size;
+		time_t used;
+	};
+
+	struct Entry
+	{
+		std::string blob;
+		std::string etag;
+		time_t      fetched;
+	};
+
+	 ScraperCache();
+	~ScraperCache();
+
+	static std::string getCachePath();
+
+	bool isEnabled  () const { return mMaxSize > 0; }
+	void load       ();
+	void save       ();
+	void removeUnknown();
+	// an entry whose blob is gone is forgotten, its ETag would have the server confirm content we do not have
+	bool getEntry   (std::map<std::string, Entry>& _entries, const std::string& _url, time_t _ttl, std::string& _content, std::string& _etag);
+	bool revalidateEntry(std::map<std::string, Entry>& _entries, const std::string& _url, std::string& _content);
+	bool hasBlob    (const std::string& _blob);
+	bool readBlob   (const std::string& _blob, std::string& _content);
+	bool writeBlob  (const std::string& _blob, const std::string& _content);
+	void evict      ();
+
+	static ScraperCache* sInstance;
+
+	std::mutex                          mMutex;
+	std::map<std::string, Blob>         mBlobs;     // by file name relative to the cache path
+	std::map<std::string, Entry>        mResponses; // by key
+	std::map<std::string, Entry>        mMedia;     // by key
+	std::map<std::string, std::string>  mWritten;   // blob by written file path
+	size_t                              mSize;
+	size_t                              mMaxSize;
+	time_t                              mTTL;
+	time_t                              mMediaTTL;
+	unsigned int                        mHits;
+	unsigned int                        mRevalidated;
+	unsigned int                        mMisses;
+
+}; // ScraperCache
+
+#endif // ES_APP_SCRAPERS_SCRAPER_CACHE_H
@@ -0,0 +1,340 @@
+#include "scrapers/ScraperPipeline.h"
+
+#include "scrapers/ScraperCache.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "Log.h"
+#include "MediaIndex.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <algorithm>
+#include <fstream>
+
+ScraperPipeline::ScraperPipeline(const std::queue<ScraperSearchParams>& _searches) : mSuccessful(0), mSkipped(0), mSearching(0), mDownloading(0), mProcessing(0), mExit(false)
+{
+	std::queue<ScraperSearchParams> searches = _searches;
+	while(!searches.empty())
+	{
+		mPending.push_back(searches.front());
+		searches.pop();
+	}
+
+	mLastCompleted.system = nullptr;
+	mLastCompleted.game   = nullptr;
+
+	mTotal        = (unsigned int)mPending.size();
+	mMaxSearches  = std::max(1, Settings::getInstance()->getInt("ScraperParallelSearches"));
+	mMaxDownloads = std::max(1, Settings::getInstance()->getInt("ScraperParallelDownloads"));
+	mHostInterval = std::max(0, Settings::getInstance()->getInt("ScraperHostInterval"));
+	mResizeWidth  = Settings::getInstance()->getInt("ScraperResizeWidth");
+	mResizeHeight = Settings::getInstance()->getInt("ScraperResizeHeight");
+
+	// writing and resizing is mostly CPU bound, there is no point in more workers than cores or downloads
+	const int cores   = std::max(1, (int)std::thread::hardware_concurrency());
+	const int workers = std::min(mMaxDownloads, cores);
+	for(int i = 0; i < workers; ++i)
+		mWorkers.push_back(new std::thread(&ScraperPipeline::workerProc, this));
+
+} // ScraperPipeline
+
+ScraperPipeline::~ScraperPipeline()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mExit = true;
+	}
+	mEvent.notify_all();
+
+	for(auto it = mWorkers.cbegin(); it != mWorkers.cend(); ++it)
+	{
+		(*it)->join();
+		delete *it;
+	}
+
+} // ~ScraperPipeline
+
+bool ScraperPipeline::tryRequest(const std::string& _host)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	auto it = mLastRequest.find(_host);
+	if((it != mLastRequest.cend()) && ((now - it->second) < std::chrono::milliseconds(mHostInterval)))
+		return false;
+
+	mLastRequest[_host] = now;
+	return true;
+
+} // tryRequest
+
+void ScraperPipeline::update()
+{
+	// start as many searches as allowed, the scraper decides on the URL so searches are limited per scraper
+	const std::string searchHost = "search:" + Settings::getInstance()->getString("Scraper");
+	while(!mPending.empty() && ((int)mSearching < mMaxSearches) && tryRequest(searchHost))
+	{
+		Job* job        = new Job();
+		job->params     = mPending.front();
+		job->search     = startScraperSearch(job->params);
+		job->downloaded = false;
+		job->state      = JOB_SEARCHING;
+		mPending.pop_front();
+		mJobs.push_back(std::unique_ptr<Job>(job));
+		++mSearching;
+	}
+
+	for(auto it = mJobs.begin(); it != mJobs.end(); )
+	{
+		Job* job = it->get();
+		updateJob(job);
+
+		if((job->state == JOB_DONE) || (job->state == JOB_FAILED))
+		{
+			completeJob(job);
+			it = mJobs.erase(it);
+			continue;
+		}
+
+		++it;
+	}
+
+} // update
+
+void ScraperPipeline::updateJob(Job* _job)
+{
+	switch(_job->state)
+	{
+		case JOB_SEARCHING:
+		{
+			const AsyncHandleStatus status = _job->search->status();
+			if(status == ASYNC_IN_PROGRESS)
+				return;
+
+			--mSearching;
+
+			if(status == ASYNC_ERROR)
+			{
+				LOG(LogWarning) << "Scraping \"" << _job->params.game->getPath() << "\" failed: " << _job->search->getStatusString();
+				_job->state = JOB_FAILED;
+			}
+			else if(_job->search->getResults().empty())
+			{
+				LOG(LogInfo) << "Scraping \"" << _job->params.game->getPath() << "\" found no results";
+				_job->state = JOB_FAILED;
+			}
+			else
+			{
+				_job->result = _job->search->getResults().front();
+				_job->state  = _job->result.imageUrl.empty() ? JOB_DONE : JOB_QUEUED_DOWNLOAD;
+			}
+
+			_job->search.reset();
+		}
+		break;
+
+		case JOB_QUEUED_DOWNLOAD:
+		{
+			if(_job->imagePath.empty())
+			{
+				// the path is resolved here, Utils::FileSystem caches existence and may not be used by the workers
+				_job->imagePath = getImageSaveAsPath(_job->result, _job->params);
+
+				// cached images skip the download slots and rate limits
+				ScraperCache* cache = ScraperCache::getInstance();
+				if(cache->isMediaWritten(_job->result.imageUrl, _job->imagePath))
+				{
+					_job->state = JOB_DONE;
+					return;
+				}
+
+				if(cache->getMedia(_job->result.imageUrl, _job->content, _job->etag))
+				{
+					queueProcess(_job);
+					return;
+				}
+			}
+
+			if(((int)mDownloading >= mMaxDownloads) || !tryRequest(getUrlHost(_job->result.imageUrl)))
+				return;
+
+			std::vector<std::string> headers;
+			if(!_job->etag.empty())
+				headers.push_back("If-None-Match: " + _job->etag);
+
+			// counted before the request exists, its callback may run right away
+			++mDownloading;
+			_job->downloaded = true;
+			_job->state      = JOB_DOWNLOADING;
+			_job->download   = std::unique_ptr<HttpReq>(new HttpReq(_job->result.imageUrl, headers, [this, _job](HttpReq* req) { onDownloaded(_job, req); }));
+		}
+		break;
+
+		default:
+			break;
+	}
+
+} // updateJob
+
+void ScraperPipeline::completeJob(Job* _job)
+{
+	mLastCompleted = _job->params;
+
+	if(_job->state == JOB_FAILED)
+	{
+		++mSkipped;
+
+		if(mCompletedCallback)
+			mCompletedCallback(_job->params, false);
+		return;
+	}
+
+	if(!_job->imagePath.empty())
+	{
+		_job->result.mdl.set("image", _job->imagePath);
+		_job->result.imageUrl = "";
+	}
+
+	_job->params.game->metadata = _job->result.mdl;
+	mTouchedSystems.insert(_job->params.system);
+	++mSuccessful;
+
+	if(mCompletedCallback)
+		mCompletedCallback(_job->params, true);
+
+} // completeJob
+
+void ScraperPipeline::onDownloaded(Job* _job, HttpReq* _req)
+{
+	// usually on the HttpReq I/O thread, the job may be gone as soon as its state is final
+	const long code = (_req->status() == HttpReq::REQ_SUCCESS) ? _req->getResponseCode() : 0;
+
+	if(code == 304)
+	{
+		// "not modified" keeps the cached image, it only counts as fresh again
+		if(ScraperCache::getInstance()->revalidateMedia(_job->result.imageUrl, _job->content))
+		{
+			_job->downloaded = false;
+			queueProcess(_job);
+		}
+		else
+		{
+			// the cached image went missing meanwhile, asked again without the ETag by the next update()
+			_job->etag.clear();
+			_job->state = JOB_QUEUED_DOWNLOAD;
+		}
+	}
+	else if(code == 200)
+	{
+		_job->content = _req->getContent();
+		_job->etag    = _req->getHeader("etag");
+		queueProcess(_job);
+	}
+	else if(_req->status() == HttpReq::REQ_SUCCESS)
+	{
+		// an error page is no image, neither to cache nor to write
+		LOG(LogWarning) << "Downloading image for \"" << _job->params.game->getPath() << "\" failed: HTTP " << code;
+		_job->state = JOB_FAILED;
+	}
+	else
+	{
+		LOG(LogWarning) << "Downloading image for \"" << _job->params.game->getPath() << "\" failed: " << _req->getErrorMsg();
+		_job->state = JOB_FAILED;
+	}
+
+	--mDownloading;
+
+} // onDownloaded
+
+void ScraperPipeline::queueProcess(Job* _job)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	_job->state = JOB_PROCESSING;
+	mProcessQueue.push_back(_job);
+	++mProcessing;
+	mEvent.notify_one();
+
+} // queueProcess
+
+void ScraperPipeline::workerProc()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while(true)
+	{
+		mEvent.wait(lock, [this] { return mExit || !mProcessQueue.empty(); });
+
+		if(mProcessQueue.empty())
+			return;
+
+		Job* job = mProcessQueue.front();
+		mProcessQueue.pop_front();
+		lock.unlock();
+
+		if(job->downloaded)
+			ScraperCache::getInstance()->putMedia(job->result.imageUrl, job->content, job->etag);
+
+		bool saved = false;
+		{
+			std::ofstream stream(job->imagePath, std::ios_base::out | std::ios_base::binary);
+			stream.write(job->content.data(), job->content.length());
+			stream.close();
+			saved = !stream.fail();
+		}
+
+		if(!saved)
+			LOG(LogError) << "Failed to save image \"" << job->imagePath << "\". Permission error? Disk full?";
+		else if(!resizeImage(job->imagePath, mResizeWidth, mResizeHeight))
+			saved = false;
+		else
+		{
+			ScraperCache::getInstance()->setMediaWritten(job->result.imageUrl, job->imagePath);
+			MediaIndex::getInstance()->add(job->imagePath);
+		}
+
+		job->content.clear();
+		job->content.shrink_to_fit();
+
+		lock.lock();
+		job->state = saved ? JOB_DONE : JOB_FAILED;
+		--mProcessing;
+		mDone.notify_all();
+	}
+
+} // workerProc
+
+void ScraperPipeline::stop()
+{
+	mPending.clear();
+
+	// dropping a request waits for its callback, nothing is handed to the workers after this
+	for(auto it = mJobs.cbegin(); it != mJobs.cend(); ++it)
+		(*it)->download.reset();
+
+	// whatever is being written can not be taken back, wait for it and keep the result
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.wait(lock, [this] { return mProcessing == 0; });
+	}
+
+	for(auto it = mJobs.cbegin(); it != mJobs.cend(); ++it)
+	{
+		if(((*it)->state == JOB_DONE) || ((*it)->state == JOB_FAILED))
+			completeJob(it->get());
+	}
+
+	mJobs.clear();
+	mSearching   = 0;
+	mDownloading = 0;
+
+} // stop
+
+void ScraperPipeline::commit()
+{
+	for(auto it = mTouchedSystems.cbegin(); it != mTouchedSystems.cend(); ++it)
+		updateGamelist(*it);
+
+	LOG(LogInfo) << "Scraped " << mSuccessful << " of " << mTotal << " games (" << mSkipped << " skipped), updated " << mTouchedSystems.size() << " gamelists";
+
+	mTouchedSystems.clear();
+
+} // commit
@@ -0,0 +1,116 @@
+#pragma once
+#ifndef ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
+#define ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
+
+#include "scrapers/Scraper.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+//
+// Scrapes a queue of games without user interaction, always accepting the first result.
+//
+// Up to ScraperParallelSearches searches and ScraperParallelDownloads image downloads are in flight at once,
+// requests to the same host are spaced at least ScraperHostInterval milliseconds apart. Downloaded images are
+// written and resized by a small pool of worker threads. Scraped metadata is applied to the games as they finish,
+// the gamelists of all touched systems are written once by commit().
+//
+// Searches are driven by the thread calling update(). Finished image downloads are handed straight from the
+// HttpReq I/O thread to the workers, update() only collects the jobs that are done.
+//
+class ScraperPipeline
+{
+public:
+
+	typedef std::function<void(const ScraperSearchParams& _params, bool _scraped)> CompletedCallback;
+
+	 ScraperPipeline(const std::queue<ScraperSearchParams>& _searches);
+	~ScraperPipeline();
+
+	// Starts queued work and collects finished work, call once per frame
+	void update();
+	// Drops everything not started or still waiting on the network, waits for the image workers and applies their results
+	void stop  ();
+	// Writes the gamelists of every system a game was scraped for
+	void commit();
+
+	// Called on the thread calling update() for every game that is done, whether it was scraped or skipped
+	void setCompletedCallback(const CompletedCallback& _callback) { mCompletedCallback = _callback; }
+
+	bool                       isDone            () const { return mPending.empty() && mJobs.empty(); }
+	unsigned int               getTotalCount     () const { return mTotal; }
+	unsigned int               getCompletedCount () const { return mSuccessful + mSkipped; }
+	unsigned int               getSuccessfulCount() const { return mSuccessful; }
+	unsigned int               getSkippedCount   () const { return mSkipped; }
+	unsigned int               getInFlightCount  () const { return (unsigned int)mJobs.size(); }
+	// the game finished last, nullptr until the first one is done
+	const ScraperSearchParams* getLastCompleted  () const { return mLastCompleted.game ? &mLastCompleted : nullptr; }
+
+private:
+
+	enum JobState
+	{
+		JOB_SEARCHING,
+		JOB_QUEUED_DOWNLOAD,
+		JOB_DOWNLOADING,
+		JOB_PROCESSING,
+		JOB_DONE,
+		JOB_FAILED
+	};
+
+	struct Job
+	{
+		ScraperSearchParams                  params;
+		ScraperSearchResult                  result;
+		std::unique_ptr<ScraperSearchHandle> search;
+		std::unique_ptr<HttpReq>             download;
+		std::string                          content;
+		std::string                          imagePath;
+		std::string                          etag;       // of the stale cached image, then of the download
+		bool                                 downloaded; // else the image came from the cache
+		std::atomic<int>                     state;
+	};
+
+	bool tryRequest  (const std::string& _host);
+	void updateJob   (Job* _job);
+	void completeJob (Job* _job);
+	void onDownloaded(Job* _job, HttpReq* _req);
+	void queueProcess(Job* _job);
+	void workerProc  ();
+
+	std::deque<ScraperSearchParams>                              mPending;
+	std::list<std::unique_ptr<Job>>                              mJobs;
+	std::map<std::string, std::chrono::steady_clock::time_point> mLastRequest; // by host
+	std::set<SystemData*>                                        mTouchedSystems;
+	ScraperSearchParams                                          mLastCompleted;
+	CompletedCallback                                            mCompletedCallback;
+	unsigned int                                                 mTotal;
+	unsigned int                                                 mSuccessful;
+	unsigned int                                                 mSkipped;
+	unsigned int                                                 mSearching;
+	std::atomic<unsigned int>                                    mDownloading;
+	int                                                          mMaxSearches;
+	int                                                          mMaxDownloads;
+	int                                                          mHostInterval;
+	int                                                          mResizeWidth;
+	int                                                          mResizeHeight;
+
+	// shared with the image workers
+	std::vector<std::thread*>                                    mWorkers;
+	std::deque<Job*>                                             mProcessQueue;
+	std::mutex                                                   mMutex;
+	std::condition_variable                                      mEvent;
+	std::condition_variable                                      mDone;
+	unsigned int                                                 mProcessing;
+	bool                                                         mExit;
+
+}; // ScraperPipeline
+
+#endif // ES_APP_SCRAPERS_SCRAPER_PIPELINE_H
@@ -180,12 +180,10 @@ void screenscraper_generate_scraper_requests(const ScraperSearchParams& params,
 
 }
 
-void ScreenScraperRequest::process(const std::unique_ptr<HttpReq>& req, std::vector<ScraperSearchResult>& results)
+void ScreenScraperRequest::process(const std::string& content, std::vector<ScraperSearchResult>& results)
 {
-	assert(req->status() == HttpReq::REQ_SUCCESS);
-
 	pugi::xml_document doc;
-	pugi::xml_parse_result parseResult = doc.load_string(req->getContent().c_str());
+	pugi::xml_parse_result parseResult = doc.load_string(content.c_str());
 
 	if (!parseResult)
 	{
@@ -360,7 +358,7 @@ void ScreenScraperRequest::processList(const pugi::xml_document& xmldoc, std::ve
 
 std::string ScreenScraperRequest::ScreenScraperConfig::getGameSearchUrl(const std::string gameName) const
 {
-	return API_URL_BASE
+	return getScraperUrl(API_URL_BASE)
 		+ "/jeuInfos.php?devid=" + Utils::String::scramble(API_DEV_U, API_DEV_KEY)
 		+ "&devpassword=" + Utils::String::scramble(API_DEV_P, API_DEV_KEY)
 		+ "&softname=" + HttpReq::urlEncode(API_SOFT_NAME)
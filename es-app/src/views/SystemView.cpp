@@ -196,7 +196,7 @@ bool SystemView::input(InputConfig* config, Input input)
 			config->isMappedLike("up", input) ||
 			config->isMappedLike("down", input))
 			listInput(0);
-		Scripting::fireEvent("system-select", this->IList::getSelected()->getName(), "input");
+		Scripting::fireEventAsync("system-select", this->IList::getSelected()->getName(), "input");
 		if(!UIModeController::getInstance()->isUIModeKid() && config->isMappedTo("select", input) && Settings::getInstance()->getBool("ScreenSaverControls"))
 		{
 			mWindow->startScreenSaver();
@@ -219,6 +219,9 @@ void SystemView::onCursorChanged(const CursorState& /*state*/)
 	// update help style
 	updateHelpPrompts();
 
+	// get the gamelist ready while the carousel rests on the system
+	ViewController::get()->prefetchGameListView(getSelected());
+
 	float startPos = mCamOffset;
 
 	float posMax = (float)mEntries.size();
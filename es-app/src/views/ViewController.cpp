@@ -5,6 +5,7 @@
 #include "animations/LaunchAnimation.h"
 #include "animations/MoveCameraAnimation.h"
 #include "guis/GuiMenu.h"
+#include "resources/ResourceManager.h"
 #include "views/gamelist/DetailedGameListView.h"
 #include "views/gamelist/IGameListView.h"
 #include "views/gamelist/GridGameListView.h"
@@ -13,11 +14,18 @@
 #include "views/UIModeController.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "MediaIndex.h"
 #include "Scripting.h"
 #include "Settings.h"
 #include "SystemData.h"
+#include "ThemeCache.h"
 #include "Window.h"
 
+// gamelist views are prefetched once the screen was still this long, building one takes a few frames
+#define PREFETCH_IDLE_MS 300
+// the views in use and the ones next to them must fit, whatever the setting says
+#define MIN_CACHED_VIEWS 3
+
 ViewController* ViewController::sInstance = NULL;
 
 ViewController* ViewController::get()
@@ -33,17 +41,37 @@ void ViewController::init(Window* window)
 }
 
 ViewController::ViewController(Window* window)
-	: GuiComponent(window), mCurrentView(nullptr), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false)
+	: GuiComponent(window), mCurrentView(nullptr), mPrefetchIdle(0), mIndexThread(nullptr), mIndexExit(false), mCamera(Transform4x4f::Identity()), mFadeOpacity(0), mLockInput(false)
 {
 	mState.viewing = NOTHING;
+	mIndexThread = new std::thread(&ViewController::indexProc, this);
 }
 
 ViewController::~ViewController()
 {
+	stopPrefetching();
+
 	assert(sInstance == this);
 	sInstance = NULL;
 }
 
+void ViewController::stopPrefetching()
+{
+	mPrefetchQueue.clear();
+
+	if(!mIndexThread)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(mIndexMutex);
+		mIndexExit = true;
+	}
+	mIndexEvent.notify_one();
+	mIndexThread->join();
+	delete mIndexThread;
+	mIndexThread = nullptr;
+}
+
 void ViewController::goToStart()
 {
 	// If specific system is requested, go directly to the game list
@@ -54,15 +82,15 @@ void ViewController::goToStart()
 			if ((*it)->getName() == requestedSystem)
 			{
 				goToGameList(*it);
-				Scripting::fireEvent("system-select", requestedSystem, "requestedsystem");
+				Scripting::fireEventAsync("system-select", requestedSystem, "requestedsystem");
 				FileData* cursor = getGameListView(*it)->getCursor();
 				if (cursor != NULL)
 				{
-					Scripting::fireEvent("game-select", requestedSystem, cursor->getPath(), cursor->getName(), "requestedgame");
+					Scripting::fireEventAsync("game-select", requestedSystem, cursor->getPath(), cursor->getName(), "requestedgame");
 				}
 				else
 				{
-					Scripting::fireEvent("game-select", "NULL", "NULL", "NULL", "requestedgame");
+					Scripting::fireEventAsync("game-select", "NULL", "NULL", "NULL", "requestedgame");
 				}
 				return;
 			}
@@ -72,7 +100,7 @@ void ViewController::goToStart()
 		Settings::getInstance()->setString("StartupSystem", "");
 	}
 	goToSystemView(SystemData::sSystemVector.at(0));
-	Scripting::fireEvent("system-select", SystemData::sSystemVector.at(0)->getName(), "gotostart");
+	Scripting::fireEventAsync("system-select", SystemData::sSystemVector.at(0)->getName(), "gotostart");
 }
 
 void ViewController::ReloadAndGoToStart()
@@ -152,6 +180,10 @@ void ViewController::goToGameList(SystemData* system)
 		mCurrentView->onShow();
 	}
 	playViewTransition();
+
+	// left and right lead to the neighbours, have them ready
+	std::vector<SystemData*> neighbours = { system->getNext(), system->getPrev() };
+	prefetch(neighbours, neighbours);
 }
 
 void ViewController::playViewTransition()
@@ -208,7 +240,7 @@ void ViewController::playViewTransition()
 			{
 				// right rollover
 				mLockInput = true;
-				tgt.x() = screenWidth * mGameListViews.size();
+				tgt.x() = screenWidth * SystemData::sSystemVector.size();
 			}
 			else if (-mCamera.translation().x() - tgt.x() <= 2 * -screenWidth)
 			{
@@ -328,6 +360,10 @@ void ViewController::removeGameListView(SystemData* system)
 		exists->second.reset();
 		mGameListViews.erase(system);
 	}
+
+	mGameListViewsUsed.remove(system);
+	mSavedCursors.erase(system);
+	mPrefetchQueue.erase(std::remove(mPrefetchQueue.begin(), mPrefetchQueue.end(), system), mPrefetchQueue.end());
 }
 
 ViewController::GameListViewType ViewController::getGameListViewType()
@@ -353,7 +389,10 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	//if we already made one, return that one
 	auto exists = mGameListViews.find(system);
 	if(exists != mGameListViews.cend())
+	{
+		touchGameListView(system);
 		return exists->second;
+	}
 
 	system->getIndex()->setUIModeFilters();
 	//if we didn't, make it, remember it, and return it
@@ -409,9 +448,157 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	addChild(view.get());
 
 	mGameListViews[system] = view;
+	restoreCursor(system, view.get());
+	touchGameListView(system);
+	evictGameListViews(system);
 	return view;
 }
 
+std::shared_ptr<IGameListView> ViewController::findGameListView(SystemData* system)
+{
+	auto it = mGameListViews.find(system);
+	if(it == mGameListViews.cend())
+		return nullptr;
+
+	return it->second;
+}
+
+void ViewController::touchGameListView(SystemData* system)
+{
+	if(!mGameListViewsUsed.empty() && mGameListViewsUsed.front() == system)
+		return;
+
+	mGameListViewsUsed.remove(system);
+	mGameListViewsUsed.push_front(system);
+}
+
+void ViewController::evictGameListViews(SystemData* keep)
+{
+	const int setting = Settings::getInstance()->getInt("GameListViewCacheSize");
+	if(setting <= 0)
+		return;
+
+	const size_t max = (size_t)std::max(setting, MIN_CACHED_VIEWS);
+
+	// least recently used first, the view on screen and the one just built stay whatever their age
+	for(auto it = mGameListViewsUsed.end(); (mGameListViews.size() > max) && (it != mGameListViewsUsed.begin()); )
+	{
+		SystemData* system = *(--it);
+		auto view = mGameListViews.find(system);
+
+		if(view == mGameListViews.end())
+		{
+			it = mGameListViewsUsed.erase(it);
+			continue;
+		}
+
+		if((system == keep) || (view->second == mCurrentView) || ((mState.viewing != NOTHING) && (mState.system == system)))
+			continue;
+
+		// the cursor is restored when the view is built again
+		FileData* cursor = view->second->getCursor();
+		if(cursor && !cursor->isPlaceHolder())
+			mSavedCursors[system] = { cursor->getPath(), view->second->getViewportTop() };
+
+		LOG(LogDebug) << "ViewController: dropping gamelist view of " << system->getName();
+
+		// the view removes itself from the children when destroyed
+		mGameListViews.erase(view);
+		it = mGameListViewsUsed.erase(it);
+	}
+}
+
+void ViewController::restoreCursor(SystemData* system, IGameListView* view)
+{
+	auto saved = mSavedCursors.find(system);
+	if(saved == mSavedCursors.end())
+		return;
+
+	const SavedCursor cursor = saved->second;
+	mSavedCursors.erase(saved);
+
+	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
+	for(auto it = files.cbegin(); it != files.cend(); it++)
+	{
+		if((*it)->getPath() == cursor.path)
+		{
+			view->setCursor(*it);
+			view->setViewportTop(cursor.viewportTop);
+			break;
+		}
+	}
+}
+
+void ViewController::prefetchGameListView(SystemData* system)
+{
+	prefetch({ system }, { system, system->getNext(), system->getPrev() });
+}
+
+void ViewController::prefetch(const std::vector<SystemData*>& build, const std::vector<SystemData*>& index)
+{
+	// only the latest wish counts, the carousel may have moved on already
+	mPrefetchQueue.clear();
+	mPrefetchIdle = 0;
+
+	for(auto it = build.cbegin(); it != build.cend(); it++)
+	{
+		if(mGameListViews.find(*it) == mGameListViews.cend())
+			mPrefetchQueue.push_back(*it);
+	}
+
+	if(!mIndexThread)
+		return;
+
+	// the views must be built on this thread, looking up their media on disk is what can be done ahead
+	std::unique_lock<std::mutex> lock(mIndexMutex);
+	mIndexQueue.clear();
+
+	for(auto it = index.cbegin(); it != index.cend(); it++)
+	{
+		if(!(*it)->isCollection() && (mGameListViews.find(*it) == mGameListViews.cend()))
+			mIndexQueue.push_back((*it)->getSystemEnvData()->mStartPath + "/images");
+	}
+
+	if(!mIndexQueue.empty())
+		mIndexEvent.notify_one();
+}
+
+bool ViewController::prefetchMedia(const std::string& directory)
+{
+	if(!mIndexThread)
+		return false;
+
+	std::unique_lock<std::mutex> lock(mIndexMutex);
+
+	if(std::find(mIndexQueue.cbegin(), mIndexQueue.cend(), directory) == mIndexQueue.cend())
+	{
+		mIndexQueue.push_back(directory);
+		mIndexEvent.notify_one();
+	}
+
+	return true;
+}
+
+void ViewController::indexProc()
+{
+	while(true)
+	{
+		std::string directory;
+		{
+			std::unique_lock<std::mutex> lock(mIndexMutex);
+			mIndexEvent.wait(lock, [this] { return mIndexExit || !mIndexQueue.empty(); });
+
+			if(mIndexExit)
+				return;
+
+			directory = mIndexQueue.front();
+			mIndexQueue.pop_front();
+		}
+
+		MediaIndex::getInstance()->index(directory);
+	}
+}
+
 std::shared_ptr<SystemView> ViewController::getSystemListView()
 {
 	//if we already made one, return that one
@@ -457,6 +644,23 @@ void ViewController::update(int deltaTime)
 	}
 
 	updateSelf(deltaTime);
+
+	// one view per idle period, building it takes longer than a frame
+	if(!mPrefetchQueue.empty())
+	{
+		if(isAnimationPlaying(0) || (mState.viewing == NOTHING))
+			mPrefetchIdle = 0;
+		else
+			mPrefetchIdle += deltaTime;
+
+		if(mPrefetchIdle >= PREFETCH_IDLE_MS)
+		{
+			SystemData* system = mPrefetchQueue.front();
+			mPrefetchQueue.pop_front();
+			mPrefetchIdle = 0;
+			getGameListView(system);
+		}
+	}
 }
 
 void ViewController::render(const Transform4x4f& parentTrans)
@@ -501,24 +705,9 @@ void ViewController::render(const Transform4x4f& parentTrans)
 
 void ViewController::preload()
 {
-	int i = 1;
-	int max = SystemData::sSystemVector.size() + 1;
-
-	bool splash = Settings::getInstance()->getBool("SplashScreen");
-	if (splash)
-		mWindow->renderLoadingScreen("Preloading UI", (float)i / (float)max);
-
+	// the gamelist views are built on demand, see prefetchGameListView()
 	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{
-		if (splash)
-		{
-			i++;
-			mWindow->renderLoadingScreen("Preloading UI", (float)i / (float)max);
-		}
-
 		(*it)->getIndex()->resetFilters();
-		getGameListView(*it);
-	}
 }
 
 void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
@@ -557,6 +746,13 @@ void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 
 void ViewController::reloadAll(bool themeChanged)
 {
+	MediaIndex::getInstance()->refresh();
+	ResourceManager::getInstance()->invalidatePaths();
+
+	// files of the previous theme set are of no use anymore, unchanged ones are reused by reloading the same set
+	if(themeChanged)
+		ThemeCache::getInstance()->clear();
+
 	// clear all gamelistviews
 	std::map<SystemData*, FileData*> cursorMap;
 	std::map<SystemData*, int> viewportTopMap;
@@ -566,15 +762,21 @@ void ViewController::reloadAll(bool themeChanged)
 		viewportTopMap[it->first] = it->second->getViewportTop();
 	}
 	mGameListViews.clear();
+	mPrefetchQueue.clear();
 
-	// load themes, create gamelistviews and reset filters
-	for(auto it = cursorMap.cbegin(); it != cursorMap.cend(); it++)
+	// load themes and reset filters, also of the systems without a view which may get one later
+	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
 	{
-		it->first->loadTheme();
-		it->first->getIndex()->resetFilters();
-		getGameListView(it->first)->setCursor(it->second);
+		(*it)->loadTheme();
+		(*it)->getIndex()->resetFilters();
 	}
 
+	// create the gamelistviews that existed, in their order of use
+	const std::list<SystemData*> used = mGameListViewsUsed;
+	for(auto it = cursorMap.cbegin(); it != cursorMap.cend(); it++)
+		getGameListView(it->first)->setCursor(it->second);
+	mGameListViewsUsed = used;
+
 	if(!themeChanged || !Settings::getInstance()->getBool("UseFullscreenPaging"))
 	{
 		// restore index of first list item on display
@@ -5,6 +5,11 @@
 #include "renderers/Renderer.h"
 #include "FileData.h"
 #include "GuiComponent.h"
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 class IGameListView;
@@ -20,10 +25,18 @@ public:
 
 	virtual ~ViewController();
 
-	// Try to completely populate the GameListView map.
-	// Caches things so there's no pauses during transitions.
+	// Resets the filters of all systems. Gamelist views are not built here anymore but when their system is
+	// approached, only the GameListViewCacheSize most recently used ones are kept.
 	void preload();
 
+	// Builds the gamelist view of system the next time nothing else is going on and indexes the media of its
+	// neighbours in the background, so entering either of them does not pause.
+	void prefetchGameListView(SystemData* system);
+	// Has the background indexing list the media directory, returns false if there is no such thread anymore
+	bool prefetchMedia(const std::string& directory);
+	// Waits for the background indexing to finish, nothing is prefetched afterwards
+	void stopPrefetching();
+
 	// If a basic view detected a metadata change, it can request to recreate
 	// the current gamelist view (as it may change to be detailed).
 	void reloadGameListView(IGameListView* gamelist, bool reloadTheme = false);
@@ -84,6 +97,9 @@ public:
 	virtual HelpStyle getHelpStyle() override;
 
 	std::shared_ptr<IGameListView> getGameListView(SystemData* system);
+	// Returns the gamelist view of system if it is built, else nullptr. Unlike getGameListView() it neither
+	// builds the view nor counts as a use of it, views other systems rely on stay cached.
+	std::shared_ptr<IGameListView> findGameListView(SystemData* system);
 	std::shared_ptr<SystemView> getSystemListView();
 	void removeGameListView(SystemData* system);
 
@@ -91,13 +107,37 @@ private:
 	ViewController(Window* window);
 	static ViewController* sInstance;
 
+	struct SavedCursor
+	{
+		std::string path;
+		int viewportTop;
+	};
+
 	void playViewTransition();
 	int getSystemId(SystemData* system);
 
+	void touchGameListView(SystemData* system);
+	void evictGameListViews(SystemData* keep);
+	void restoreCursor(SystemData* system, IGameListView* view);
+	void prefetch(const std::vector<SystemData*>& build, const std::vector<SystemData*>& index);
+	void indexProc();
+
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
 	std::shared_ptr<SystemView> mSystemListView;
 
+	std::list<SystemData*> mGameListViewsUsed; // most recently used first
+	std::map<SystemData*, SavedCursor> mSavedCursors; // of evicted views
+	std::deque<SystemData*> mPrefetchQueue;
+	int mPrefetchIdle;
+
+	// media directories of upcoming systems are indexed by this thread
+	std::thread* mIndexThread;
+	std::deque<std::string> mIndexQueue;
+	std::mutex mIndexMutex;
+	std::condition_variable mIndexEvent;
+	bool mIndexExit;
+
 	Transform4x4f mCamera;
 	float mFadeOpacity;
 	bool mLockInput;
@@ -4,6 +4,7 @@
 #include "views/UIModeController.h"
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
+#include "MediaIndex.h"
 #include "Settings.h"
 #include "SystemData.h"
 
@@ -45,10 +46,12 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 	mHeaderText.setText(mRoot->getSystem()->getFullName());
 	if (files.size() > 0)
 	{
-		for(auto it = files.cbegin(); it != files.cend(); it++)
+		// names and text caches are only made for the rows around the cursor
+		mList.setObjects(files, [](TextListComponent<FileData*>::Entry& entry)
 		{
-			mList.add((*it)->getName(), *it, ((*it)->getType() == FOLDER));
-		}
+			entry.name = entry.object->getName();
+			entry.data.colorId = (entry.object->getType() == FOLDER);
+		});
 	}
 	else
 	{
@@ -170,15 +173,22 @@ void BasicGameListView::remove(FileData *game, bool deleteFile, bool refreshView
 			}
 		}
 
-		// delete the resources that are not shared
+		// delete the resources that are not shared, resolved up front as the MediaIndex forgets them once removed
+		std::vector<std::string> unshared;
 		if (!keepVideo)
-			Utils::FileSystem::removeFile(game->getVideoPath());
+			unshared.push_back(game->getVideoPath());
 		if (!keepImage)
-			Utils::FileSystem::removeFile(game->getImagePath());
+			unshared.push_back(game->getImagePath());
 		if (!keepThumbnail)
-			Utils::FileSystem::removeFile(game->getThumbnailPath());
+			unshared.push_back(game->getThumbnailPath());
 		if (!keepMarquee)
-			Utils::FileSystem::removeFile(game->getMarqueePath());
+			unshared.push_back(game->getMarqueePath());
+
+		for (auto path : unshared)
+		{
+			if (Utils::FileSystem::removeFile(path))
+				MediaIndex::getInstance()->remove(path);
+		}
 	}
 	FileData* parent = game->getParent();
 	if (getCursor() == game)                     // Select next element in list, or prev if none
@@ -176,10 +176,12 @@ void GridGameListView::populateList(const std::vector<FileData*>& files)
 	mHeaderText.setText(mRoot->getSystem()->getFullName());
 	if (files.size() > 0)
 	{
-		for (auto it = files.cbegin(); it != files.cend(); it++)
+		// names and texture paths are only looked up for the tiles around the cursor
+		mGrid.setObjects(files, [this](ImageGridComponent<FileData*>::Entry& entry)
 		{
-			mGrid.add((*it)->getName(), getImagePath(*it), *it);
-		}
+			entry.name = entry.object->getName();
+			entry.data.texturePath = getImagePath(entry.object);
+		});
 	}
 	else
 	{
@@ -162,11 +162,11 @@ bool ISimpleGameListView::input(InputConfig* config, Input input)
 	FileData* cursor = getCursor();
 	SystemData* system = this->mRoot->getSystem();
     	if (system != NULL) {
-            Scripting::fireEvent("game-select", system->getName(), cursor->getPath(), cursor->getName(), "input");
+            Scripting::fireEventAsync("game-select", system->getName(), cursor->getPath(), cursor->getName(), "input");
         }
 	else
 	{
-	    Scripting::fireEvent("game-select", "NULL", "NULL", "NULL", "input");
+	    Scripting::fireEventAsync("game-select", "NULL", "NULL", "NULL", "input");
 	}
 	return IGameListView::input(config, input);
 }
\ No newline at end of file
@@ -7,9 +7,7 @@
 #include "components/VideoVlcComponent.h"
 #include "utils/FileSystemUtil.h"
 #include "views/ViewController.h"
-#ifdef _OMX_
 #include "Settings.h"
-#endif
 
 VideoGameListView::VideoGameListView(Window* window, FileData* root) :
 	BasicGameListView(window, root),
@@ -265,6 +263,14 @@ void VideoGameListView::updateInfoPanel()
 		}
 		mVideoPlaying = true;
 
+		// Get the neighbouring entries ready so moving the cursor by one starts the video right away
+		if (Settings::getInstance()->getBool("VideoPreloadNeighbours") && mList.size() > 1)
+		{
+			const int cursor = mList.getCursorIndex();
+			mVideo->prefetchVideo(mList.getObjectAt((cursor + 1) % mList.size())->getVideoPath());
+			mVideo->prefetchVideo(mList.getObjectAt((cursor + mList.size() - 1) % mList.size())->getVideoPath());
+		}
+
 		mVideo->setImage(file->getThumbnailPath());
 		mThumbnail.setImage(file->getThumbnailPath());
 		mMarquee.setImage(file->getMarqueePath());
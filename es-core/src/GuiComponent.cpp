@@ -86,6 +86,7 @@ void GuiComponent::setPosition(float x, float y, float z)
 {
 	mPosition = Vector3f(x, y, z);
 	onPositionChanged();
+	Window::invalidate();
 }
 
 Vector2f GuiComponent::getOrigin() const
@@ -97,6 +98,7 @@ void GuiComponent::setOrigin(float x, float y)
 {
 	mOrigin = Vector2f(x, y);
 	onOriginChanged();
+	Window::invalidate();
 }
 
 Vector2f GuiComponent::getRotationOrigin() const
@@ -118,6 +120,7 @@ void GuiComponent::setSize(float w, float h)
 {
 	mSize = Vector2f(w, h);
     onSizeChanged();
+	Window::invalidate();
 }
 
 float GuiComponent::getRotation() const
@@ -128,6 +131,7 @@ float GuiComponent::getRotation() const
 void GuiComponent::setRotation(float rotation)
 {
 	mRotation = rotation;
+	Window::invalidate();
 }
 
 float GuiComponent::getScale() const
@@ -138,6 +142,7 @@ float GuiComponent::getScale() const
 void GuiComponent::setScale(float scale)
 {
 	mScale = scale;
+	Window::invalidate();
 }
 
 float GuiComponent::getZIndex() const
@@ -148,6 +153,7 @@ float GuiComponent::getZIndex() const
 void GuiComponent::setZIndex(float z)
 {
 	mZIndex = z;
+	Window::invalidate();
 }
 
 float GuiComponent::getDefaultZIndex() const
@@ -167,6 +173,7 @@ bool GuiComponent::isVisible() const
 void GuiComponent::setVisible(bool visible)
 {
 	mVisible = visible;
+	Window::invalidate();
 }
 
 Vector2f GuiComponent::getCenter() const
@@ -184,6 +191,7 @@ void GuiComponent::addChild(GuiComponent* cmp)
 		cmp->getParent()->removeChild(cmp);
 
 	cmp->setParent(this);
+	Window::invalidate();
 }
 
 void GuiComponent::removeChild(GuiComponent* cmp)
@@ -203,6 +211,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 		if(*i == cmp)
 		{
 			mChildren.erase(i);
+			Window::invalidate();
 			return;
 		}
 	}
@@ -248,6 +257,7 @@ unsigned char GuiComponent::getOpacity() const
 void GuiComponent::setOpacity(unsigned char opacity)
 {
 	mOpacity = opacity;
+	Window::invalidate();
 	for(auto it = mChildren.cbegin(); it != mChildren.cend(); it++)
 	{
 		(*it)->setOpacity(opacity);
@@ -1,12 +1,203 @@
 #include "HttpReq.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
 #include "Log.h"
+#include "Settings.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <assert.h>
 
-CURLM* HttpReq::s_multi_handle = curl_multi_init();
+// without curl_multi_wakeup new requests are only picked up once the I/O thread stops waiting by itself
+#if CURL_AT_LEAST_VERSION(7,68,0)
+#define POLL_TIMEOUT_MS 1000
+#else
+#define POLL_TIMEOUT_MS 10
+#endif
+
+// Owns the multi handle and the I/O thread driving it, curl handles are only ever touched by that thread
+class HttpReq::Client
+{
+public:
+	static Client& get()
+	{
+		static Client client;
+		return client;
+	}
+
+	void add(HttpReq* req)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mAdded.push_back(req);
+		wakeup();
+	}
+
+	// once this returns the I/O thread does not touch the request anymore
+	void remove(HttpReq* req)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = std::find(mAdded.begin(), mAdded.end(), req);
+		if(it != mAdded.end())
+		{
+			mAdded.erase(it);
+			return;
+		}
+
+		mRemoving.push_back(req);
+		wakeup();
+		mRemoved.wait(lock, [this, req] { return std::find(mRemoving.cbegin(), mRemoving.cend(), req) == mRemoving.cend(); });
+	}
+
+	CURLSH* getShare() const { return mShare; }
+	bool useHttp2() const { return mHttp2; }
+
+private:
+	Client() : mExit(false)
+	{
+		curl_global_init(CURL_GLOBAL_ALL);
+
+		mHttp2 = Settings::getInstance()->getBool("UseHttp2");
+
+		mMulti = curl_multi_init();
+		curl_multi_setopt(mMulti, CURLMOPT_PIPELINING, mHttp2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+		// connections are pooled by the multi handle already, DNS and TLS sessions are shared on top of that
+		mShare = curl_share_init();
+		curl_share_setopt(mShare, CURLSHOPT_LOCKFUNC, &Client::lockShare);
+		curl_share_setopt(mShare, CURLSHOPT_UNLOCKFUNC, &Client::unlockShare);
+		curl_share_setopt(mShare, CURLSHOPT_USERDATA, this);
+		curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+		mThread = std::thread(&Client::threadProc, this);
+	}
+
+	~Client()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mExit = true;
+			wakeup();
+		}
+		mThread.join();
+
+		curl_multi_cleanup(mMulti);
+		curl_share_cleanup(mShare);
+	}
+
+	void wakeup()
+	{
+#if CURL_AT_LEAST_VERSION(7,68,0)
+		curl_multi_wakeup(mMulti);
+#endif
+	}
+
+	void threadProc()
+	{
+		std::vector<HttpReq*> failed;
+
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
 
-std::map<CURL*, HttpReq*> HttpReq::s_requests;
+				if(mExit)
+					return;
+
+				for(auto it = mAdded.cbegin(); it != mAdded.cend(); ++it)
+				{
+					CURLMcode merr = curl_multi_add_handle(mMulti, (*it)->mHandle);
+					if(merr != CURLM_OK)
+					{
+						(*it)->onError(curl_multi_strerror(merr));
+						failed.push_back(*it);
+					}
+				}
+				mAdded.clear();
+
+				if(!mRemoving.empty())
+				{
+					for(auto it = mRemoving.cbegin(); it != mRemoving.cend(); ++it)
+					{
+						CURLMcode merr = curl_multi_remove_handle(mMulti, (*it)->mHandle);
+						if(merr != CURLM_OK)
+							LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+					}
+
+					mRemoving.clear();
+					mRemoved.notify_all();
+				}
+			}
+
+			// outside of the lock, a callback may lead to its request being removed right away
+			for(auto it = failed.cbegin(); it != failed.cend(); ++it)
+			{
+				(*it)->mStatus = REQ_IO_ERROR;
+				if((*it)->mCallback)
+					(*it)->mCallback(*it);
+			}
+			failed.clear();
+
+			int handle_count;
+			CURLMcode merr = curl_multi_perform(mMulti, &handle_count);
+			if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
+				LOG(LogError) << "curl_multi_perform failed: " << curl_multi_strerror(merr);
+
+			int msgs_left;
+			CURLMsg* msg;
+			while((msg = curl_multi_info_read(mMulti, &msgs_left)) != nullptr)
+			{
+				if(msg->msg != CURLMSG_DONE)
+					continue;
+
+				HttpReq* req = nullptr;
+				curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&req);
+
+				if(req == NULL)
+				{
+					LOG(LogError) << "Cannot find easy handle!";
+					continue;
+				}
+
+				req->onDone(msg->data.result);
+			}
+
+#if CURL_AT_LEAST_VERSION(7,66,0)
+			curl_multi_poll(mMulti, NULL, 0, POLL_TIMEOUT_MS, NULL);
+#else
+			int numfds = 0;
+			curl_multi_wait(mMulti, NULL, 0, POLL_TIMEOUT_MS, &numfds);
+			if(numfds == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT_MS));
+#endif
+		}
+	}
+
+	static void lockShare(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* client_ptr)
+	{
+		((Client*)client_ptr)->mShareMutexes[data].lock();
+	}
+
+	static void unlockShare(CURL* /*handle*/, curl_lock_data data, void* client_ptr)
+	{
+		((Client*)client_ptr)->mShareMutexes[data].unlock();
+	}
+
+	CURLM* mMulti;
+	CURLSH* mShare;
+	std::mutex mShareMutexes[CURL_LOCK_DATA_LAST];
+	bool mHttp2;
+
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mRemoved;
+	std::vector<HttpReq*> mAdded;
+	std::vector<HttpReq*> mRemoving;
+	bool mExit;
+};
 
 std::string HttpReq::urlEncode(const std::string &s)
 {
@@ -37,16 +228,24 @@ bool HttpReq::isUrl(const std::string& str)
 		(str.find("http://") != std::string::npos || str.find("https://") != std::string::npos || str.find("www.") != std::string::npos));
 }
 
-HttpReq::HttpReq(const std::string& url)
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL)
+HttpReq::HttpReq(const std::string& url, const std::vector<std::string>& headers, const Callback& callback)
+	: mHandle(NULL), mRequestHeaders(NULL), mCallback(callback), mQueued(false), mStatus(REQ_IN_PROGRESS), mResponseCode(0)
+{
+	if(!setup(url, headers) && mCallback)
+		mCallback(this);
+}
+
+bool HttpReq::setup(const std::string& url, const std::vector<std::string>& headers)
 {
+	Client& client = Client::get();
+
 	mHandle = curl_easy_init();
 
 	if(mHandle == NULL)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError("curl_easy_init failed");
-		return;
+		return false;
 	}
 
 	//set the url
@@ -55,7 +254,7 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
 	//set curl to handle redirects
@@ -64,7 +263,7 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
 	//set curl max redirects
@@ -73,7 +272,7 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
 	//set curl restrict redirect protocols
@@ -88,7 +287,7 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
 	//tell curl how to write the data
@@ -97,7 +296,7 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
 	//give curl a pointer to this HttpReq so we know where to write the data *to* in our write function
@@ -106,75 +305,106 @@ HttpReq::HttpReq(const std::string& url)
 	{
 		mStatus = REQ_IO_ERROR;
 		onError(curl_easy_strerror(err));
-		return;
+		return false;
 	}
 
-	//add the handle to our multi
-	CURLMcode merr = curl_multi_add_handle(s_multi_handle, mHandle);
-	if(merr != CURLM_OK)
+	//collect the response headers
+	err = curl_easy_setopt(mHandle, CURLOPT_HEADERFUNCTION, &HttpReq::write_header);
+	if(err != CURLE_OK)
 	{
 		mStatus = REQ_IO_ERROR;
-		onError(curl_multi_strerror(merr));
-		return;
+		onError(curl_easy_strerror(err));
+		return false;
 	}
 
-	s_requests[mHandle] = this;
-}
+	err = curl_easy_setopt(mHandle, CURLOPT_HEADERDATA, this);
+	if(err != CURLE_OK)
+	{
+		mStatus = REQ_IO_ERROR;
+		onError(curl_easy_strerror(err));
+		return false;
+	}
 
-HttpReq::~HttpReq()
-{
-	if(mHandle)
+	//add the request headers, curl keeps a pointer to the list until the handle is cleaned up
+	if(!headers.empty())
 	{
-		s_requests.erase(mHandle);
+		for(auto it = headers.cbegin(); it != headers.cend(); ++it)
+			mRequestHeaders = curl_slist_append(mRequestHeaders, it->c_str());
 
-		CURLMcode merr = curl_multi_remove_handle(s_multi_handle, mHandle);
+		err = curl_easy_setopt(mHandle, CURLOPT_HTTPHEADER, mRequestHeaders);
+		if(err != CURLE_OK)
+		{
+			mStatus = REQ_IO_ERROR;
+			onError(curl_easy_strerror(err));
+			return false;
+		}
+	}
 
-		if(merr != CURLM_OK)
-			LOG(LogError) << "Error removing curl_easy handle from curl_multi: " << curl_multi_strerror(merr);
+	//share DNS and TLS sessions with all other requests
+	err = curl_easy_setopt(mHandle, CURLOPT_SHARE, client.getShare());
+	if(err != CURLE_OK)
+	{
+		mStatus = REQ_IO_ERROR;
+		onError(curl_easy_strerror(err));
+		return false;
+	}
 
-		curl_easy_cleanup(mHandle);
+	//negotiate HTTP/2 on https and rather wait for a connection to multiplex on than open another one
+	err = curl_easy_setopt(mHandle, CURLOPT_HTTP_VERSION, client.useHttp2() ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_1_1);
+	if(err == CURLE_OK && client.useHttp2())
+		err = curl_easy_setopt(mHandle, CURLOPT_PIPEWAIT, 1L);
+	if(err != CURLE_OK && err != CURLE_UNSUPPORTED_PROTOCOL)
+	{
+		mStatus = REQ_IO_ERROR;
+		onError(curl_easy_strerror(err));
+		return false;
 	}
+
+	//lets the I/O thread find us from the easy handle
+	err = curl_easy_setopt(mHandle, CURLOPT_PRIVATE, this);
+	if(err != CURLE_OK)
+	{
+		mStatus = REQ_IO_ERROR;
+		onError(curl_easy_strerror(err));
+		return false;
+	}
+
+	//hand the handle to the I/O thread
+	mQueued = true;
+	client.add(this);
+	return true;
 }
 
-HttpReq::Status HttpReq::status()
+HttpReq::~HttpReq()
 {
-	if(mStatus == REQ_IN_PROGRESS)
-	{
-		int handle_count;
-		CURLMcode merr = curl_multi_perform(s_multi_handle, &handle_count);
-		if(merr != CURLM_OK && merr != CURLM_CALL_MULTI_PERFORM)
-		{
-			mStatus = REQ_IO_ERROR;
-			onError(curl_multi_strerror(merr));
-			return mStatus;
-		}
+	if(mQueued)
+		Client::get().remove(this);
 
-		int msgs_left;
-		CURLMsg* msg;
-		while((msg = curl_multi_info_read(s_multi_handle, &msgs_left)) != nullptr)
-		{
-			if(msg->msg == CURLMSG_DONE)
-			{
-				HttpReq* req = s_requests[msg->easy_handle];
+	if(mHandle)
+		curl_easy_cleanup(mHandle);
 
-				if(req == NULL)
-				{
-					LOG(LogError) << "Cannot find easy handle!";
-					continue;
-				}
+	if(mRequestHeaders)
+		curl_slist_free_all(mRequestHeaders);
+}
 
-				if(msg->data.result == CURLE_OK)
-				{
-					req->mStatus = REQ_SUCCESS;
-				}else{
-					req->mStatus = REQ_IO_ERROR;
-					req->onError(curl_easy_strerror(msg->data.result));
-				}
-			}
-		}
+HttpReq::Status HttpReq::status()
+{
+	return mStatus;
+}
+
+void HttpReq::onDone(CURLcode result)
+{
+	if(result == CURLE_OK)
+	{
+		curl_easy_getinfo(mHandle, CURLINFO_RESPONSE_CODE, &mResponseCode);
+		mStatus = REQ_SUCCESS;
+	}else{
+		onError(curl_easy_strerror(result));
+		mStatus = REQ_IO_ERROR;
 	}
 
-	return mStatus;
+	if(mCallback)
+		mCallback(this);
 }
 
 std::string HttpReq::getContent() const
@@ -183,6 +413,18 @@ std::string HttpReq::getContent() const
 	return mContent.str();
 }
 
+long HttpReq::getResponseCode() const
+{
+	assert(mStatus == REQ_SUCCESS);
+	return mResponseCode;
+}
+
+std::string HttpReq::getHeader(const std::string& name) const
+{
+	auto it = mHeaders.find(name);
+	return (it != mHeaders.cend()) ? it->second : "";
+}
+
 void HttpReq::onError(const char* msg)
 {
 	mErrorMsg = msg;
@@ -201,7 +443,26 @@ size_t HttpReq::write_content(void* buff, size_t size, size_t nmemb, void* req_p
 	std::stringstream& ss = ((HttpReq*)req_ptr)->mContent;
 	ss.write((char*)buff, size * nmemb);
 
-	return nmemb;
+	return size * nmemb;
+}
+
+//used as a curl callback, called once per header line
+size_t HttpReq::write_header(char* buff, size_t size, size_t nmemb, void* req_ptr)
+{
+	const std::string line(buff, size * nmemb);
+	const size_t colon = line.find(':');
+
+	if(colon != std::string::npos)
+	{
+		const size_t start = line.find_first_not_of(" \t", colon + 1);
+		const size_t end = line.find_last_not_of(" \t\r\n");
+		const std::string value = (start != std::string::npos && end >= start) ? line.substr(start, end - start + 1) : "";
+
+		// a redirect has headers of its own, the last response wins
+		((HttpReq*)req_ptr)->mHeaders[Utils::String::toLower(line.substr(0, colon))] = value;
+	}
+
+	return size * nmemb;
 }
 
 //used as a curl callback
@@ -3,13 +3,17 @@
 #define ES_CORE_HTTP_REQ_H
 
 #include <curl/curl.h>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <sstream>
+#include <vector>
 
 /* Usage:
  * HttpReq myRequest("www.google.com", "/index.html");
  * //for blocking behavior: while(myRequest.status() == HttpReq::REQ_IN_PROGRESS);
  * //for non-blocking behavior: check if(myRequest.status() != HttpReq::REQ_IN_PROGRESS) in some sort of update method
+ * //or pass a callback, it is called once the request is done
  *
  * //once one of those completes, the request is ready
  * if(myRequest.status() != REQ_SUCCESS)
@@ -21,12 +25,21 @@
  *
  * std::string content = myRequest.getContent();
  * //process contents...
+ *
+ * All transfers are driven by a single I/O thread, they make progress whether status() is called or not.
+ * DNS lookups, connections and TLS sessions are shared between requests. With the UseHttp2 setting requests
+ * to the same host are multiplexed over a single connection when the server supports it.
 */
 
 class HttpReq
 {
 public:
-	HttpReq(const std::string& url);
+	// called exactly once when the request is done, it must not block and must not delete the request
+	// usually on the I/O thread, on the constructing thread if the request could not even be set up
+	typedef std::function<void(HttpReq* req)> Callback;
+
+	// headers are sent as given, e.g. "If-None-Match: \"etag\""
+	HttpReq(const std::string& url, const std::vector<std::string>& headers = std::vector<std::string>(), const Callback& callback = nullptr);
 
 	~HttpReq();
 
@@ -40,32 +53,40 @@ public:
 		REQ_INVALID_RESPONSE	//the HTTP response was invalid
 	};
 
-	Status status(); //process any received data and return the status afterwards
+	Status status(); //return the status, the transfer itself happens on the I/O thread
 
 	std::string getErrorMsg();
 
 	std::string getContent() const; // mStatus must be REQ_SUCCESS
+	long getResponseCode() const; // HTTP status code, mStatus must be REQ_SUCCESS
+	std::string getHeader(const std::string& name) const; // response header, name in lower case
 
 	static std::string urlEncode(const std::string &s);
 	static bool isUrl(const std::string& s);
 
 private:
+	class Client;
+	friend class Client;
+
 	static size_t write_content(void* buff, size_t size, size_t nmemb, void* req_ptr);
+	static size_t write_header(char* buff, size_t size, size_t nmemb, void* req_ptr);
 	//static int update_progress(void* req_ptr, double dlTotal, double dlNow, double ulTotal, double ulNow);
 
-	//god dammit libcurl why can't you have some way to check the status of an individual handle
-	//why do I have to handle ALL messages at once
-	static std::map<CURL*, HttpReq*> s_requests;
-
-	static CURLM* s_multi_handle;
-
+	bool setup(const std::string& url, const std::vector<std::string>& headers);
 	void onError(const char* msg);
+	void onDone(CURLcode result); // on the I/O thread
 
 	CURL* mHandle;
+	curl_slist* mRequestHeaders;
+	Callback mCallback;
+	bool mQueued; // handed to the I/O thread
 
-	Status mStatus;
+	// written by the I/O thread until mStatus leaves REQ_IN_PROGRESS
+	std::atomic<Status> mStatus;
 
 	std::stringstream mContent;
+	std::map<std::string, std::string> mHeaders;
+	long mResponseCode;
 	std::string mErrorMsg;
 };
 
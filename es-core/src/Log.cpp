@@ -2,12 +2,287 @@
 
 #include "utils/FileSystemUtil.h"
 #include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
-#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <thread>
+
+#define FLUSH_SIZE        (16 * 1024)
+#define FLUSH_INTERVAL_MS 1000
+#define WAKE_INTERVAL_MS  50
 
 LogLevel Log::reportingLevel = LogInfo;
 FILE* Log::file = NULL; //fopen(getLogPath().c_str(), "w");
 
+namespace
+{
+	struct Message
+	{
+		std::atomic<Message*> next;
+		std::string text;
+		LogLevel level;
+		time_t time;
+	};
+
+	//Intrusive multi producer, single consumer queue. Producers only swap the head pointer,
+	//the writer thread is the only one following the links from the tail.
+	class MessageQueue
+	{
+	public:
+		MessageQueue() : mHead(&mStub), mTail(&mStub) { mStub.next = nullptr; }
+
+		void push(Message* message)
+		{
+			message->next.store(nullptr, std::memory_order_relaxed);
+			Message* prev = mHead.exchange(message, std::memory_order_acq_rel);
+			prev->next.store(message, std::memory_order_release);
+		}
+
+		Message* pop()
+		{
+			Message* first = mTail;
+			Message* next = first->next.load(std::memory_order_acquire);
+
+			if(first == &mStub)
+			{
+				if(next == nullptr)
+					return nullptr;
+
+				mTail = next;
+				first = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+
+			if(next != nullptr)
+			{
+				mTail = next;
+				return first;
+			}
+
+			// a producer is in the middle of a push, pick the message up next time
+			if(first != mHead.load(std::memory_order_acquire))
+				return nullptr;
+
+			push(&mStub);
+			next = first->next.load(std::memory_order_acquire);
+			if(next != nullptr)
+			{
+				mTail = next;
+				return first;
+			}
+
+			return nullptr;
+		}
+
+	private:
+		std::atomic<Message*> mHead;
+		Message* mTail;
+		Message mStub;
+	};
+
+	class Writer
+	{
+	public:
+		Writer(FILE* output) : mOutput(output), mExit(false), mFlushRequested(0), mFlushCompleted(0),
+			mQueued(0), mIdle(false), mWritten(0), mUnflushed(0), mLastLevel(LogError), mLastTime(0), mRepeated(0), mFormattedTime(0)
+		{
+			mFormattedTimeText[0] = '\0';
+			mLastFlush = std::chrono::steady_clock::now();
+			mThread = std::thread(&Writer::threadProc, this);
+		}
+
+		~Writer()
+		{
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mExit = true;
+			}
+			mEvent.notify_one();
+			mThread.join();
+
+			// whatever was queued while the thread was exiting
+			writeQueued();
+			writeRepeated();
+			fflush(mOutput);
+		}
+
+		void queue(Message* message)
+		{
+			mMessages.push(message);
+			mQueued.fetch_add(1);
+
+			// an idle writer sleeps until the first message, errors are written right away and
+			// everything else waits for the next wake up
+			if(mIdle.exchange(false))
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mEvent.notify_one();
+			}
+			else if(message->level == LogError)
+				mEvent.notify_one();
+		}
+
+		void flush()
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			const unsigned int request = ++mFlushRequested;
+			mEvent.notify_one();
+			mDone.wait(lock, [this, request] { return mFlushCompleted >= request; });
+		}
+
+	private:
+		void threadProc()
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+
+			while(true)
+			{
+				const bool exiting = mExit;
+				const unsigned int request = mFlushRequested;
+				lock.unlock();
+
+				const bool urgent = writeQueued();
+
+				const auto now = std::chrono::steady_clock::now();
+				if(urgent || (request != mFlushCompleted) || (mUnflushed >= FLUSH_SIZE) ||
+					(mUnflushed && (now - mLastFlush) >= std::chrono::milliseconds(FLUSH_INTERVAL_MS)))
+				{
+					writeRepeated();
+					fflush(mOutput);
+					mUnflushed = 0;
+					mLastFlush = now;
+				}
+
+				lock.lock();
+
+				if(request != mFlushCompleted)
+				{
+					mFlushCompleted = request;
+					mDone.notify_all();
+				}
+
+				if(exiting)
+					return;
+
+				if(mFlushRequested != mFlushCompleted || mExit)
+					continue;
+
+				// only wake up periodically while there is something left to write or flush
+				if(mUnflushed || mRepeated || (mQueued.load() != mWritten))
+				{
+					mEvent.wait_for(lock, std::chrono::milliseconds(WAKE_INTERVAL_MS));
+					continue;
+				}
+
+				// a message queued after the check above sees mIdle set and notifies
+				mIdle.store(true);
+				if(mQueued.load() == mWritten)
+					mEvent.wait(lock, [this] { return !mIdle.load() || mExit || (mFlushRequested != mFlushCompleted); });
+				mIdle.store(false);
+			}
+		}
+
+		// returns true if an error was written
+		bool writeQueued()
+		{
+			bool error = false;
+
+			while(Message* message = mMessages.pop())
+			{
+				error |= (message->level == LogError);
+				write(*message);
+				delete message;
+				++mWritten;
+			}
+
+			return error;
+		}
+
+		void write(const Message& message)
+		{
+			// collapse bursts of the same message into a count, written with the next flush or other message
+			if(message.level == mLastLevel && message.text == mLastText)
+			{
+				++mRepeated;
+				return;
+			}
+
+			writeRepeated();
+			writeLine(message.time, message.level, message.text);
+
+			mLastText = message.text;
+			mLastLevel = message.level;
+		}
+
+		void writeRepeated()
+		{
+			if(!mRepeated)
+				return;
+
+			std::ostringstream ss;
+			ss << "Last message repeated " << mRepeated << " times\n";
+			writeLine(mLastTime, mLastLevel, ss.str());
+			mRepeated = 0;
+		}
+
+		void writeLine(time_t time, LogLevel level, const std::string& text)
+		{
+			// localtime is only called once per second
+			if(time != mFormattedTime)
+			{
+				struct tm local;
+#if defined(_WIN32)
+				localtime_s(&local, &time);
+#else
+				localtime_r(&time, &local);
+#endif
+				strftime(mFormattedTimeText, sizeof(mFormattedTimeText), "%b %d %T ", &local);
+				mFormattedTime = time;
+			}
+
+			fprintf(mOutput, "%slvl%d: \t%s", mFormattedTimeText, (int)level, text.c_str());
+			mUnflushed += strlen(mFormattedTimeText) + text.size() + 8;
+			mLastTime = time;
+
+			//if it's an error, also print to console
+			//print all messages if using --debug
+			if(level == LogError || Log::getReportingLevel() >= LogDebug)
+				fprintf(stderr, "%slvl%d: \t%s", mFormattedTimeText, (int)level, text.c_str());
+		}
+
+		FILE* mOutput;
+		MessageQueue mMessages;
+		std::thread mThread;
+		std::mutex mMutex;
+		std::condition_variable mEvent;
+		std::condition_variable mDone;
+		bool mExit;
+		unsigned int mFlushRequested;
+		unsigned int mFlushCompleted;
+		std::atomic<unsigned int> mQueued;
+		std::atomic<bool> mIdle;
+
+		// only touched by the writer thread
+		unsigned int mWritten;
+		std::chrono::steady_clock::time_point mLastFlush;
+		size_t mUnflushed;
+		std::string mLastText;
+		LogLevel mLastLevel;
+		time_t mLastTime;
+		unsigned int mRepeated;
+		time_t mFormattedTime;
+		char mFormattedTimeText[32];
+	};
+
+	// accessed through std::atomic_load/atomic_exchange, every ~Log holds its own reference while queueing
+	// so close() can wait for them before the writer drains the queue and the file is closed
+	std::shared_ptr<Writer> writer;
+}
+
 LogLevel Log::getReportingLevel()
 {
 	return reportingLevel;
@@ -35,12 +310,15 @@ void Log::init()
 void Log::open()
 {
 	file = fopen(getLogPath().c_str(), "w");
+
+	if(file != NULL)
+		std::atomic_store(&writer, std::make_shared<Writer>(file));
 }
 
 std::ostringstream& Log::get(LogLevel level)
 {
-	time_t t = time(nullptr);
-	os << std::put_time(localtime(&t), "%b %d %T ") << "lvl" << level << ": \t";
+	// the writer thread formats the timestamp, only the raw time is taken here
+	messageTime = time(nullptr);
 	messageLevel = level;
 
 	return os;
@@ -48,12 +326,26 @@ std::ostringstream& Log::get(LogLevel level)
 
 void Log::flush()
 {
-	fflush(getOutput());
+	std::shared_ptr<Writer> current = std::atomic_load(&writer);
+	if(current)
+		current->flush();
+	else if(getOutput() != NULL)
+		fflush(getOutput());
 }
 
 void Log::close()
 {
 	if(file == NULL) return;
+
+	std::shared_ptr<Writer> current = std::atomic_exchange(&writer, std::shared_ptr<Writer>());
+
+	// messages on other threads may still be queued to it, new ones go to stderr from now on
+	while(current && (current.use_count() > 1))
+		std::this_thread::yield();
+
+	// joins the writer thread and writes everything still queued
+	current.reset();
+
 	fclose(file);
 	file = NULL;
 }
@@ -67,18 +359,18 @@ Log::~Log()
 {
 	os << std::endl;
 
-	if(getOutput() == NULL)
+	std::shared_ptr<Writer> current = std::atomic_load(&writer);
+	if(!current)
 	{
-		// not open yet, print to stdout
-		std::cerr << "ERROR - tried to write to log file before it was open! The following won't be logged:\n";
+		// not open yet or closed already, print to stderr
+		std::cerr << "ERROR - tried to write to log file while it was not open! The following won't be logged:\n";
 		std::cerr << os.str();
 		return;
 	}
 
-	fprintf(getOutput(), "%s", os.str().c_str());
-
-	//if it's an error, also print to console
-	//print all messages if using --debug
-	if(messageLevel == LogError || reportingLevel >= LogDebug)
-		fprintf(stderr, "%s", os.str().c_str());
+	Message* message = new Message;
+	message->text = os.str();
+	message->level = messageLevel;
+	message->time = messageTime;
+	current->queue(message);
 }
@@ -3,6 +3,7 @@
 #define ES_CORE_LOG_H
 
 #include <sstream>
+#include <time.h>
 
 #define LOG(level) \
 if(level <= Log::getReportingLevel()) \
@@ -10,6 +11,9 @@ if(level <= Log::getReportingLevel()) \
 
 enum LogLevel { LogError, LogWarning, LogInfo, LogDebug };
 
+//Messages are handed to a writer thread through a lock-free queue once the log is open,
+//so logging never waits for the disk. The writer formats the timestamps, collapses repeated
+//messages and flushes the file once enough was written, after a second or right away on errors.
 class Log
 {
 public:
@@ -22,6 +26,7 @@ public:
 
 	static std::string getLogPath();
 
+	//Blocks until everything logged so far is written to the file.
 	static void flush();
 	static void init();
 	static void open();
@@ -33,6 +38,7 @@ private:
 	static LogLevel reportingLevel;
 	static FILE* getOutput();
 	LogLevel messageLevel;
+	time_t messageTime;
 };
 
 #endif // ES_CORE_LOG_H
@@ -2,31 +2,59 @@
 #include "Log.h"
 #include "platform.h"
 #include "utils/FileSystemUtil.h"
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
 #ifndef WIN32
 #include <errno.h>
 #include <string.h>
 #endif
 
+// how long a listing of the script directories is trusted before they are read again
+#define SCRIPT_CACHE_TIMEOUT_MS 5000
+
 namespace Scripting
 {
-    int fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, const std::string& arg4)
+    struct ScriptList
     {
-        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2;
+        std::list<std::string>                scripts;
+        std::chrono::steady_clock::time_point listed;
+    };
 
-        std::list<std::string> scriptDirList;
-        std::string test;
+    static std::map<std::string, ScriptList> sScriptCache;
+    static std::mutex                        sScriptCacheMutex;
 
-        // check in exepath
-        test = Utils::FileSystem::getExePath() + "/scripts/" + eventName;
-        if(Utils::FileSystem::exists(test))
-            scriptDirList.push_back(test);
+    // queued events, by event name, in the order they were first fired
+    static std::map<std::string, std::list<std::string>> sQueuedCommands;
+    static std::list<std::string>                        sQueuedEvents;
+    static std::thread*                                  sWorker  = nullptr;
+    static std::mutex                                    sWorkerMutex;
+    static std::condition_variable                       sWorkerEvent;
+    static std::condition_variable                       sWorkerIdle;
+    static bool                                          sRunning = false;
+    static bool                                          sExit    = false;
+
+    static std::list<std::string> getScripts(const std::string& eventName)
+    {
+        std::unique_lock<std::mutex> lock(sScriptCacheMutex);
+
+        const auto now = std::chrono::steady_clock::now();
+        auto       it  = sScriptCache.find(eventName);
+        if(it != sScriptCache.cend() && (now - it->second.listed) < std::chrono::milliseconds(SCRIPT_CACHE_TIMEOUT_MS))
+            return it->second.scripts;
+
+        ScriptList& list = sScriptCache[eventName];
+        list.scripts.clear();
+        list.listed = now;
+
+        // check in exepath and homepath, a missing directory simply has no content
+        std::list<std::string> scriptDirList;
+        scriptDirList.push_back(Utils::FileSystem::getExePath() + "/scripts/" + eventName);
+        scriptDirList.push_back(Utils::FileSystem::getHomePath() + "/.emulationstation/scripts/" + eventName);
 
-        // check in homepath
-        test = Utils::FileSystem::getHomePath() + "/.emulationstation/scripts/" + eventName;
-        if(Utils::FileSystem::exists(test))
-            scriptDirList.push_back(test);
-        int ret = 0;
-        // loop over found script paths per event and over scripts found in eventName folder.
         for(std::list<std::string>::const_iterator dirIt = scriptDirList.cbegin(); dirIt != scriptDirList.cend(); ++dirIt) {
             std::list<std::string> scripts = Utils::FileSystem::getDirContent(*dirIt);
             for (std::list<std::string>::const_iterator it = scripts.cbegin(); it != scripts.cend(); ++it) {
@@ -36,34 +64,142 @@ namespace Scripting
                     continue;
                 }
 #endif
-                std::string script = *it;
-                if (arg1.length() > 0) {
-                    script += " \"" + arg1 + "\"";
-                    if (arg2.length() > 0) {
-                        script += " \"" + arg2 + "\"";
-			if (arg3.length() > 0) {
-			    script += " \"" + arg3 + "\"";
-                            if (arg4.length() > 0) {
-                                script += " \"" + arg4 + "\"";
-			    }
+                list.scripts.push_back(*it);
+            }
+        }
+
+        return list.scripts;
+    }
+
+    static std::list<std::string> getCommands(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, const std::string& arg4)
+    {
+        std::list<std::string> commands = getScripts(eventName);
+
+        for (std::list<std::string>::iterator it = commands.begin(); it != commands.end(); ++it) {
+            std::string& script = *it;
+            if (arg1.length() > 0) {
+                script += " \"" + arg1 + "\"";
+                if (arg2.length() > 0) {
+                    script += " \"" + arg2 + "\"";
+                    if (arg3.length() > 0) {
+                        script += " \"" + arg3 + "\"";
+                        if (arg4.length() > 0) {
+                            script += " \"" + arg4 + "\"";
                         }
                     }
                 }
-                LOG(LogDebug) << "executing: " << script;
-                ret = runSystemCommand(script);
-                if (ret != 0) {
-                    LOG(LogWarning) << script << " failed with exit code != 0. Terminating processing for this event.";
+            }
+        }
+
+        return commands;
+    }
+
+    static int runCommands(const std::list<std::string>& commands)
+    {
+        int ret = 0;
+        for (std::list<std::string>::const_iterator it = commands.cbegin(); it != commands.cend(); ++it) {
+            const std::string& script = *it;
+            LOG(LogDebug) << "executing: " << script;
+            ret = runSystemCommand(script);
+            if (ret != 0) {
+                LOG(LogWarning) << script << " failed with exit code != 0. Terminating processing for this event.";
 #ifndef WIN32
-                    if (ENOENT == errno) {
-                        LOG(LogWarning) << "Exit code: " << errno << " (" << strerror(errno) << ")";
-                        LOG(LogWarning) << "It is not executable by the current user (usually 'pi'). Review file permissions.";
-                    }
-#endif
-                    return ret;
+                if (ENOENT == errno) {
+                    LOG(LogWarning) << "Exit code: " << errno << " (" << strerror(errno) << ")";
+                    LOG(LogWarning) << "It is not executable by the current user (usually 'pi'). Review file permissions.";
                 }
+#endif
+                return ret;
             }
         }
         return ret;
     }
 
+    static void workerProc()
+    {
+        std::unique_lock<std::mutex> lock(sWorkerMutex);
+
+        while(true)
+        {
+            sWorkerEvent.wait(lock, [] { return sExit || !sQueuedEvents.empty(); });
+
+            if(sExit)
+                return;
+
+            const std::string      eventName = sQueuedEvents.front();
+            std::list<std::string> commands  = sQueuedCommands[eventName];
+            sQueuedEvents.pop_front();
+            sQueuedCommands.erase(eventName);
+            sRunning = true;
+
+            lock.unlock();
+            runCommands(commands);
+            lock.lock();
+
+            sRunning = false;
+            sWorkerIdle.notify_all();
+        }
+    }
+
+    int fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, const std::string& arg4)
+    {
+        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2;
+
+        std::list<std::string> commands = getCommands(eventName, arg1, arg2, arg3, arg4);
+        if(commands.empty())
+            return 0;
+
+        // keep the order in which events were fired, the queued ones are still handled by the worker
+        {
+            std::unique_lock<std::mutex> lock(sWorkerMutex);
+            sWorkerIdle.wait(lock, [] { return sExit || (!sRunning && sQueuedEvents.empty()); });
+        }
+
+        return runCommands(commands);
+    }
+
+    void fireEventAsync(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3, const std::string& arg4)
+    {
+        LOG(LogDebug) << "fireEventAsync: " << eventName << " " << arg1 << " " << arg2;
+
+        // the listing is cached, without any scripts for the event this is all it costs
+        std::list<std::string> commands = getCommands(eventName, arg1, arg2, arg3, arg4);
+        if(commands.empty())
+            return;
+
+        std::unique_lock<std::mutex> lock(sWorkerMutex);
+
+        if(sExit)
+            return;
+
+        // an event that was not run yet is replaced, only the latest selection matters
+        if(sQueuedCommands.find(eventName) == sQueuedCommands.cend())
+            sQueuedEvents.push_back(eventName);
+        sQueuedCommands[eventName] = commands;
+
+        if(!sWorker)
+            sWorker = new std::thread(workerProc);
+
+        sWorkerEvent.notify_one();
+    }
+
+    void deinit()
+    {
+        {
+            std::unique_lock<std::mutex> lock(sWorkerMutex);
+            sExit = true;
+            sQueuedEvents.clear();
+            sQueuedCommands.clear();
+        }
+        sWorkerEvent.notify_one();
+        sWorkerIdle.notify_all();
+
+        if(sWorker)
+        {
+            sWorker->join();
+            delete sWorker;
+            sWorker = nullptr;
+        }
+    }
+
 } // Scripting::
@@ -6,7 +6,12 @@
 
 namespace Scripting
 {
+	// Runs the scripts of the event on the calling thread, after any queued events, and returns the first non-zero exit code
 	int fireEvent(const std::string& eventName, const std::string& arg1="", const std::string& arg2="", const std::string& arg3="", const std::string& arg4="");
+	// Runs the scripts of the event on a background thread, a queued event of the same name is replaced by the newer one
+	void fireEventAsync(const std::string& eventName, const std::string& arg1="", const std::string& arg2="", const std::string& arg3="", const std::string& arg4="");
+	// Waits for the running script and drops the queued events
+	void deinit();
 } // Scripting::
 
 #endif //ES_CORE_SCRIPTING_H
@@ -60,6 +60,13 @@ void Settings::setDefaults()
 	mBoolMap["ParseGamelistOnly"] = false;
 	mBoolMap["ShowHiddenFiles"] = false;
 	mBoolMap["DrawFramerate"] = false;
+	mIntMap["MaxFPS"] = 0;
+	mIntMap["ProfilerTraceWindow"] = 10000;
+	mIntMap["SVGCacheSize"] = 16;
+	mIntMap["GameListViewCacheSize"] = 12; // 0 == no limit
+	mIntMap["SuspendMemoryBudget"] = 64; // MB of images and glyphs kept while a game runs
+	mBoolMap["SVGDiskCache"] = false;
+	mIntMap["SVGDiskCacheSize"] = 32; // MB
 	mBoolMap["ShowExit"] = true;
 	mBoolMap["ConfirmQuit"] = true;
 	mBoolMap["FullscreenBorderless"] = false;
@@ -80,6 +87,7 @@ void Settings::setDefaults()
 	mBoolMap["MoveCarousel"] = true;
 
 	mBoolMap["ThreadedLoading"] = false;
+	mBoolMap["UseHttp2"] = true;
 
 	mBoolMap["Debug"] = false;
 	mBoolMap["DebugGrid"] = false;
@@ -91,6 +99,12 @@ void Settings::setDefaults()
 	mBoolMap["SystemSleepTimeHintDisplayed"] = false;
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
+	mIntMap["ScraperParallelSearches"] = 2;
+	mIntMap["ScraperParallelDownloads"] = 4;
+	mIntMap["ScraperHostInterval"] = 100;
+	mIntMap["ScraperCacheSize"] = 100;
+	mIntMap["ScraperCacheTTL"] = 7 * 24;
+	mIntMap["ScraperCacheMediaTTL"] = 30 * 24;
 	#ifdef _RPI_
 		mIntMap["MaxVRAM"] = 80;
 	#else
@@ -101,6 +115,7 @@ void Settings::setDefaults()
 	mStringMap["ThemeSet"] = "";
 	mStringMap["ScreenSaverBehavior"] = "dim";
 	mStringMap["Scraper"] = "TheGamesDB";
+	mStringMap["ScraperHostOverride"] = "";
 	mStringMap["GamelistViewStyle"] = "automatic";
 	mStringMap["SaveGamelistsMode"] = "on exit";
 
@@ -136,6 +151,9 @@ void Settings::setDefaults()
 	mIntMap["ScreenSaverSwapVideoTimeout"] = 30000;
 
 	mBoolMap["VideoAudio"] = true;
+	// Gamelist videos only start once the selection didn't change for this long (ms)
+	mIntMap["VideoStartDebounce"] = 250;
+	mBoolMap["VideoPreloadNeighbours"] = false;
 	mBoolMap["ScreenSaverVideoMute"] = false;
 	mStringMap["VlcScreenSaverResolution"] = "original";
 	// Audio out device for Video playback using OMX player.
@@ -345,10 +363,53 @@ void Settings::processBackwardCompatibility()
 } \
 void Settings::setMethodName(const std::string& name, type value) \
 { \
+	auto it = mapName.find(name); \
+	if(it != mapName.cend() && it->second == value) \
+		return; \
 	mapName[name] = value; \
+	notifyObservers(name); \
+}
+
+//Same warning as above, the handle points straight at the value in the map.
+#define SETTINGS_HANDLE(type, mapName) template<> SettingHandle<type> Settings::getHandle(const SettingKey<type>& key) \
+{ \
+	if(mapName.find(key.name) == mapName.cend()) \
+	{ \
+		LOG(LogError) << "Tried to use unset setting " << key.name << "!"; \
+	} \
+	return SettingHandle<type>(&mapName[key.name]); \
 }
 
 SETTINGS_GETSET(bool, mBoolMap, getBool, setBool);
 SETTINGS_GETSET(int, mIntMap, getInt, setInt);
 SETTINGS_GETSET(float, mFloatMap, getFloat, setFloat);
 SETTINGS_GETSET(const std::string&, mStringMap, getString, setString);
+
+SETTINGS_HANDLE(bool, mBoolMap);
+SETTINGS_HANDLE(int, mIntMap);
+SETTINGS_HANDLE(float, mFloatMap);
+SETTINGS_HANDLE(std::string, mStringMap);
+
+void Settings::addObserver(const std::string& name, const void* owner, const std::function<void()>& callback)
+{
+	mObservers[name].push_back({ owner, callback });
+}
+
+void Settings::removeObserver(const void* owner)
+{
+	for(auto& it : mObservers)
+	{
+		std::vector<Observer>& observers = it.second;
+		observers.erase(std::remove_if(observers.begin(), observers.end(), [owner](const Observer& observer) { return observer.owner == owner; }), observers.end());
+	}
+}
+
+void Settings::notifyObservers(const std::string& name)
+{
+	auto it = mObservers.find(name);
+	if(it == mObservers.cend())
+		return;
+
+	for(auto& observer : it->second)
+		observer.callback();
+}
@@ -2,8 +2,42 @@
 #ifndef ES_CORE_SETTINGS_H
 #define ES_CORE_SETTINGS_H
 
+#include <functional>
 #include <map>
 #include <string>
+#include <vector>
+
+//A setting key bound to the type of its value, used to get a SettingHandle.
+template<typename T>
+struct SettingKey
+{
+	const char* name;
+};
+
+//Keys of settings read per frame or per item.
+namespace SettingKeys
+{
+	constexpr SettingKey<bool> CollectionShowSystemInfo = { "CollectionShowSystemInfo" };
+	constexpr SettingKey<bool> DrawFramerate            = { "DrawFramerate" };
+	constexpr SettingKey<bool> LocalArt                 = { "LocalArt" };
+	constexpr SettingKey<int>  ScreenSaverTime          = { "ScreenSaverTime" };
+	constexpr SettingKey<int>  SystemSleepTime          = { "SystemSleepTime" };
+}
+
+//A setting resolved once, reading it afterwards is a plain load.
+//Stays valid as long as Settings exists, as entries are never removed once the defaults are set.
+template<typename T>
+class SettingHandle
+{
+public:
+	SettingHandle(const T* value) : mValue(value) { }
+
+	inline const T& get() const { return *mValue; }
+	inline operator const T&() const { return *mValue; }
+
+private:
+	const T* mValue;
+};
 
 //This is a singleton for storing settings.
 class Settings
@@ -28,7 +62,22 @@ public:
 	void setString(const std::string& name, const std::string& value);
 	void setMap(const std::string& name, const std::map<std::string, int>& map);
 
+	//Resolves the key once for hot paths instead of looking the setting up on every call.
+	template<typename T>
+	SettingHandle<T> getHandle(const SettingKey<T>& key);
+
+	//The callback is called after the value of the setting changed, until the owner is removed.
+	//Callbacks must not add or remove observers themselves.
+	void addObserver(const std::string& name, const void* owner, const std::function<void()>& callback);
+	void removeObserver(const void* owner);
+
 private:
+	struct Observer
+	{
+		const void* owner;
+		std::function<void()> callback;
+	};
+
 	static Settings* sInstance;
 
 	Settings();
@@ -37,12 +86,19 @@ private:
 	void processBackwardCompatibility();
 	template<typename Map>
 	void renameSetting(Map& map, std::string&& oldName, std::string&& newName);
+	void notifyObservers(const std::string& name);
 
 	std::map<std::string, bool> mBoolMap;
 	std::map<std::string, int> mIntMap;
 	std::map<std::string, float> mFloatMap;
 	std::map<std::string, std::string> mStringMap;
 	std::map<std::string, std::map<std::string, int>> mMapIntMap;
+	std::map<std::string, std::vector<Observer>> mObservers;
 };
 
+template<> SettingHandle<bool> Settings::getHandle(const SettingKey<bool>& key);
+template<> SettingHandle<int> Settings::getHandle(const SettingKey<int>& key);
+template<> SettingHandle<float> Settings::getHandle(const SettingKey<float>& key);
+template<> SettingHandle<std::string> Settings::getHandle(const SettingKey<std::string>& key);
+
 #endif // ES_CORE_SETTINGS_H
@@ -0,0 +1,157 @@
+#include "ThemeCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "Log.h"
+#include <pugixml.hpp>
+
+// expired elements are only dropped from the index every so often
+#define SWEEP_INTERVAL 1024
+
+ThemeCache* ThemeCache::sInstance = nullptr;
+
+void ThemeCache::init()
+{
+	if(!sInstance)
+		sInstance = new ThemeCache();
+
+} // init
+
+void ThemeCache::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+ThemeCache* ThemeCache::getInstance()
+{
+	if(!sInstance)
+		sInstance = new ThemeCache();
+
+	return sInstance;
+
+} // getInstance
+
+ThemeCache::ThemeCache() : mSharedSinceSweep(0), mParsed(0), mReused(0)
+{
+} // ThemeCache
+
+ThemeCache::~ThemeCache()
+{
+	LOG(LogDebug) << "ThemeCache: parsed " << mParsed << " theme files, reused " << mReused << " times";
+
+} // ~ThemeCache
+
+std::shared_ptr<const pugi::xml_document> ThemeCache::getDocument(const std::string& _path, std::string& _error)
+{
+	const time_t modTime = Utils::FileSystem::getModificationTime(_path);
+
+	std::shared_ptr<Document> entry;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		std::shared_ptr<Document>& slot = mDocuments[_path];
+		if(!slot)
+			slot = std::make_shared<Document>();
+
+		entry = slot;
+	}
+
+	// only this file is locked, the others can be parsed meanwhile
+	std::unique_lock<std::mutex> lock(entry->mutex);
+
+	if(entry->document && (entry->modTime == modTime))
+	{
+		std::unique_lock<std::mutex> statsLock(mMutex);
+		++mReused;
+		return entry->document;
+	}
+
+	std::shared_ptr<pugi::xml_document> document = std::make_shared<pugi::xml_document>();
+	pugi::xml_parse_result result = document->load_file(_path.c_str());
+	if(!result)
+	{
+		_error = result.description();
+		return nullptr;
+	}
+
+	entry->document = document;
+	entry->modTime  = modTime;
+
+	std::unique_lock<std::mutex> statsLock(mMutex);
+	++mParsed;
+	return entry->document;
+
+} // getDocument
+
+std::string ThemeCache::getKey(const ThemeData::ThemeElement& _element)
+{
+	// every value in its binary form, equal keys mean equal elements
+	std::string key = _element.type;
+	key += '\0';
+	key += _element.extra ? '1' : '0';
+
+	for(auto it = _element.properties.cbegin(); it != _element.properties.cend(); ++it)
+	{
+		const ThemeData::ThemeElement::Property& property = it->second;
+		const float values[7] = { property.r.x(), property.r.y(), property.r.z(), property.r.w(), property.v.x(), property.v.y(), property.f };
+
+		key += '\0';
+		key += it->first;
+		key += '\0';
+		key.append((const char*)values, sizeof(values));
+		key.append((const char*)&property.i, sizeof(property.i));
+		key += property.b ? '1' : '0';
+		key += std::to_string(property.s.size());
+		key += ':';
+		key += property.s;
+	}
+
+	return key;
+
+} // getKey
+
+std::shared_ptr<const ThemeData::ThemeElement> ThemeCache::share(const ThemeData::ThemeElement& _element)
+{
+	const std::string key = getKey(_element);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	std::weak_ptr<const ThemeData::ThemeElement>& slot = mElements[key];
+	std::shared_ptr<const ThemeData::ThemeElement> element = slot.lock();
+
+	if(!element)
+	{
+		element = std::make_shared<const ThemeData::ThemeElement>(_element);
+		slot = element;
+
+		if(++mSharedSinceSweep >= SWEEP_INTERVAL)
+		{
+			for(auto it = mElements.begin(); it != mElements.end(); )
+			{
+				if(it->second.expired())
+					it = mElements.erase(it);
+				else
+					++it;
+			}
+
+			mSharedSinceSweep = 0;
+		}
+	}
+
+	return element;
+
+} // share
+
+void ThemeCache::clear()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mDocuments.clear();
+	mElements.clear();
+	mSharedSinceSweep = 0;
+
+} // clear
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef ES_CORE_THEME_CACHE_H
+#define ES_CORE_THEME_CACHE_H
+
+#include "ThemeData.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+
+namespace pugi { class xml_document; }
+
+//
+// Shares what every theme loads alike between all systems.
+//
+// Theme files are parsed once and kept keyed by path and modification time, so the include shared by all
+// systems of a theme set is read once at startup instead of once per system, and not at all when the themes
+// are reloaded unless it was changed meanwhile. Only resolving the variables and merging the views is left
+// to each ThemeData. Elements resolving to the same values, most of those coming from the shared includes,
+// are held once and referenced by every theme using them.
+//
+// All functions are thread safe, the systems load their themes in parallel. A file is parsed by one thread
+// while others asking for it wait, different files are parsed at the same time.
+//
+class ThemeCache
+{
+public:
+
+	static void        init       ();
+	static void        deinit     ();
+	static ThemeCache* getInstance();
+
+	// Returns the parsed file, nullptr and the parser's description of the problem in _error if it could not be parsed
+	std::shared_ptr<const pugi::xml_document>      getDocument(const std::string& _path, std::string& _error);
+	// Returns an element holding the same values as _element, shared with every theme holding one alike
+	std::shared_ptr<const ThemeData::ThemeElement> share      (const ThemeData::ThemeElement& _element);
+	void                                           clear      ();
+
+private:
+
+	struct Document
+	{
+		std::shared_ptr<const pugi::xml_document> document;
+		time_t                                    modTime;
+		std::mutex                                mutex; // held while parsing
+	};
+
+	 ThemeCache();
+	~ThemeCache();
+
+	static std::string getKey(const ThemeData::ThemeElement& _element);
+
+	static ThemeCache* sInstance;
+
+	std::map<std::string, std::shared_ptr<Document>>                                mDocuments; // by path
+	std::unordered_map<std::string, std::weak_ptr<const ThemeData::ThemeElement>> mElements;  // by getKey()
+	size_t                                                                          mSharedSinceSweep;
+	unsigned int                                                                    mParsed;
+	unsigned int                                                                    mReused;
+	std::mutex                                                                      mMutex;
+
+}; // ThemeCache
+
+#endif // ES_CORE_THEME_CACHE_H
@@ -7,6 +7,7 @@
 #include "Log.h"
 #include "platform.h"
 #include "Settings.h"
+#include "ThemeCache.h"
 #include <pugixml.hpp>
 #include <algorithm>
 
@@ -236,16 +237,17 @@ void ThemeData::loadFile(std::map<std::string, std::string> sysDataMap, const st
 	mVersion = 0;
 	mResolution = { 1, 1 };
 	mViews.clear();
+	mParsedElements.clear();
 	mVariables.clear();
 
 	mVariables.insert(sysDataMap.cbegin(), sysDataMap.cend());
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = doc.load_file(path.c_str());
-	if(!res)
-		throw error << "XML parsing error: \n    " << res.description();
+	std::string parseError;
+	std::shared_ptr<const pugi::xml_document> doc = ThemeCache::getInstance()->getDocument(path, parseError);
+	if(!doc)
+		throw error << "XML parsing error: \n    " << parseError;
 
-	pugi::xml_node root = doc.child("theme");
+	pugi::xml_node root = doc->child("theme");
 	if(!root)
 		throw error << "Missing <theme> tag!";
 
@@ -278,6 +280,16 @@ void ThemeData::loadFile(std::map<std::string, std::string> sysDataMap, const st
 	parseIncludes(root);
 	parseViews(root);
 	parseFeatures(root);
+
+	// the merged elements are only kept once for all themes holding the same values
+	ThemeCache* cache = ThemeCache::getInstance();
+	for(auto viewIt = mParsedElements.cbegin(); viewIt != mParsedElements.cend(); viewIt++)
+	{
+		ThemeView& view = mViews[viewIt->first];
+		for(auto elemIt = viewIt->second.cbegin(); elemIt != viewIt->second.cend(); elemIt++)
+			view.elements[elemIt->first] = cache->share(elemIt->second);
+	}
+	mParsedElements.clear();
 }
 
 void ThemeData::parseIncludes(const pugi::xml_node& root)
@@ -296,12 +308,13 @@ void ThemeData::parseIncludes(const pugi::xml_node& root)
 
 		mPaths.push_back(path);
 
-		pugi::xml_document includeDoc;
-		pugi::xml_parse_result result = includeDoc.load_file(path.c_str());
-		if(!result)
-			throw error << "Error parsing file: \n    " << result.description();
+		// parsed once for all systems including it
+		std::string parseError;
+		std::shared_ptr<const pugi::xml_document> includeDoc = ThemeCache::getInstance()->getDocument(path, parseError);
+		if(!includeDoc)
+			throw error << "Error parsing file: \n    " << parseError;
 
-		pugi::xml_node theme = includeDoc.child("theme");
+		pugi::xml_node theme = includeDoc->child("theme");
 		if(!theme)
 			throw error << "Missing <theme> tag!";
 
@@ -378,13 +391,13 @@ void ThemeData::parseViews(const pugi::xml_node& root)
 			if (std::find(sSupportedViews.cbegin(), sSupportedViews.cend(), viewKey) != sSupportedViews.cend())
 			{
 				ThemeView& view = mViews.insert(std::pair<std::string, ThemeView>(viewKey, ThemeView())).first->second;
-				parseView(node, view);
+				parseView(node, view, mParsedElements[viewKey]);
 			}
 		}
 	}
 }
 
-void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view)
+void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view, std::map<std::string, ThemeElement>& elements)
 {
 	ThemeException error;
 	error.setFiles(mPaths);
@@ -409,7 +422,7 @@ void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view)
 			off = nameAttr.find_first_of(delim, prevOff);
 
 			parseElement(node, elemTypeIt->second,
-				view.elements.insert(std::pair<std::string, ThemeElement>(elemKey, ThemeElement())).first->second);
+				elements.insert(std::pair<std::string, ThemeElement>(elemKey, ThemeElement())).first->second);
 
 			if(std::find(view.orderedKeys.cbegin(), view.orderedKeys.cend(), elemKey) == view.orderedKeys.cend())
 				view.orderedKeys.push_back(elemKey);
@@ -567,14 +580,14 @@ const ThemeData::ThemeElement* ThemeData::getElement(const std::string& view, co
 	auto elemIt = viewIt->second.elements.find(element);
 	if(elemIt == viewIt->second.elements.cend()) return NULL;
 
-	if(elemIt->second.type != expectedType && !expectedType.empty())
+	if(elemIt->second->type != expectedType && !expectedType.empty())
 	{
 		LOG(LogWarning) << " requested mismatched theme type for [" << view << "." << element << "] - expected \""
-			<< expectedType << "\", got \"" << elemIt->second.type << "\"";
+			<< expectedType << "\", got \"" << elemIt->second->type << "\"";
 		return NULL;
 	}
 
-	return &elemIt->second;
+	return elemIt->second.get();
 }
 
 const std::shared_ptr<ThemeData>& ThemeData::getDefault()
@@ -612,7 +625,7 @@ std::vector<GuiComponent*> ThemeData::makeExtras(const std::shared_ptr<ThemeData
 
 	for(auto it = viewIt->second.orderedKeys.cbegin(); it != viewIt->second.orderedKeys.cend(); it++)
 	{
-		ThemeElement& elem = viewIt->second.elements.at(*it);
+		const ThemeElement& elem = *viewIt->second.elements.at(*it);
 		if(elem.extra)
 		{
 			GuiComponent* comp = NULL;
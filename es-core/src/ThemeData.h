@@ -95,6 +95,8 @@ public:
 
 		struct Property
 		{
+			Property() : r(0, 0, 0, 0), v(0, 0), i(0), f(0.0f), b(false) { }
+
 			void operator= (const Vector4f& value)     { r = value; v = Vector2f(value.x(), value.y()); }
 			void operator= (const Vector2f& value)     { v = value; }
 			void operator= (const std::string& value)  { s = value; }
@@ -131,7 +133,7 @@ private:
 	class ThemeView
 	{
 	public:
-		std::map<std::string, ThemeElement> elements;
+		std::map<std::string, std::shared_ptr<const ThemeElement>> elements; // shared with other themes, see ThemeCache
 		std::vector<std::string> orderedKeys;
 	};
 
@@ -181,10 +183,11 @@ private:
 	void parseIncludes(const pugi::xml_node& themeRoot);
 	void parseVariables(const pugi::xml_node& root);
 	void parseViews(const pugi::xml_node& themeRoot);
-	void parseView(const pugi::xml_node& viewNode, ThemeView& view);
+	void parseView(const pugi::xml_node& viewNode, ThemeView& view, std::map<std::string, ThemeElement>& elements);
 	void parseElement(const pugi::xml_node& elementNode, const std::map<std::string, ElementPropertyType>& typeMap, ThemeElement& element);
 
 	std::map<std::string, ThemeView> mViews;
+	std::map<std::string, std::map<std::string, ThemeElement>> mParsedElements; // by view, while loading
 
 	std::string resolvePlaceholders(const char* in);
 	std::map<std::string, std::string> mVariables;
@@ -0,0 +1,341 @@
+#include "VideoMetaDataCache.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include <pugixml.hpp>
+#include <vlc/vlc.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define PARSE_TIMEOUT_MS 10000
+#define MAX_ENTRIES      8192
+#define MAX_AGE_SECONDS  (90 * 24 * 60 * 60)
+
+VideoMetaDataCache* VideoMetaDataCache::sInstance = nullptr;
+
+void VideoMetaDataCache::init()
+{
+	if(!sInstance)
+		sInstance = new VideoMetaDataCache();
+
+} // init
+
+void VideoMetaDataCache::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+VideoMetaDataCache* VideoMetaDataCache::getInstance()
+{
+	if(!sInstance)
+		sInstance = new VideoMetaDataCache();
+
+	return sInstance;
+
+} // getInstance
+
+VideoMetaDataCache::VideoMetaDataCache() : mVLC(nullptr), mExit(false), mDirty(false)
+{
+	load();
+	mThread = new std::thread(&VideoMetaDataCache::threadProc, this);
+
+} // VideoMetaDataCache
+
+VideoMetaDataCache::~VideoMetaDataCache()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mProbeQ.clear();
+		mProbeLookup.clear();
+		mExit = true;
+	}
+	mEvent.notify_one();
+	mThread->join();
+	delete mThread;
+
+	save();
+
+} // ~VideoMetaDataCache
+
+std::string VideoMetaDataCache::getCachePath()
+{
+	return Utils::FileSystem::getHomePath() + "/.emulationstation/video_metadata.xml";
+
+} // getCachePath
+
+bool VideoMetaDataCache::get(const std::string& _path, VideoMetaData* _metaData)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto it = mEntries.find(_path);
+	if(it == mEntries.cend())
+		return false;
+
+	// entries loaded from disk are used right away but checked for changes in the background
+	if(!it->second.verified)
+		queue(_path);
+
+	// only a day's worth of change is worth writing the cache again for
+	const time_t now = time(nullptr);
+	if((now - it->second.lastUsed) > (24 * 60 * 60))
+		mDirty = true;
+
+	it->second.lastUsed = now;
+	*_metaData = it->second.metaData;
+	return true;
+
+} // get
+
+void VideoMetaDataCache::probe(const std::string& _path, libvlc_instance_t* _vlc)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if(!mVLC)
+		mVLC = _vlc;
+
+	queue(_path);
+
+} // probe
+
+void VideoMetaDataCache::queue(const std::string& _path)
+{
+	// mMutex must be held by the caller
+	auto it = mProbeLookup.find(_path);
+	if(it != mProbeLookup.cend())
+	{
+		mProbeQ.erase(it->second);
+		mProbeLookup.erase(it);
+	}
+
+	// the most recently requested video is the one the user is looking at, handle it first
+	mProbeQ.push_front(_path);
+	mProbeLookup[_path] = mProbeQ.cbegin();
+	mEvent.notify_one();
+
+} // queue
+
+void VideoMetaDataCache::threadProc()
+{
+	while(true)
+	{
+		std::string        path;
+		libvlc_instance_t* vlc;
+		Entry              entry;
+		bool               known;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEvent.wait(lock, [this] { return mExit || !mProbeQ.empty(); });
+
+			if(mExit)
+				return;
+
+			path = mProbeQ.front();
+			mProbeQ.pop_front();
+			mProbeLookup.erase(path);
+
+			vlc = mVLC;
+
+			auto it = mEntries.find(path);
+			known = (it != mEntries.cend());
+			if(known)
+				entry = it->second;
+		}
+
+		const time_t modTime = Utils::FileSystem::getModificationTime(path);
+
+		// unchanged since it was last parsed, just remember that it has been checked
+		if(known && !entry.failed && (entry.modTime == modTime))
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mEntries[path].verified = true;
+			continue;
+		}
+
+		if(!vlc)
+			continue;
+
+		VideoMetaData metaData = { 0, 0, -1 };
+		const bool    parsed   = parse(path, vlc, &metaData);
+
+		if(!parsed && mExit)
+			return;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		Entry& newEntry   = mEntries[path];
+		newEntry.metaData = metaData;
+		newEntry.modTime  = modTime;
+		newEntry.verified = true;
+		newEntry.failed   = !parsed;
+		newEntry.lastUsed = time(nullptr);
+		mDirty            = true;
+
+		// pruned in batches, not for every new entry
+		if(mEntries.size() > (MAX_ENTRIES + (MAX_ENTRIES / 8)))
+			prune();
+	}
+
+} // threadProc
+
+void VideoMetaDataCache::prune()
+{
+	// mMutex must be held by the caller
+	std::vector<std::pair<time_t, std::string>> byAge;
+	byAge.reserve(mEntries.size());
+
+	for(auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+		byAge.push_back(std::make_pair(it->second.lastUsed, it->first));
+
+	const size_t dropped = byAge.size() - MAX_ENTRIES;
+	std::nth_element(byAge.begin(), byAge.begin() + dropped, byAge.end());
+
+	for(size_t i = 0; i < dropped; ++i)
+		mEntries.erase(byAge[i].second);
+
+	mDirty = true;
+
+	LOG(LogDebug) << "VideoMetaDataCache: dropped " << dropped << " least recently used entries";
+
+} // prune
+
+bool VideoMetaDataCache::parse(const std::string& _path, libvlc_instance_t* _vlc, VideoMetaData* _metaData)
+{
+#if defined(_WIN32)
+	const std::string path(Utils::String::replace(_path, "/", "\\"));
+#else // _WIN32
+	const std::string path(_path);
+#endif // !_WIN32
+
+	libvlc_media_t* media = libvlc_media_new_path(_vlc, path.c_str());
+	if(!media)
+		return false;
+
+	libvlc_media_parse_with_options(media, libvlc_media_fetch_local, PARSE_TIMEOUT_MS);
+	while((libvlc_media_get_parsed_status(media) == 0) && !mExit)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	if(mExit)
+	{
+		libvlc_media_parse_stop(media);
+		libvlc_media_release(media);
+		return false;
+	}
+
+	libvlc_media_track_t** tracks;
+	const unsigned         trackCount = libvlc_media_tracks_get(media, &tracks);
+	for(unsigned track = 0; track < trackCount; ++track)
+	{
+		if(tracks[track]->i_type == libvlc_track_video)
+		{
+			_metaData->width  = tracks[track]->video->i_width;
+			_metaData->height = tracks[track]->video->i_height;
+			break;
+		}
+	}
+	libvlc_media_tracks_release(tracks, trackCount);
+
+	_metaData->duration = (int)libvlc_media_get_duration(media);
+	libvlc_media_release(media);
+
+	if((_metaData->width == 0) || (_metaData->height == 0))
+	{
+		LOG(LogWarning) << "VideoMetaDataCache: no video track found in \"" << _path << "\"";
+		return false;
+	}
+
+	return true;
+
+} // parse
+
+void VideoMetaDataCache::load()
+{
+	const std::string path = getCachePath();
+
+	if(!Utils::FileSystem::exists(path))
+		return;
+
+	pugi::xml_document     doc;
+	pugi::xml_parse_result result = doc.load_file(path.c_str());
+
+	if(!result)
+	{
+		LOG(LogError) << "Error parsing video metadata cache \"" << path << "\"!\n	" << result.description();
+		return;
+	}
+
+	const time_t now     = time(nullptr);
+	size_t       expired = 0;
+
+	for(pugi::xml_node node = doc.child("videos").child("video"); node; node = node.next_sibling("video"))
+	{
+		Entry entry;
+		entry.metaData.width    = node.attribute("width").as_uint();
+		entry.metaData.height   = node.attribute("height").as_uint();
+		entry.metaData.duration = node.attribute("duration").as_int(-1);
+		entry.modTime           = (time_t)node.attribute("modtime").as_llong();
+		entry.verified          = false;
+		entry.failed            = false;
+		entry.lastUsed          = (time_t)node.attribute("used").as_llong((long long)now);
+
+		// videos not shown for months are likely gone, they are parsed again if they show up
+		if((now - entry.lastUsed) > MAX_AGE_SECONDS)
+		{
+			++expired;
+			continue;
+		}
+
+		if((entry.metaData.width > 0) && (entry.metaData.height > 0))
+			mEntries[node.attribute("path").as_string()] = entry;
+	}
+
+	// the expired entries are left out of the next save
+	if(expired)
+		mDirty = true;
+
+	if(mEntries.size() > MAX_ENTRIES)
+		prune();
+
+	LOG(LogInfo) << "Loaded " << mEntries.size() << " cached video dimensions from \"" << path << "\"";
+
+} // load
+
+void VideoMetaDataCache::save()
+{
+	pugi::xml_document doc;
+	pugi::xml_node     root = doc.append_child("videos");
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		if(!mDirty)
+			return;
+
+		for(auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+		{
+			if(it->second.failed)
+				continue;
+
+			pugi::xml_node node = root.append_child("video");
+			node.append_attribute("path").set_value(it->first.c_str());
+			node.append_attribute("width").set_value(it->second.metaData.width);
+			node.append_attribute("height").set_value(it->second.metaData.height);
+			node.append_attribute("duration").set_value(it->second.metaData.duration);
+			node.append_attribute("modtime").set_value((long long)it->second.modTime);
+			node.append_attribute("used").set_value((long long)it->second.lastUsed);
+		}
+
+		mDirty = false;
+	}
+
+	const std::string path = getCachePath();
+	if(!doc.save_file(path.c_str()))
+		LOG(LogError) << "Error saving video metadata cache \"" << path << "\"";
+
+} // save
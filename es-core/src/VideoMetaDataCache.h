@@ -0,0 +1,86 @@
+#pragma once
+#ifndef ES_CORE_VIDEO_META_DATA_CACHE_H
+#define ES_CORE_VIDEO_META_DATA_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <time.h>
+
+struct libvlc_instance_t;
+
+//
+// Caches the track dimensions and duration of video files so playback can be
+// started without parsing the media on the UI thread.
+//
+// Lookups through get() only ever touch memory. Unknown paths are handed to
+// probe(), which parses the media on a background thread; once it is done the
+// result becomes available through get(). Results are persisted to
+// ~/.emulationstation/video_metadata.xml and entries loaded from there are
+// re-validated against the file modification time in the background on first use.
+// The least recently used entries are dropped once there are too many of them,
+// entries not used for a long time are not loaded again.
+//
+class VideoMetaDataCache
+{
+public:
+
+	struct VideoMetaData
+	{
+		unsigned width;
+		unsigned height;
+		int      duration; // in ms, -1 if unknown
+	};
+
+	static void                init       ();
+	static void                deinit     ();
+	static VideoMetaDataCache* getInstance();
+
+	// Returns true and fills _metaData if the video has been probed already, never blocks on I/O
+	bool get  (const std::string& _path, VideoMetaData* _metaData);
+	// Queues the video for parsing on the background thread, newest requests are handled first
+	void probe(const std::string& _path, libvlc_instance_t* _vlc);
+	void save ();
+
+private:
+
+	struct Entry
+	{
+		VideoMetaData metaData;
+		time_t        modTime;
+		bool          verified; // modification time checked during this session
+		bool          failed;   // parsing failed, not persisted so it is retried next session
+		time_t        lastUsed;
+	};
+
+	 VideoMetaDataCache();
+	~VideoMetaDataCache();
+
+	static std::string getCachePath();
+
+	void load      ();
+	void threadProc();
+	void queue     (const std::string& _path);
+	void prune     ();
+	bool parse     (const std::string& _path, libvlc_instance_t* _vlc, VideoMetaData* _metaData);
+
+	static VideoMetaDataCache* sInstance;
+
+	std::map<std::string, Entry>                                  mEntries;
+	std::list<std::string>                                        mProbeQ;
+	std::map<std::string, std::list<std::string>::const_iterator> mProbeLookup;
+
+	libvlc_instance_t*      mVLC;
+	std::thread*            mThread;
+	std::mutex              mMutex;
+	std::condition_variable mEvent;
+	std::atomic<bool>       mExit; // also polled while parsing, without mMutex
+	bool                    mDirty;
+
+}; // VideoMetaDataCache
+
+#endif // ES_CORE_VIDEO_META_DATA_CACHE_H
@@ -4,24 +4,38 @@
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
 #include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/ProfilingUtil.h"
+#include "utils/TimeUtil.h"
 #include "Log.h"
 #include "Scripting.h"
 #include <algorithm>
 #include <iomanip>
+#include <SDL_timer.h>
 
 #ifdef WIN32
 #include <SDL_events.h>
 #endif
 
+std::atomic<bool> Window::sInvalidated(true);
+
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-	mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL)
+	mAllowSleep(true), mSleeping(false), mSuspended(false), mResumeStart(0), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mInfoPopup(NULL),
+	mDrawFramerate(Settings::getInstance()->getHandle(SettingKeys::DrawFramerate)),
+	mScreenSaverTime(Settings::getInstance()->getHandle(SettingKeys::ScreenSaverTime)),
+	mSystemSleepTime(Settings::getInstance()->getHandle(SettingKeys::SystemSleepTime))
 {
 	mHelp = new HelpComponent(this);
 	mBackgroundOverlay = new ImageComponent(this);
+
+	// the framerate display has to appear or vanish even if nothing else changes
+	Settings::getInstance()->addObserver(SettingKeys::DrawFramerate.name, this, [] { invalidate(); });
 }
 
 Window::~Window()
 {
+	Settings::getInstance()->removeObserver(this);
+
 	delete mBackgroundOverlay;
 
 	// delete all our GUIs
@@ -40,6 +54,7 @@ void Window::pushGui(GuiComponent* gui)
 	}
 	mGuiStack.push_back(gui);
 	gui->updateHelpPrompts();
+	invalidate();
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -49,6 +64,7 @@ void Window::removeGui(GuiComponent* gui)
 		if(*i == gui)
 		{
 			i = mGuiStack.erase(i);
+			invalidate();
 
 			if(i == mGuiStack.cend() && mGuiStack.size()) // we just popped the stack and the stack is not empty
 			{
@@ -71,6 +87,12 @@ GuiComponent* Window::peekGui()
 
 bool Window::init()
 {
+	if(mSuspended)
+	{
+		mResumeStart = SDL_GetTicks();
+		mSuspended = false;
+	}
+
 	if(!Renderer::init())
 	{
 		LOG(LogError) << "Renderer failed to initialize!";
@@ -94,28 +116,40 @@ bool Window::init()
 	if(peekGui())
 		peekGui()->updateHelpPrompts();
 
+	invalidate();
+
 	return true;
 }
 
-void Window::deinit()
+void Window::deinit(bool suspend)
 {
 	// Hide all GUI elements on uninitialisation - this disable
 	for(auto i = mGuiStack.cbegin(); i != mGuiStack.cend(); i++)
 	{
 		(*i)->onHide();
 	}
-	ResourceManager::getInstance()->unloadAll();
+
+	if(suspend)
+		ResourceManager::getInstance()->suspendAll((size_t)Settings::getInstance()->getInt("SuspendMemoryBudget") * 1024 * 1024);
+	else
+		ResourceManager::getInstance()->unloadAll();
+
+	mSuspended = suspend;
 	Renderer::deinit();
 }
 
 void Window::textInput(const char* text)
 {
+	invalidate();
+
 	if(peekGui())
 		peekGui()->textInput(text);
 }
 
 void Window::input(InputConfig* config, Input input)
 {
+	invalidate();
+
 	if (mScreenSaver && mScreenSaver->isScreenSaverActive() && Settings::getInstance()->getBool("ScreenSaverControls")
 		&& mScreenSaver->inputDuringScreensaver(config, input))
 	{
@@ -151,6 +185,12 @@ void Window::input(InputConfig* config, Input input)
 		// toggle TextComponent debug view with Ctrl-I
 		Settings::getInstance()->setBool("DebugImage", !Settings::getInstance()->getBool("DebugImage"));
 	}
+	else if (dbg_keyboard_key_press && input.id == SDLK_p && SDL_GetModState() & KMOD_LCTRL)
+	{
+		// dump the recently recorded profiling zones as a Chrome trace with Ctrl-P
+		const std::string path = Utils::FileSystem::getHomePath() + "/.emulationstation/trace_" + Utils::Time::timeToString(Utils::Time::now()) + ".json";
+		Utils::Profiling::dumpTrace(path, (unsigned int)Settings::getInstance()->getInt("ProfilerTraceWindow"));
+	}
 	else if (peekGui())
 	{
 		this->peekGui()->input(config, input); // this is where the majority of inputs will be consumed: the GuiComponent Stack
@@ -159,6 +199,8 @@ void Window::input(InputConfig* config, Input input)
 
 void Window::update(int deltaTime)
 {
+	ProfileZone("update");
+
 	if(mNormalizeNextUpdate)
 	{
 		mNormalizeNextUpdate = false;
@@ -172,7 +214,7 @@ void Window::update(int deltaTime)
 	{
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
 
-		if(Settings::getInstance()->getBool("DrawFramerate"))
+		if(mDrawFramerate)
 		{
 			std::stringstream ss;
 
@@ -188,6 +230,8 @@ void Window::update(int deltaTime)
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb <<
 				  " Tex Max: " << textureTotalUsageMb;
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
+			updateProfilerBars();
+			invalidate();
 		}
 
 		mFrameTimeElapsed = 0;
@@ -202,10 +246,45 @@ void Window::update(int deltaTime)
 	// Update the screensaver
 	if (mScreenSaver)
 		mScreenSaver->update(deltaTime);
+
+	// the timeouts are checked here rather than in render() as rendering is skipped while idle
+	unsigned int screensaverTime = (unsigned int)mScreenSaverTime.get();
+	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
+	{
+		startScreenSaver();
+
+		unsigned int systemSleepTime = (unsigned int)mSystemSleepTime.get();
+		if(!isProcessing() && mAllowSleep && systemSleepTime != 0 && mTimeSinceLastInput >= systemSleepTime) {
+			mSleeping = true;
+			onSleep();
+		}
+	}
+}
+
+void Window::invalidate()
+{
+	sInvalidated = true;
+}
+
+bool Window::isRenderRequired()
+{
+	if(mSleeping)
+		return false;
+
+	// always clear the flag so changes made during this frame's update are not lost for the next one
+	bool required = sInvalidated.exchange(false);
+
+	// the framerate display measures the rendering itself, the screensaver and popups draw on their own timelines
+	if(mDrawFramerate || mInfoPopup || mRenderScreenSaver || (mScreenSaver && mScreenSaver->isScreenSaverActive()))
+		required = true;
+
+	return required;
 }
 
 void Window::render()
 {
+	ProfileZone("render");
+
 	Transform4x4f transform = Transform4x4f::Identity();
 
 	mRenderedHelpPrompts = false;
@@ -227,15 +306,18 @@ void Window::render()
 	if(!mRenderedHelpPrompts)
 		mHelp->render(transform);
 
-	if(Settings::getInstance()->getBool("DrawFramerate") && mFrameDataText)
+	if(mDrawFramerate && mFrameDataText)
 	{
 		Renderer::setMatrix(Transform4x4f::Identity());
 		mDefaultFonts.at(1)->renderTextCache(mFrameDataText.get());
-	}
 
-	unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
-	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
-		startScreenSaver();
+		for(auto it = mProfilerBars.cbegin(); it != mProfilerBars.cend(); it++)
+		{
+			Renderer::drawRect(it->x, it->y, it->w, it->h, it->color, it->color);
+			if(it->label)
+				mDefaultFonts.at(0)->renderTextCache(it->label.get());
+		}
+	}
 
 	// Always call the screensaver render function regardless of whether the screensaver is active
 	// or not because it may perform a fade on transition
@@ -246,13 +328,50 @@ void Window::render()
 		mInfoPopup->render(transform);
 	}
 
-	if(mTimeSinceLastInput >= screensaverTime && screensaverTime != 0)
+	// complete once no image on display is waiting to be loaded anymore
+	if(mResumeStart && !TextureResource::isLoading())
 	{
-		unsigned int systemSleepTime = (unsigned int)Settings::getInstance()->getInt("SystemSleepTime");
-		if(!isProcessing() && mAllowSleep && systemSleepTime != 0 && mTimeSinceLastInput >= systemSleepTime) {
-			mSleeping = true;
-			onSleep();
-		}
+		LOG(LogInfo) << "Window: first complete frame " << (SDL_GetTicks() - mResumeStart) << "ms after resuming";
+		mResumeStart = 0;
+	}
+}
+
+void Window::updateProfilerBars()
+{
+	static const unsigned int colors[] = { 0x2E7D32C0, 0x1565C0C0, 0xEF6C00C0, 0x6A1B9AC0, 0xC62828C0 };
+
+	mProfilerBars.clear();
+
+	std::vector<Utils::Profiling::ZoneRecord> zones;
+	if(!Utils::Profiling::getLastZone("frame", &zones))
+		return;
+
+	// the full width stands for the duration of the frame but at least one 60Hz refresh
+	const auto&    font      = mDefaultFonts.at(0);
+	const uint64_t frameTime = std::max(zones.front().timeEnd - zones.front().timeBegin, (uint64_t)16667);
+	const float    left      = 50.0f;
+	const float    top       = 60.0f + mFrameDataText->metrics.size.y();
+	const float    width     = Renderer::getScreenWidth() - left * 2;
+	const float    height    = font->getHeight(1.2f);
+
+	for(auto it = zones.cbegin(); it != zones.cend(); it++)
+	{
+		ProfilerBar bar;
+		bar.x     = left + width * (float)(it->timeBegin - zones.front().timeBegin) / frameTime;
+		bar.y     = top + height * it->depth;
+		bar.w     = std::max(width * (float)(it->timeEnd - it->timeBegin) / frameTime, 1.0f);
+		bar.h     = height - 2.0f;
+		bar.color = colors[it->depth % (sizeof(colors) / sizeof(colors[0]))];
+
+		std::stringstream ss;
+		ss << it->name << " " << std::fixed << std::setprecision(2) << ((it->timeEnd - it->timeBegin) / 1000.0f) << "ms";
+
+		// only label the bars that are wide enough to hold it
+		bar.label = std::unique_ptr<TextCache>(font->buildTextCache(ss.str(), bar.x + 2.0f, bar.y, 0xFFFFFFFF));
+		if(bar.label->metrics.size.x() > bar.w - 4.0f)
+			bar.label.reset();
+
+		mProfilerBars.push_back(std::move(bar));
 	}
 }
 
@@ -389,6 +508,7 @@ void Window::setHelpPrompts(const std::vector<HelpPrompt>& prompts, const HelpSt
 	});
 
 	mHelp->setPrompts(addPrompts);
+	invalidate();
 }
 
 
@@ -411,6 +531,7 @@ void Window::onSleep()
 void Window::onWake()
 {
 	Scripting::fireEvent("wake");
+	invalidate();
 }
 
 bool Window::isProcessing()
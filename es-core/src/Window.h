@@ -6,6 +6,7 @@
 #include "InputConfig.h"
 #include "Settings.h"
 
+#include <atomic>
 #include <memory>
 
 class SystemData;
@@ -55,8 +56,15 @@ public:
 	void update(int deltaTime);
 	void render();
 
+	// Marks the scene as changed so the next frame gets drawn, may be called from any thread
+	static void invalidate();
+	// Returns true if the last frame is outdated and render() needs to be called
+	bool isRenderRequired();
+
 	bool init();
-	void deinit();
+	// With suspend the decoded images and glyphs on display stay in RAM, up to the SuspendMemoryBudget setting,
+	// so the next init() gets the screen back without decoding and rendering them again, e.g. around a game
+	void deinit(bool suspend = false);
 
 	void normalizeNextUpdate();
 
@@ -84,6 +92,9 @@ private:
 	// Returns true if at least one component on the stack is processing
 	bool isProcessing();
 
+	// Rebuilds the flame view of the last completed frame shown below the framerate
+	void updateProfilerBars();
+
 	HelpComponent*	mHelp;
 	ImageComponent* mBackgroundOverlay;
 	ScreenSaver*	mScreenSaver;
@@ -100,13 +111,33 @@ private:
 
 	std::unique_ptr<TextCache> mFrameDataText;
 
+	struct ProfilerBar
+	{
+		float                      x;
+		float                      y;
+		float                      w;
+		float                      h;
+		unsigned int               color;
+		std::unique_ptr<TextCache> label;
+	};
+
+	std::vector<ProfilerBar> mProfilerBars;
+
 	bool mNormalizeNextUpdate;
 
 	bool mAllowSleep;
 	bool mSleeping;
+	bool mSuspended;
+	unsigned int mResumeStart; // when init() after a suspend started, until the first complete frame
 	unsigned int mTimeSinceLastInput;
 
 	bool mRenderedHelpPrompts;
+
+	SettingHandle<bool> mDrawFramerate;
+	SettingHandle<int> mScreenSaverTime;
+	SettingHandle<int> mSystemSleepTime;
+
+	static std::atomic<bool> sInvalidated;
 };
 
 #endif // ES_CORE_WINDOW_H
@@ -1,6 +1,7 @@
 #include "animations/AnimationController.h"
 
 #include "animations/Animation.h"
+#include "Window.h"
 
 AnimationController::AnimationController(Animation* anim, int delay, std::function<void()> finishedCallback, bool reverse)
 	: mAnimation(anim), mFinishedCallback(finishedCallback), mReverse(reverse), mTime(-delay), mDelay(delay)
@@ -30,6 +31,7 @@ bool AnimationController::update(int deltaTime)
 		t = 0.0f;
 
 	mAnimation->apply(mReverse ? 1.0f - t : t);
+	Window::invalidate();
 
 	if(t == 1.0f)
 		return true;
@@ -3,6 +3,7 @@
 #include "components/ImageComponent.h"
 #include "resources/ResourceManager.h"
 #include "Log.h"
+#include "Window.h"
 
 AnimatedImageComponent::AnimatedImageComponent(Window* window) : GuiComponent(window), mEnabled(false)
 {
@@ -76,6 +77,7 @@ void AnimatedImageComponent::update(int deltaTime)
 		}
 
 		mFrameAccumulator -= mFrames.at(mCurrentFrame).second;
+		Window::invalidate();
 	}
 }
 
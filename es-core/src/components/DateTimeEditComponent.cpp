@@ -3,6 +3,7 @@
 #include "DateTimeComponent.h"
 #include "resources/Font.h"
 #include "utils/StringUtil.h"
+#include "Window.h"
 
 DateTimeEditComponent::DateTimeEditComponent(Window* window, DisplayMode dispMode) : GuiComponent(window),
 	mEditing(false), mEditIndex(0), mDisplayMode(dispMode), mRelativeUpdateAccumulator(0),
@@ -242,6 +243,8 @@ std::shared_ptr<Font> DateTimeEditComponent::getFont() const
 
 void DateTimeEditComponent::updateTextCache()
 {
+	Window::invalidate();
+
 	DisplayMode mode = getCurrentDisplayMode();
 	const std::string dispString = mUppercase ? Utils::String::toUpper(getDisplayString(mode)) : getDisplayString(mode);
 	std::shared_ptr<Font> font = getFont();
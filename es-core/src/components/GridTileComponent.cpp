@@ -4,7 +4,14 @@
 #include "resources/TextureResource.h"
 #include "ThemeData.h"
 
-GridTileComponent::GridTileComponent(Window* window) : GuiComponent(window), mBackground(window, ":/frame.png")
+static bool isEqual(const GridTileProperties& a, const GridTileProperties& b)
+{
+	return a.mSize == b.mSize && a.mPadding == b.mPadding && a.mImageColor == b.mImageColor &&
+		a.mBackgroundImage == b.mBackgroundImage && a.mBackgroundCornerSize == b.mBackgroundCornerSize &&
+		a.mBackgroundCenterColor == b.mBackgroundCenterColor && a.mBackgroundEdgeColor == b.mBackgroundEdgeColor;
+}
+
+GridTileComponent::GridTileComponent(Window* window) : GuiComponent(window), mBackground(window, ":/frame.png"), mPropertiesApplied(false)
 {
 	mDefaultProperties.mSize = getDefaultTileSize();
 	mDefaultProperties.mPadding = Vector2f(16.0f, 16.0f);
@@ -51,6 +58,15 @@ void GridTileComponent::update(int deltaTime)
 
 	calcCurrentProperties();
 
+	// reapplying unchanged properties would mark the scene dirty on every frame
+	const Vector2i textureSize = mImage->getTextureSize();
+	if(mPropertiesApplied && isEqual(mCurrentProperties, mAppliedProperties) && textureSize == mAppliedTextureSize)
+		return;
+
+	mAppliedProperties = mCurrentProperties;
+	mAppliedTextureSize = textureSize;
+	mPropertiesApplied = true;
+
 	mBackground.setImagePath(mCurrentProperties.mBackgroundImage);
 
 	mImage->setColorShift(mCurrentProperties.mImageColor);
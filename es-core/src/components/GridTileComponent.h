@@ -56,6 +56,9 @@ private:
 	GridTileProperties mDefaultProperties;
 	GridTileProperties mSelectedProperties;
 	GridTileProperties mCurrentProperties;
+	GridTileProperties mAppliedProperties;
+	Vector2i mAppliedTextureSize;
+	bool mPropertiesApplied;
 
 	float mSelectedZoomPercent;
 	bool mSelected;
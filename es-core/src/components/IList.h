@@ -5,6 +5,10 @@
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
 #include "PowerSaver.h"
+#include "Window.h"
+#include <algorithm>
+#include <functional>
+#include <map>
 
 enum CursorState
 {
@@ -46,6 +50,9 @@ const ScrollTier SLOW_SCROLL_TIERS[] = {
 };
 const ScrollTierList LIST_SCROLL_STYLE_SLOW = { 2, SLOW_SCROLL_TIERS };
 
+// entries of a virtual list further than this from the cursor are dropped, they are materialised again when needed
+const int LIST_MATERIALIZED_MARGIN = 64;
+
 template <typename EntryData, typename UserData>
 class IList : public GuiComponent
 {
@@ -57,6 +64,9 @@ public:
 		EntryData data;
 	};
 
+	// fills in name and data of an entry from its object
+	typedef std::function<void(Entry& entry)> MaterializeFunc;
+
 protected:
 	struct Entry mEntry;
 
@@ -79,6 +89,11 @@ protected:
 
 	std::vector<Entry> mEntries;
 
+	// a virtual list only holds the objects, the entries around the cursor are materialised on demand
+	std::vector<UserData> mObjects;
+	MaterializeFunc mMaterialize;
+	std::map<int, Entry> mMaterialized; // by index
+
 public:
 	IList(Window* window, const ScrollTierList& tierList = LIST_SCROLL_STYLE_QUICK, const ListLoopType& loopType = LIST_PAUSE_AT_END) : GuiComponent(window),
 		mGradient(window), mTierList(tierList), mLoopType(loopType)
@@ -122,6 +137,9 @@ public:
 	void clear()
 	{
 		mEntries.clear();
+		mObjects.clear();
+		mMaterialize = nullptr;
+		mMaterialized.clear();
 		mCursor = 0;
 		listInput(0);
 		onCursorChanged(CURSOR_STOPPED);
@@ -130,13 +148,29 @@ public:
 	inline const std::string& getSelectedName()
 	{
 		assert(size() > 0);
-		return mEntries.at(mCursor).name;
+		return getEntryAt(mCursor).name;
 	}
 
 	inline const UserData& getSelected() const
 	{
 		assert(size() > 0);
-		return mEntries.at(mCursor).object;
+		return getObjectAt(mCursor);
+	}
+
+	inline int getCursorIndex() const { return mCursor; }
+
+	inline const UserData& getObjectAt(int index) const
+	{
+		return mMaterialize ? mObjects.at(index) : mEntries.at(index).object;
+	}
+
+	// Replaces the entries by objects, materialize fills in the entries when they get near the cursor.
+	// Makes a list of thousands of objects as cheap as the few entries on display.
+	void setObjects(const std::vector<UserData>& objects, const MaterializeFunc& materialize)
+	{
+		clear();
+		mObjects = objects;
+		mMaterialize = materialize;
 	}
 
 	void setCursor(typename std::vector<Entry>::const_iterator& it)
@@ -149,6 +183,17 @@ public:
 	// returns true if successful (select is in our list), false if not
 	bool setCursor(const UserData& obj)
 	{
+		if(mMaterialize)
+		{
+			auto it = std::find(mObjects.cbegin(), mObjects.cend(), obj);
+			if(it == mObjects.cend())
+				return false;
+
+			mCursor = (int)(it - mObjects.cbegin());
+			onCursorChanged(CURSOR_STOPPED);
+			return true;
+		}
+
 		for(auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
 		{
 			if((*it).object == obj)
@@ -175,11 +220,37 @@ public:
 	// entry management
 	void add(const Entry& e)
 	{
+		if(mMaterialize)
+		{
+			mMaterialized[(int)mObjects.size()] = e;
+			mObjects.push_back(e.object);
+			return;
+		}
+
 		mEntries.push_back(e);
 	}
 
 	bool remove(const UserData& obj)
 	{
+		if(mMaterialize)
+		{
+			auto it = std::find(mObjects.cbegin(), mObjects.cend(), obj);
+			if(it == mObjects.cend())
+				return false;
+
+			const int index = (int)(it - mObjects.cbegin());
+			if(mCursor > 0 && index <= mCursor)
+			{
+				mCursor--;
+				onCursorChanged(CURSOR_STOPPED);
+			}
+
+			// the indices behind it shift, only the ones before stay valid
+			mObjects.erase(it);
+			mMaterialized.erase(mMaterialized.lower_bound(index), mMaterialized.end());
+			return true;
+		}
+
 		for(auto it = mEntries.cbegin(); it != mEntries.cend(); it++)
 		{
 			if((*it).object == obj)
@@ -192,9 +263,45 @@ public:
 		return false;
 	}
 
-	inline int size() const { return (int)mEntries.size(); }
+	inline int size() const { return mMaterialize ? (int)mObjects.size() : (int)mEntries.size(); }
 
 protected:
+	Entry& getEntryAt(int index)
+	{
+		if(!mMaterialize)
+			return mEntries.at(index);
+
+		auto it = mMaterialized.find(index);
+		if(it != mMaterialized.end())
+			return it->second;
+
+		// recycle what scrolled out of reach before materialising more
+		if((int)mMaterialized.size() >= LIST_MATERIALIZED_MARGIN * 4)
+		{
+			for(auto old = mMaterialized.begin(); old != mMaterialized.end(); )
+			{
+				int distance = abs(old->first - mCursor);
+				distance = std::min(distance, size() - distance); // looping lists wrap around
+
+				if(distance > LIST_MATERIALIZED_MARGIN)
+					old = mMaterialized.erase(old);
+				else
+					++old;
+			}
+		}
+
+		Entry& entry = mMaterialized[index];
+		entry.object = mObjects.at(index);
+		mMaterialize(entry);
+		return entry;
+	}
+
+	// drops the materialised entries, e.g. when what materialize fills in changed
+	void resetMaterialized()
+	{
+		mMaterialized.clear();
+	}
+
 	void remove(typename std::vector<Entry>::const_iterator& it)
 	{
 		if(mCursor > 0 && it - mEntries.cbegin() <= mCursor)
@@ -230,6 +337,7 @@ protected:
 		// update the title overlay opacity
 		const int dir = (mScrollTier >= mTierList.count - 1) ? 1 : -1; // fade in if scroll tier is >= 1, otherwise fade out
 		int op = mTitleOverlayOpacity + deltaTime*dir; // we just do a 1-to-1 time -> opacity, no scaling
+		const unsigned char prevOpacity = mTitleOverlayOpacity;
 		if(op >= 255)
 			mTitleOverlayOpacity = 255;
 		else if(op <= 0)
@@ -237,9 +345,14 @@ protected:
 		else
 			mTitleOverlayOpacity = (unsigned char)op;
 
+		if(mTitleOverlayOpacity != prevOpacity)
+			Window::invalidate();
+
 		if(mScrollVelocity == 0 || size() < 2)
 			return;
 
+		Window::invalidate();
+
 		mScrollCursorAccumulator += deltaTime;
 		mScrollTierAccumulator += deltaTime;
 
@@ -4,6 +4,7 @@
 #include "Log.h"
 #include "Settings.h"
 #include "ThemeData.h"
+#include "Window.h"
 
 Vector2i ImageComponent::getTextureSize() const
 {
@@ -315,6 +316,8 @@ void ImageComponent::updateColors()
 	mVertices[1].col = mColorGradientHorizontal ? colorEnd : color;
 	mVertices[2].col = mColorGradientHorizontal ? color    : colorEnd;
 	mVertices[3].col = colorEnd;
+
+	Window::invalidate();
 }
 
 void ImageComponent::render(const Transform4x4f& parentTrans)
@@ -33,6 +33,8 @@ class ImageGridComponent : public IList<ImageGridData, T>
 {
 protected:
 	using IList<ImageGridData, T>::mEntries;
+	using IList<ImageGridData, T>::getEntryAt;
+	using IList<ImageGridData, T>::resetMaterialized;
 	using IList<ImageGridData, T>::mScrollTier;
 	using IList<ImageGridData, T>::listUpdate;
 	using IList<ImageGridData, T>::listInput;
@@ -51,6 +53,7 @@ public:
 	ImageGridComponent(Window* window);
 
 	void add(const std::string& name, const std::string& imagePath, const T& obj);
+	void setObjects(const std::vector<T>& objects, const typename IList<ImageGridData, T>::MaterializeFunc& materialize);
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
@@ -150,6 +153,13 @@ void ImageGridComponent<T>::add(const std::string& name, const std::string& imag
 	mEntriesDirty = true;
 }
 
+template<typename T>
+void ImageGridComponent<T>::setObjects(const std::vector<T>& objects, const typename IList<ImageGridData, T>::MaterializeFunc& materialize)
+{
+	static_cast<IList< ImageGridData, T >*>(this)->setObjects(objects, materialize);
+	mEntriesDirty = true;
+}
+
 template<typename T>
 bool ImageGridComponent<T>::input(InputConfig* config, Input input)
 {
@@ -284,6 +294,9 @@ void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme,
 		else
 			mImageSource = THUMBNAIL;
 
+		// texture paths materialised so far may come from another source
+		resetMaterialized();
+
 		if (elem->has("scrollDirection"))
 			mScrollDirection = (ScrollDirection)(elem->get<std::string>("scrollDirection") == "horizontal");
 
@@ -320,6 +333,7 @@ void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme,
 					if ((*it).data.texturePath == oldDefaultGameTexture)
 						(*it).data.texturePath = mDefaultGameTexture;
 				}
+				resetMaterialized();
 			}
 		}
 
@@ -343,6 +357,7 @@ void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme,
 					if ((*it).data.texturePath == oldDefaultFolderTexture)
 						(*it).data.texturePath = mDefaultFolderTexture;
 				}
+				resetMaterialized();
 			}
 		}
 	}
@@ -383,7 +398,7 @@ void ImageGridComponent<T>::onCursorChanged(const CursorState& state)
 
 	bool direction = mCursor >= mLastCursor;
 	int diff = direction ? mCursor - mLastCursor : mLastCursor - mCursor;
-	if (isScrollLoop() && diff == mEntries.size() - 1)
+	if (isScrollLoop() && diff == size() - 1)
 	{
 		direction = !direction;
 	}
@@ -399,7 +414,7 @@ void ImageGridComponent<T>::onCursorChanged(const CursorState& state)
 	int oldCol = (mLastCursor / dimOpposite);
 	int col = (mCursor / dimOpposite);
 
-	int lastCol = (((int)mEntries.size() - 1) / dimOpposite);
+	int lastCol = ((size() - 1) / dimOpposite);
 
 	int lastScroll = std::max(0, (lastCol + 1 - dimScrollable));
 
@@ -425,9 +440,9 @@ void ImageGridComponent<T>::onCursorChanged(const CursorState& state)
 		int newIdx = mCursor - mStartPosition + (dimOpposite * EXTRAITEMS);
 		if (isScrollLoop()) {
 			if (newIdx < 0)
-				newIdx += (int)mEntries.size();
+				newIdx += size();
 			else if (newIdx >= mTiles.size())
-				newIdx -= (int)mEntries.size();
+				newIdx -= size();
 		}
 
 		if (newIdx >= 0 && newIdx < mTiles.size())
@@ -621,9 +636,9 @@ void ImageGridComponent<T>::updateTileAtPos(int tilePos, int imgPos, bool allowA
 	if(isScrollLoop())
 	{
 		if (imgPos < 0)
-			imgPos += (int)mEntries.size();
+			imgPos += size();
 		else if (imgPos >= size())
-			imgPos -= (int)mEntries.size();
+			imgPos -= size();
 	}
 
 	// If we have more tiles than we have to display images on screen, hide them
@@ -639,11 +654,12 @@ void ImageGridComponent<T>::updateTileAtPos(int tilePos, int imgPos, bool allowA
 	{
 		tile->setVisible(true);
 
-		std::string imagePath = mEntries.at(imgPos).data.texturePath;
+		const typename IList<ImageGridData, T>::Entry& entry = getEntryAt(imgPos);
+		const std::string imagePath = entry.data.texturePath;
 
 		if (ResourceManager::getInstance()->fileExists(imagePath))
 			tile->setImage(imagePath);
-		else if (mEntries.at(imgPos).object->getType() == 2)
+		else if (entry.object->getType() == 2)
 			tile->setImage(mDefaultFolderTexture);
 		else
 			tile->setImage(mDefaultGameTexture);
@@ -702,8 +718,8 @@ bool ImageGridComponent<T>::isScrollLoop() {
 	if (!mScrollLoop)
 		return false;
 	if (isVertical())
-		return (mGridDimension.x() * (mGridDimension.y() - 2 * EXTRAITEMS)) <= mEntries.size();
-	return (mGridDimension.y() * (mGridDimension.x() - 2 * EXTRAITEMS)) <= mEntries.size();
+		return (mGridDimension.x() * (mGridDimension.y() - 2 * EXTRAITEMS)) <= size();
+	return (mGridDimension.y() * (mGridDimension.x() - 2 * EXTRAITEMS)) <= size();
 };
 
 #endif // ES_CORE_COMPONENTS_IMAGE_GRID_COMPONENT_H
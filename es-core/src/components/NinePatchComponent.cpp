@@ -3,6 +3,7 @@
 #include "resources/TextureResource.h"
 #include "Log.h"
 #include "ThemeData.h"
+#include "Window.h"
 
 NinePatchComponent::NinePatchComponent(Window* window, const std::string& path, unsigned int edgeColor, unsigned int centerColor) : GuiComponent(window),
 	mCornerSize(16, 16),
@@ -34,6 +35,8 @@ void NinePatchComponent::updateColors()
 
 void NinePatchComponent::buildVertices()
 {
+	Window::invalidate();
+
 	if(mVertices != NULL)
 		delete[] mVertices;
 
@@ -2,6 +2,7 @@
 
 #include "math/Vector2i.h"
 #include "renderers/Renderer.h"
+#include "Window.h"
 
 #define AUTO_SCROLL_RESET_DELAY 3000 // ms to reset to top after we reach the bottom
 #define AUTO_SCROLL_DELAY 1000 // ms to wait before we start to scroll
@@ -61,6 +62,7 @@ Vector2f ScrollableContainer::getScrollPos() const
 void ScrollableContainer::setScrollPos(const Vector2f& pos)
 {
 	mScrollPos = pos;
+	Window::invalidate();
 }
 
 void ScrollableContainer::update(int deltaTime)
@@ -75,6 +77,7 @@ void ScrollableContainer::update(int deltaTime)
 		{
 			mScrollPos += mScrollDir;
 			mAutoScrollAccumulator -= mAutoScrollSpeed;
+			Window::invalidate();
 		}
 	}
 
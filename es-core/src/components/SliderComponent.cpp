@@ -1,6 +1,7 @@
 #include "components/SliderComponent.h"
 
 #include "resources/Font.h"
+#include "Window.h"
 
 #define MOVE_REPEAT_DELAY 500
 #define MOVE_REPEAT_RATE 40
@@ -88,6 +89,7 @@ void SliderComponent::setValue(float value)
 		mValue = mMax;
 
 	onValueChanged();
+	Window::invalidate();
 }
 
 float SliderComponent::getValue()
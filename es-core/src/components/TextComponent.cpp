@@ -3,6 +3,7 @@
 #include "utils/StringUtil.h"
 #include "Log.h"
 #include "Settings.h"
+#include "Window.h"
 
 TextComponent::TextComponent(Window* window) : GuiComponent(window),
 	mFont(Font::get(FONT_SIZE_MEDIUM)), mUppercase(false), mColor(0x000000FF), mAutoCalcExtent(true, true),
@@ -183,6 +184,8 @@ std::string TextComponent::calculateExtent(bool allow_wrapping)
 
 void TextComponent::onTextChanged()
 {
+	Window::invalidate();
+
 	if(!mFont || mText.empty())
 	{
 		mTextCache.reset();
@@ -225,6 +228,8 @@ void TextComponent::onColorChanged()
 	{
 		mTextCache->setColor(mColor);
 	}
+
+	Window::invalidate();
 }
 
 void TextComponent::setHorizontalAlignment(Alignment align)
@@ -2,6 +2,7 @@
 
 #include "resources/Font.h"
 #include "utils/StringUtil.h"
+#include "Window.h"
 
 #define TEXT_PADDING_HORIZ 10
 #define TEXT_PADDING_VERT 2
@@ -192,6 +193,7 @@ void TextEditComponent::moveCursor(int amt)
 {
 	mCursor = (unsigned int)Utils::String::moveCursor(mText, mCursor, amt);
 	onCursorChanged();
+	Window::invalidate();
 }
 
 void TextEditComponent::setCursor(size_t pos)
@@ -6,6 +6,7 @@
 #include "ThemeData.h"
 #include "Window.h"
 #include <SDL_timer.h>
+#include <algorithm>
 
 #define FADE_TIME_MS	200
 
@@ -57,6 +58,7 @@ VideoComponent::VideoComponent(Window* window) :
 	mVideoWidth(0),
 	mStartDelayed(false),
 	mIsPlaying(false),
+	mPlaybackFailed(false),
 	mShowing(false),
 	mScreensaverActive(false),
 	mDisable(false),
@@ -246,7 +248,13 @@ void VideoComponent::startVideoWithDelay()
 		// Set the video that we are going to be playing so we don't attempt to restart it
 		mPlayingVideoPath = mVideoPath;
 
-		if (mConfig.startDelay == 0 || PowerSaver::getMode() == PowerSaver::INSTANT)
+		// Wait for the selection to settle before spinning up a decoder, this avoids starting
+		// (and immediately discarding) a video for every entry passed while moving through a list
+		unsigned startDelay = mConfig.startDelay;
+		if (!mScreensaverMode)
+			startDelay = std::max(startDelay, (unsigned)Settings::getInstance()->getInt("VideoStartDebounce"));
+
+		if (startDelay == 0 || PowerSaver::getMode() == PowerSaver::INSTANT)
 		{
 			// No delay. Just start the video
 			mStartDelayed = false;
@@ -257,7 +265,7 @@ void VideoComponent::startVideoWithDelay()
 			// Configure the start delay
 			mStartDelayed = true;
 			mFadeIn = 0.0f;
-			mStartTime = SDL_GetTicks() + mConfig.startDelay;
+			mStartTime = SDL_GetTicks() + startDelay;
 		}
 		mIsPlaying = true;
 	}
@@ -267,6 +275,10 @@ void VideoComponent::update(int deltaTime)
 {
 	manageState();
 
+	// the delayed start and looping are driven from render(), keep frames coming while a video is active
+	if ((mIsPlaying && !mPlaybackFailed) || mFadeIn < 1.0f)
+		Window::invalidate();
+
 	// If the video start is delayed and there is less than the fade time then set the image fade
 	// accordingly
 	if (mStartDelayed)
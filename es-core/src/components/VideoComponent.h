@@ -35,6 +35,9 @@ public:
 	// Configures the component to show the default video
 	void setDefaultVideo();
 
+	// Hint that the video at the given path is likely to be played soon
+	virtual void prefetchVideo(const std::string& /*path*/) { };
+
 	// sets whether it's going to render in screensaver mode
 	void setScreensaverMode(bool isScreensaver);
 
@@ -102,6 +105,7 @@ protected:
 	bool							mStartDelayed;
 	unsigned						mStartTime;
 	bool							mIsPlaying;
+	bool							mPlaybackFailed; // the video could not be started, it stays off until the path changes
 	bool							mShowing;
 	bool							mDisable;
 	bool							mScreensaverActive;
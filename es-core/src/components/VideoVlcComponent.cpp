@@ -2,6 +2,7 @@
 
 #include "renderers/Renderer.h"
 #include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "PowerSaver.h"
 #include "Settings.h"
@@ -40,7 +41,9 @@ static void display(void* /*data*/, void* /*id*/) {
 
 VideoVlcComponent::VideoVlcComponent(Window* window, std::string subtitles) :
 	VideoComponent(window),
-	mMediaPlayer(nullptr)
+	mMedia(nullptr),
+	mMediaPlayer(nullptr),
+	mProbePending(false)
 {
 	memset(&mContext, 0, sizeof(mContext));
 
@@ -54,6 +57,9 @@ VideoVlcComponent::VideoVlcComponent(Window* window, std::string subtitles) :
 VideoVlcComponent::~VideoVlcComponent()
 {
 	stopVideo();
+
+	if (mMediaPlayer)
+		libvlc_media_player_release(mMediaPlayer);
 }
 
 void VideoVlcComponent::setResize(float width, float height)
@@ -218,7 +224,15 @@ void VideoVlcComponent::setupVLC(std::string subtitles)
 
 void VideoVlcComponent::handleLooping()
 {
-	if (mIsPlaying && mMediaPlayer)
+	// Start the video as soon as the background parsing of the media has finished
+	if (mProbePending && (mVideoPath == mPlayingVideoPath))
+	{
+		VideoMetaDataCache::VideoMetaData metaData;
+		if (VideoMetaDataCache::getInstance()->get(mPlayingVideoPath, &metaData))
+			startPlayback(metaData);
+	}
+
+	if (mIsPlaying && mMedia)
 	{
 		libvlc_state_t state = libvlc_media_player_get_state(mMediaPlayer);
 		if (state == libvlc_Ended)
@@ -237,110 +251,146 @@ void VideoVlcComponent::startVideo()
 		mVideoWidth = 0;
 		mVideoHeight = 0;
 
-#ifdef WIN32
-		std::string path(Utils::String::replace(mVideoPath, "/", "\\"));
-#else
-		std::string path(mVideoPath);
-#endif
 		// Make sure we have a video path
-		if (mVLC && (path.size() > 0))
+		if (mVLC && (mVideoPath.size() > 0))
 		{
 			// Set the video that we are going to be playing so we don't attempt to restart it
 			mPlayingVideoPath = mVideoPath;
 
-			// Open the media
-			mMedia = libvlc_media_new_path(mVLC, path.c_str());
-			if (mMedia)
+			// Parsing the media to find the aspect ratio can take a long time on slow storage,
+			// so it is done in the background and the video starts once the dimensions are known
+			VideoMetaDataCache::VideoMetaData metaData;
+			if (VideoMetaDataCache::getInstance()->get(mVideoPath, &metaData))
+			{
+				startPlayback(metaData);
+			}
+			else
 			{
-				unsigned track_count;
-				// Get the media metadata so we can find the aspect ratio
-				libvlc_media_parse_with_options(mMedia, libvlc_media_fetch_local, -1);
-				while (libvlc_media_get_parsed_status(mMedia) == 0)
-					;
-				libvlc_media_track_t** tracks;
-				track_count = libvlc_media_tracks_get(mMedia, &tracks);
-				for (unsigned track = 0; track < track_count; ++track)
-				{
-					if (tracks[track]->i_type == libvlc_track_video)
-					{
-						mVideoWidth = tracks[track]->video->i_width;
-						mVideoHeight = tracks[track]->video->i_height;
-						break;
-					}
-				}
-				libvlc_media_tracks_release(tracks, track_count);
-
-				// Make sure we found a valid video track
-				if ((mVideoWidth > 0) && (mVideoHeight > 0))
-				{
-					if (mScreensaverMode)
-					{
-						std::string resolution = Settings::getInstance()->getString("VlcScreenSaverResolution");
-						if(resolution != "original") {
-							float scale = 1;
-							if (resolution == "low")
-								// 25% of screen resolution
-								scale = 0.25;
-							if (resolution == "medium")
-								// 50% of screen resolution
-								scale = 0.5;
-							if (resolution == "high")
-								// 75% of screen resolution
-								scale = 0.75;
-
-							Vector2f resizeScale((Renderer::getScreenWidth() / (float)mVideoWidth) * scale, (Renderer::getScreenHeight() / (float)mVideoHeight) * scale);
-
-							if(resizeScale.x() < resizeScale.y())
-							{
-								mVideoWidth = (unsigned int) (mVideoWidth * resizeScale.x());
-								mVideoHeight = (unsigned int) (mVideoHeight * resizeScale.x());
-							}else{
-								mVideoWidth = (unsigned int) (mVideoWidth * resizeScale.y());
-								mVideoHeight = (unsigned int) (mVideoHeight * resizeScale.y());
-							}
-						}
-					}
-					else
-					{
-						remove(getTitlePath().c_str());
-					}
-					PowerSaver::pause();
-					setupContext();
-
-					// Setup the media player
-					mMediaPlayer = libvlc_media_player_new_from_media(mMedia);
-
-					setMuteMode();
-
-					libvlc_media_player_play(mMediaPlayer);
-					libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
-					libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
-
-					// Update the playing state
-					mIsPlaying = true;
-					mFadeIn = 0.0f;
-				}
+				VideoMetaDataCache::getInstance()->probe(mVideoPath, mVLC);
+				mProbePending = true;
+				// handleStartDelay() cleared it, without it manageState() would arm the start delay again
+				mIsPlaying = true;
 			}
 		}
 	}
 }
 
+void VideoVlcComponent::startPlayback(const VideoMetaDataCache::VideoMetaData& metaData)
+{
+	mProbePending = false;
+	mStartDelayed = false;
+	// Started once per path, stopVideo() clears this again
+	mIsPlaying = true;
+	mVideoWidth = metaData.width;
+	mVideoHeight = metaData.height;
+
+	// Make sure we found a valid video track, a failed probe leaves nothing to play for this path
+	if ((mVideoWidth == 0) || (mVideoHeight == 0))
+	{
+		mPlaybackFailed = true;
+		return;
+	}
+
+	// Should a start ever come twice, the first media is let go of the same way stopVideo() does
+	releaseMedia();
+
+#ifdef WIN32
+	std::string path(Utils::String::replace(mVideoPath, "/", "\\"));
+#else
+	std::string path(mVideoPath);
+#endif
+	// Open the media
+	mMedia = libvlc_media_new_path(mVLC, path.c_str());
+	if (!mMedia)
+	{
+		mPlaybackFailed = true;
+		return;
+	}
+
+	if (mScreensaverMode)
+	{
+		std::string resolution = Settings::getInstance()->getString("VlcScreenSaverResolution");
+		if(resolution != "original") {
+			float scale = 1;
+			if (resolution == "low")
+				// 25% of screen resolution
+				scale = 0.25;
+			if (resolution == "medium")
+				// 50% of screen resolution
+				scale = 0.5;
+			if (resolution == "high")
+				// 75% of screen resolution
+				scale = 0.75;
+
+			Vector2f resizeScale((Renderer::getScreenWidth() / (float)mVideoWidth) * scale, (Renderer::getScreenHeight() / (float)mVideoHeight) * scale);
+
+			if(resizeScale.x() < resizeScale.y())
+			{
+				mVideoWidth = (unsigned int) (mVideoWidth * resizeScale.x());
+				mVideoHeight = (unsigned int) (mVideoHeight * resizeScale.x());
+			}else{
+				mVideoWidth = (unsigned int) (mVideoWidth * resizeScale.y());
+				mVideoHeight = (unsigned int) (mVideoHeight * resizeScale.y());
+			}
+		}
+	}
+	else
+	{
+		remove(getTitlePath().c_str());
+	}
+	PowerSaver::pause();
+	setupContext();
+
+	// The media player is kept warm between videos, only create it the first time around
+	if (!mMediaPlayer)
+	{
+		mMediaPlayer = libvlc_media_player_new(mVLC);
+		libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
+	}
+
+	setMuteMode();
+
+	libvlc_media_player_set_media(mMediaPlayer, mMedia);
+	libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
+	libvlc_media_player_play(mMediaPlayer);
+
+	mFadeIn = 0.0f;
+}
+
 void VideoVlcComponent::stopVideo()
 {
 	mIsPlaying = false;
+	mPlaybackFailed = false;
 	mStartDelayed = false;
-	// Release the media player so it stops calling back to us
-	if (mMediaPlayer)
+	mProbePending = false;
+	releaseMedia();
+}
+
+void VideoVlcComponent::releaseMedia()
+{
+	// Stop the media player so it stops calling back to us, the player itself is reused for the next video
+	if (mMedia)
 	{
 		libvlc_media_player_stop(mMediaPlayer);
-		libvlc_media_player_release(mMediaPlayer);
 		libvlc_media_release(mMedia);
-		mMediaPlayer = NULL;
+		mMedia = NULL;
 		freeContext();
 		PowerSaver::resume();
 	}
 }
 
+void VideoVlcComponent::prefetchVideo(const std::string& path)
+{
+	if (!mVLC || path.empty())
+		return;
+
+	// Make sure the dimensions are known by the time the video gets selected, using the same key as setVideo()
+	const std::string fullPath = Utils::FileSystem::getAbsolutePath(path);
+	VideoMetaDataCache::VideoMetaData metaData;
+	if (!VideoMetaDataCache::getInstance()->get(fullPath, &metaData))
+		VideoMetaDataCache::getInstance()->probe(fullPath, mVLC);
+}
+
 void VideoVlcComponent::setMuteMode()
 {
 	Settings *cfg = Settings::getInstance();
@@ -3,6 +3,7 @@
 #define ES_CORE_COMPONENTS_VIDEO_VLC_COMPONENT_H
 
 #include "VideoComponent.h"
+#include "VideoMetaDataCache.h"
 
 struct SDL_mutex;
 struct SDL_Surface;
@@ -47,12 +48,17 @@ public:
 	// Never breaks the aspect ratio. setMaxSize() and setResize() are mutually exclusive.
 	void setMaxSize(float width, float height) override;
 
+	// Parses the video in the background so it can start right away once selected
+	void prefetchVideo(const std::string& path) override;
+
 private:
 	// Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
 	// Used internally whenever the resizing parameters or texture change.
 	void resize();
 	// Start the video Immediately
 	virtual void startVideo() override;
+	// Start playing the video using the already known dimensions
+	void startPlayback(const VideoMetaDataCache::VideoMetaData& metaData);
 	// Stop the video
 	virtual void stopVideo() override;
 	// Handle looping the video. Must be called periodically
@@ -61,12 +67,14 @@ private:
 	void setMuteMode();
 	void setupContext();
 	void freeContext();
+	void releaseMedia();
 
 private:
 	static libvlc_instance_t*		mVLC;
 	libvlc_media_t*					mMedia;
 	libvlc_media_player_t*			mMediaPlayer;
 	VideoContext					mContext;
+	bool							mProbePending;
 	std::shared_ptr<TextureResource> mTexture;
 };
 
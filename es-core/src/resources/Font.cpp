@@ -2,8 +2,10 @@
 
 #include "renderers/Renderer.h"
 #include "utils/FileSystemUtil.h"
+#include "utils/ProfilingUtil.h"
 #include "utils/StringUtil.h"
 #include "Log.h"
+#include <string.h>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -103,6 +105,25 @@ void Font::reload()
 	mLoaded = true;
 }
 
+bool Font::suspend(size_t& budget)
+{
+	if (!mLoaded)
+		return false;
+
+	size_t size = 0;
+	for(auto it = mTextures.cbegin(); it != mTextures.cend(); it++)
+		size += it->textureSize.x() * it->textureSize.y();
+
+	// the glyphs are rendered into RAM now so nothing has to be rendered while coming back
+	if (size <= budget)
+	{
+		rasterizeTextures();
+		budget -= size;
+	}
+
+	return unload();
+}
+
 bool Font::unload()
 {
 	if (mLoaded)
@@ -117,7 +138,7 @@ bool Font::unload()
 
 std::shared_ptr<Font> Font::get(int size, const std::string& path)
 {
-	const std::string canonicalPath = Utils::FileSystem::getCanonicalPath(path);
+	const std::string canonicalPath = ResourceManager::getInstance()->getCanonicalPath(path);
 
 	std::pair<std::string, int> def(canonicalPath.empty() ? getDefaultPath() : canonicalPath, size);
 	auto foundFont = sFontMap.find(def);
@@ -129,7 +150,7 @@ std::shared_ptr<Font> Font::get(int size, const std::string& path)
 
 	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(def.second, def.first));
 	sFontMap[def] = std::weak_ptr<Font>(font);
-	ResourceManager::getInstance()->addReloadable(font);
+	ResourceManager::getInstance()->addReloadable(font.get());
 	return font;
 }
 
@@ -187,7 +208,8 @@ bool Font::FontTexture::findEmpty(const Vector2i& size, Vector2i& cursor_out)
 void Font::FontTexture::initTexture()
 {
 	assert(textureId == 0);
-	textureId = Renderer::createTexture(Renderer::Texture::ALPHA, false, false, textureSize.x(), textureSize.y(), nullptr);
+	textureId = Renderer::createTexture(Renderer::Texture::ALPHA, false, false, textureSize.x(), textureSize.y(), pixels.empty() ? nullptr : pixels.data());
+	std::vector<unsigned char>().swap(pixels);
 }
 
 void Font::FontTexture::deinitTexture()
@@ -368,15 +390,46 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 	return &glyph;
 }
 
+// render all glyphs into the pixels of their textures, for rebuildTextures() to upload them at once
+void Font::rasterizeTextures()
+{
+	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
+		it->pixels.assign(it->textureSize.x() * it->textureSize.y(), 0);
+
+	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
+	{
+		FT_Face face = getFaceForChar(it->first);
+		FT_GlyphSlot glyphSlot = face->glyph;
+
+		FT_Load_Char(face, it->first, FT_LOAD_RENDER);
+
+		FontTexture* tex = it->second.texture;
+
+		Vector2i cursor((int)(it->second.texPos.x() * tex->textureSize.x()), (int)(it->second.texPos.y() * tex->textureSize.y()));
+		Vector2i glyphSize((int)(it->second.texSize.x() * tex->textureSize.x()), (int)(it->second.texSize.y() * tex->textureSize.y()));
+
+		for(int y = 0; y < glyphSize.y(); y++)
+			memcpy(&tex->pixels[(cursor.y() + y) * tex->textureSize.x() + cursor.x()], glyphSlot->bitmap.buffer + y * glyphSlot->bitmap.pitch, glyphSize.x());
+	}
+}
+
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
+	// textures kept while suspended already hold their glyphs
+	bool rasterized = !mTextures.empty();
+	for(auto it = mTextures.cbegin(); it != mTextures.cend(); it++)
+		rasterized = rasterized && !it->pixels.empty();
+
 	// recreate OpenGL textures
 	for(auto it = mTextures.begin(); it != mTextures.end(); it++)
 	{
 		it->initTexture();
 	}
 
+	if(rasterized)
+		return;
+
 	// reupload the texture data
 	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
 	{
@@ -619,6 +672,8 @@ float Font::getNewlineStartOffset(const std::string& text, const unsigned int& c
 
 TextCache* Font::buildTextCache(const std::string& text, Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
+	ProfileZone("text layout");
+
 	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
 
 	float yTop = getGlyph('S')->bearing.y();
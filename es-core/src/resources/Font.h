@@ -55,6 +55,7 @@ public:
 	float getLetterHeight();
 
 	bool unload() override;
+	bool suspend(size_t& budget) override;
 	void reload() override;
 
 	int getSize() const;
@@ -81,6 +82,8 @@ private:
 		Vector2i writePos;
 		int rowHeight;
 
+		std::vector<unsigned char> pixels; // the glyphs while suspended, uploaded at once by initTexture()
+
 		FontTexture();
 		~FontTexture();
 		bool findEmpty(const Vector2i& size, Vector2i& cursor_out);
@@ -101,6 +104,7 @@ private:
 
 	void rebuildTextures();
 	void unloadTextures();
+	void rasterizeTextures();
 
 	std::vector<FontTexture> mTextures;
 
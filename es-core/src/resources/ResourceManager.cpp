@@ -1,14 +1,30 @@
 #include "ResourceManager.h"
 
 #include "utils/FileSystemUtil.h"
+#include "utils/ThreadPool.h"
+#include "Log.h"
 #include <fstream>
+#include <vector>
+
+#define MAX_CACHED_PATHS 32768
 
 auto array_deleter = [](unsigned char* p) { delete[] p; };
 auto nop_deleter = [](unsigned char* /*p*/) { };
 
 std::shared_ptr<ResourceManager> ResourceManager::sInstance = nullptr;
 
-ResourceManager::ResourceManager()
+IReloadable::IReloadable() : mPrevReloadable(nullptr), mNextReloadable(nullptr), mRegistered(false), mReload(false)
+{
+}
+
+IReloadable::~IReloadable()
+{
+	// static resources may outlive the manager
+	if(mRegistered && ResourceManager::sInstance)
+		ResourceManager::sInstance->removeReloadable(this);
+}
+
+ResourceManager::ResourceManager() : mPathGeneration(1), mPrunedGeneration(1), mReloadables(nullptr), mReloadableCount(0)
 {
 }
 
@@ -88,56 +104,186 @@ ResourceData ResourceManager::loadFile(const std::string& path) const
 
 bool ResourceManager::fileExists(const std::string& path) const
 {
+	const unsigned int generation = mPathGeneration;
+	{
+		std::unique_lock<std::mutex> lock(mPathMutex);
+		auto it = mExistingPaths.find(path);
+		if(it != mExistingPaths.cend() && it->second.generation == generation)
+			return it->second.value;
+	}
+
 	//if it exists as a resource file, return true
-	if(getResourcePath(path) != path)
+	const bool exists = (getResourcePath(path) != path) || Utils::FileSystem::exists(path);
+
+	std::unique_lock<std::mutex> lock(mPathMutex);
+	if(prunePaths(generation))
+		mExistingPaths[path] = { generation, exists };
+	return exists;
+}
+
+std::string ResourceManager::getCanonicalPath(const std::string& path) const
+{
+	const unsigned int generation = mPathGeneration;
+	{
+		std::unique_lock<std::mutex> lock(mPathMutex);
+		auto it = mCanonicalPaths.find(path);
+		if(it != mCanonicalPaths.cend() && it->second.generation == generation)
+			return it->second.value;
+	}
+
+	// resolves every component of the path, not something to do for every texture lookup
+	const std::string canonicalPath = Utils::FileSystem::getCanonicalPath(path);
+
+	std::unique_lock<std::mutex> lock(mPathMutex);
+	if(prunePaths(generation))
+		mCanonicalPaths[path] = { generation, canonicalPath };
+	return canonicalPath;
+}
+
+void ResourceManager::invalidatePaths()
+{
+	// cheap enough to call for every file written, the maps are only cleared by the next answer stored
+	++mPathGeneration;
+}
+
+bool ResourceManager::prunePaths(unsigned int generation) const
+{
+	// an answer looked up before the last invalidatePaths() may be outdated already
+	const unsigned int current = mPathGeneration;
+	if(generation != current)
+		return false;
+
+	if(mPrunedGeneration != current)
+	{
+		mExistingPaths.clear();
+		mCanonicalPaths.clear();
+		mPrunedGeneration = current;
 		return true;
+	}
+
+	// every path asked for is kept otherwise, browsing through many large gamelists would grow them without end
+	if(mExistingPaths.size() >= MAX_CACHED_PATHS)
+		mExistingPaths.clear();
+	if(mCanonicalPaths.size() >= MAX_CACHED_PATHS)
+		mCanonicalPaths.clear();
 
-	return Utils::FileSystem::exists(path);
+	return true;
 }
 
 void ResourceManager::unloadAll()
 {
-	auto iter = mReloadables.cbegin();
-	while(iter != mReloadables.cend())
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+
+	// releasing VRAM has to happen on this thread
+	size_t unloaded = 0;
+	for(IReloadable* reloadable = mReloadables; reloadable != nullptr; reloadable = reloadable->mNextReloadable)
 	{
-		std::shared_ptr<ReloadableInfo> info = *iter;
+		reloadable->mReload = reloadable->unload();
+		if(reloadable->mReload)
+			++unloaded;
+	}
 
-		if (!info->data.expired())
-		{
-			info->reload = info->data.lock()->unload();
-			iter++;
-		}
-		else
-			iter = mReloadables.erase(iter);
+	LOG(LogDebug) << "ResourceManager: unloaded " << unloaded << " of " << mReloadableCount << " resources";
+}
+
+void ResourceManager::suspendAll(size_t budget)
+{
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+
+	IReloadable* oldest = mReloadables;
+	while(oldest && oldest->mNextReloadable)
+		oldest = oldest->mNextReloadable;
+
+	// the longest living resources first, the fonts and the theme's images are needed on every screen
+	const size_t total = budget;
+	size_t unloaded = 0;
+	for(IReloadable* reloadable = oldest; reloadable != nullptr; reloadable = reloadable->mPrevReloadable)
+	{
+		reloadable->mReload = reloadable->suspend(budget);
+		if(reloadable->mReload)
+			++unloaded;
 	}
+
+	LOG(LogInfo) << "ResourceManager: suspended " << mReloadableCount << " resources, " << ((total - budget) / 1024) << "kB kept in RAM";
+	LOG(LogDebug) << "ResourceManager: " << unloaded << " resources to reload";
 }
 
 void ResourceManager::reloadAll()
 {
-	auto iter = mReloadables.cbegin();
-	while(iter != mReloadables.cend())
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+
+	std::vector<IReloadable*> inRAM;
+	size_t reloaded = 0;
+
+	for(IReloadable* reloadable = mReloadables; reloadable != nullptr; reloadable = reloadable->mNextReloadable)
 	{
-		std::shared_ptr<ReloadableInfo> info = *iter;
+		if(!reloadable->mReload)
+			continue;
 
-		if (!info->data.expired())
-		{
-			if (info->reload)
-			{
-				info->data.lock()->reload();
-				info->reload = false;
-			}
+		reloadable->mReload = false;
+		++reloaded;
 
-			iter++;
-		}
+		if(reloadable->reloadsInRAM())
+			inRAM.push_back(reloadable);
 		else
-			iter = mReloadables.erase(iter);
+			reloadable->reload();
 	}
+
+	// decoding is what takes long, the resources do that side by side, the GL work stays on this thread
+	if(!inRAM.empty())
+	{
+		Utils::ThreadPool pool;
+		for(auto it = inRAM.cbegin(); it != inRAM.cend(); ++it)
+		{
+			IReloadable* reloadable = *it;
+			pool.queueWorkItem([reloadable] { reloadable->reload(); });
+		}
+		pool.wait();
+	}
+
+	LOG(LogDebug) << "ResourceManager: reloaded " << reloaded << " of " << mReloadableCount << " resources, " << inRAM.size() << " in parallel";
+}
+
+void ResourceManager::addReloadable(IReloadable* reloadable)
+{
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+
+	if(reloadable->mRegistered)
+		return;
+
+	reloadable->mPrevReloadable = nullptr;
+	reloadable->mNextReloadable = mReloadables;
+	if(mReloadables)
+		mReloadables->mPrevReloadable = reloadable;
+
+	mReloadables = reloadable;
+	reloadable->mRegistered = true;
+	++mReloadableCount;
+}
+
+void ResourceManager::removeReloadable(IReloadable* reloadable)
+{
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+
+	if(!reloadable->mRegistered)
+		return;
+
+	if(reloadable->mPrevReloadable)
+		reloadable->mPrevReloadable->mNextReloadable = reloadable->mNextReloadable;
+	else
+		mReloadables = reloadable->mNextReloadable;
+
+	if(reloadable->mNextReloadable)
+		reloadable->mNextReloadable->mPrevReloadable = reloadable->mPrevReloadable;
+
+	reloadable->mPrevReloadable = nullptr;
+	reloadable->mNextReloadable = nullptr;
+	reloadable->mRegistered = false;
+	--mReloadableCount;
 }
 
-void ResourceManager::addReloadable(std::weak_ptr<IReloadable> reloadable)
+size_t ResourceManager::getReloadableCount() const
 {
-	std::shared_ptr<ReloadableInfo> info = std::make_shared<ReloadableInfo>();
-	info->data = reloadable;
-	info->reload = false;
-	mReloadables.push_back(info);
+	std::unique_lock<std::recursive_mutex> lock(mReloadableMutex);
+	return mReloadableCount;
 }
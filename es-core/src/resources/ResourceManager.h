@@ -2,9 +2,11 @@
 #ifndef ES_CORE_RESOURCES_RESOURCE_MANAGER_H
 #define ES_CORE_RESOURCES_RESOURCE_MANAGER_H
 
-#include <list>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 //The ResourceManager exists to...
 //Allow loading resources embedded into the executable like an actual file.
@@ -21,8 +23,25 @@ class ResourceManager;
 class IReloadable
 {
 public:
+	IReloadable();
+	virtual ~IReloadable(); // unregisters itself
+
 	virtual bool unload() = 0;
 	virtual void reload() = 0;
+	// Like unload(), but what brings the resource back quickly may stay in RAM as long as it fits into budget,
+	// which is reduced by what was kept. Returns whether reload() is needed.
+	virtual bool suspend(size_t& /*budget*/) { return unload(); }
+	// true if reload() only prepares data in RAM without touching GL, it then runs on a worker thread
+	virtual bool reloadsInRAM() const { return false; }
+
+private:
+	friend class ResourceManager;
+
+	// the registry is linked through the reloadables themselves, adding and removing one is O(1)
+	IReloadable* mPrevReloadable;
+	IReloadable* mNextReloadable;
+	bool mRegistered;
+	bool mReload;
 };
 
 class ResourceManager
@@ -30,30 +49,54 @@ class ResourceManager
 public:
 	static std::shared_ptr<ResourceManager>& getInstance();
 
-	void addReloadable(std::weak_ptr<IReloadable> reloadable);
+	void addReloadable(IReloadable* reloadable);
+	void removeReloadable(IReloadable* reloadable);
+	size_t getReloadableCount() const;
 
 	void unloadAll();
+	// Releases the GPU resources like unloadAll(), keeping up to budget bytes in RAM to come back from them faster
+	void suspendAll(size_t budget);
 	void reloadAll();
 
 	std::string getResourcePath(const std::string& path) const;
 	const ResourceData getFileData(const std::string& path) const;
 	bool fileExists(const std::string& path) const;
+	std::string getCanonicalPath(const std::string& path) const;
+
+	// fileExists() and getCanonicalPath() answer from memory for paths asked before,
+	// until this is called because files were written, removed or the resources changed
+	void invalidatePaths();
 
 private:
+	friend class IReloadable;
+
 	ResourceManager();
 
 	static std::shared_ptr<ResourceManager> sInstance;
 
 	ResourceData loadFile(const std::string& path) const;
+	// Drops the answers of older generations, or all once there are too many, called with mPathMutex held.
+	// Returns false if an answer looked up in generation is outdated already and must not be stored.
+	bool prunePaths(unsigned int generation) const;
 
-	class ReloadableInfo
+	template<typename T>
+	struct CachedPath
 	{
-	public:
-		std::weak_ptr<IReloadable> data;
-		bool reload;
+		unsigned int generation;
+		T value;
 	};
 
-	std::list<std::shared_ptr<ReloadableInfo>> mReloadables; //  std::weak_ptr<IReloadable>
+	// held while walking the reloadables, so none can go away meanwhile
+	mutable std::recursive_mutex mReloadableMutex;
+	IReloadable* mReloadables; // first of the linked reloadables
+	size_t mReloadableCount;
+
+	// answers of an older generation are looked up again, the next answer stored drops them
+	std::atomic<unsigned int> mPathGeneration;
+	mutable unsigned int mPrunedGeneration;
+	mutable std::mutex mPathMutex;
+	mutable std::unordered_map<std::string, CachedPath<bool>> mExistingPaths;
+	mutable std::unordered_map<std::string, CachedPath<std::string>> mCanonicalPaths;
 };
 
 #endif // ES_CORE_RESOURCES_RESOURCE_MANAGER_H
@@ -0,0 +1,370 @@
+#include "resources/SVGCache.h"
+
+#include "math/Misc.h"
+#include "resources/ResourceManager.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/ProfilingUtil.h"
+#include "ImageIO.h"
+#include "Log.h"
+#include "Settings.h"
+#include <nanosvg/nanosvg.h>
+#include <nanosvg/nanosvgrast.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+
+#define DPI           96
+#define MAX_DOCUMENTS 64
+#define DISK_MAGIC    "ESVG"
+// trimming the disk cache stops this much below its bound, so not every write trims again
+#define DISK_TRIM_TARGET_PERCENT 90
+
+SVGCache* SVGCache::sInstance = nullptr;
+
+void SVGCache::init()
+{
+	if(!sInstance)
+		sInstance = new SVGCache();
+
+} // init
+
+void SVGCache::deinit()
+{
+	if(sInstance)
+	{
+		delete sInstance;
+		sInstance = nullptr;
+	}
+
+} // deinit
+
+SVGCache* SVGCache::getInstance()
+{
+	if(!sInstance)
+		sInstance = new SVGCache();
+
+	return sInstance;
+
+} // getInstance
+
+SVGCache::SVGCache() : mRasterSize(0), mDiskSize(0), mDiskSizeKnown(false)
+{
+	mMaxRasterSize = (size_t)Settings::getInstance()->getInt("SVGCacheSize") * 1024 * 1024;
+	mDiskCache     = Settings::getInstance()->getBool("SVGDiskCache");
+	mMaxDiskSize   = (size_t)std::max(0, Settings::getInstance()->getInt("SVGDiskCacheSize")) * 1024 * 1024;
+
+	// created up front, the cache itself is only accessed from the texture loader
+	if(mDiskCache)
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getHomePath() + "/.emulationstation/cache/svg");
+
+} // SVGCache
+
+SVGCache::~SVGCache()
+{
+	clear();
+
+} // ~SVGCache
+
+std::string SVGCache::getDiskPath(const std::string& _key)
+{
+	std::stringstream ss;
+	ss << Utils::FileSystem::getHomePath() << "/.emulationstation/cache/svg/" << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(_key) << ".rgba";
+	return ss.str();
+
+} // getDiskPath
+
+std::shared_ptr<const SVGCache::Raster> SVGCache::get(const std::string& _path, float _height)
+{
+	const std::string resourcePath = ResourceManager::getInstance()->getResourcePath(_path);
+	const time_t      modTime      = Utils::FileSystem::getModificationTime(resourcePath);
+
+	std::stringstream ss;
+	ss << _path << "|" << modTime << "|" << _height;
+	const std::string key = ss.str();
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = mRasters.find(key);
+		if(it != mRasters.cend())
+		{
+			mRasterLRU.splice(mRasterLRU.begin(), mRasterLRU, it->second.lru);
+			return it->second.raster;
+		}
+	}
+
+	std::shared_ptr<const Raster> raster;
+
+	if(mDiskCache)
+		raster = loadFromDisk(key);
+
+	if(!raster)
+	{
+		std::shared_ptr<NSVGimage> image = getDocument(_path, modTime);
+		if(!image)
+			return nullptr;
+
+		raster = rasterize(image.get(), _height);
+
+		if(mDiskCache)
+			saveToDisk(key, *raster);
+	}
+
+	insert(key, raster);
+	return raster;
+
+} // get
+
+void SVGCache::clear()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mRasters.clear();
+	mRasterLRU.clear();
+	mRasterSize = 0;
+	mDocuments.clear();
+	mDocumentLRU.clear();
+
+} // clear
+
+std::shared_ptr<NSVGimage> SVGCache::getDocument(const std::string& _path, time_t _modTime)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = mDocuments.find(_path);
+		if((it != mDocuments.cend()) && (it->second.modTime == _modTime))
+		{
+			mDocumentLRU.splice(mDocumentLRU.begin(), mDocumentLRU, it->second.lru);
+			return it->second.image;
+		}
+	}
+
+	ProfileZone("svg parse");
+
+	const ResourceData data = ResourceManager::getInstance()->getFileData(_path);
+	if(!data.ptr)
+		return nullptr;
+
+	// nsvgParse excepts a modifiable, null-terminated string
+	std::vector<char> copy(data.length + 1);
+	memcpy(copy.data(), data.ptr.get(), data.length);
+	copy[data.length] = '\0';
+
+	std::shared_ptr<NSVGimage> image(nsvgParse(copy.data(), "px", DPI), [](NSVGimage* _image) { nsvgDelete(_image); });
+	if(!image || (image->width == 0) || (image->height == 0))
+	{
+		LOG(LogError) << "Error parsing SVG image \"" << _path << "\"";
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	auto it = mDocuments.find(_path);
+	if(it != mDocuments.cend())
+	{
+		// the file changed or another thread parsed it meanwhile
+		mDocumentLRU.erase(it->second.lru);
+		mDocuments.erase(it);
+	}
+
+	mDocumentLRU.push_front(_path);
+	DocumentEntry& entry = mDocuments[_path];
+	entry.image   = image;
+	entry.modTime = _modTime;
+	entry.lru     = mDocumentLRU.begin();
+
+	while(mDocuments.size() > MAX_DOCUMENTS)
+	{
+		mDocuments.erase(mDocumentLRU.back());
+		mDocumentLRU.pop_back();
+	}
+
+	return image;
+
+} // getDocument
+
+std::shared_ptr<const SVGCache::Raster> SVGCache::rasterize(NSVGimage* _image, float _height)
+{
+	ProfileZone("svg rasterize");
+
+	std::shared_ptr<Raster> raster(new Raster);
+
+	// rasterize at the requested height, the width follows from the aspect ratio of the document
+	raster->sourceHeight = (_height == 0.0f) ? _image->height : _height;
+	raster->sourceWidth  = (raster->sourceHeight * _image->width) / _image->height;
+	raster->width        = (size_t)Math::round(raster->sourceWidth);
+	raster->height       = (size_t)Math::round(raster->sourceHeight);
+	raster->dataRGBA.resize(raster->width * raster->height * 4);
+
+	NSVGrasterizer* rast  = nsvgCreateRasterizer();
+	const float     scale = Math::min(raster->height / _image->height, raster->width / _image->width);
+	nsvgRasterize(rast, _image, 0, 0, scale, raster->dataRGBA.data(), (int)raster->width, (int)raster->height, (int)raster->width * 4);
+	nsvgDeleteRasterizer(rast);
+
+	ImageIO::flipPixelsVert(raster->dataRGBA.data(), raster->width, raster->height);
+
+	return raster;
+
+} // rasterize
+
+std::shared_ptr<const SVGCache::Raster> SVGCache::loadFromDisk(const std::string& _key)
+{
+	std::ifstream stream(getDiskPath(_key), std::ios_base::in | std::ios_base::binary);
+	if(!stream.is_open())
+		return nullptr;
+
+	char     magic[4];
+	uint32_t keyLength = 0;
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)&keyLength, sizeof(keyLength));
+
+	if(!stream || (memcmp(magic, DISK_MAGIC, sizeof(magic)) != 0) || (keyLength != _key.length()))
+		return nullptr;
+
+	// the file name is only a hash, make sure it really is the requested image
+	std::string key(keyLength, '\0');
+	stream.read(&key[0], keyLength);
+	if(!stream || (key != _key))
+		return nullptr;
+
+	std::shared_ptr<Raster> raster(new Raster);
+	uint32_t                width  = 0;
+	uint32_t                height = 0;
+	stream.read((char*)&width, sizeof(width));
+	stream.read((char*)&height, sizeof(height));
+	stream.read((char*)&raster->sourceWidth, sizeof(raster->sourceWidth));
+	stream.read((char*)&raster->sourceHeight, sizeof(raster->sourceHeight));
+
+	raster->width  = width;
+	raster->height = height;
+	raster->dataRGBA.resize(raster->width * raster->height * 4);
+	stream.read((char*)raster->dataRGBA.data(), raster->dataRGBA.size());
+
+	if(!stream)
+	{
+		LOG(LogWarning) << "Ignoring truncated SVG cache file for \"" << _key << "\"";
+		return nullptr;
+	}
+
+	return raster;
+
+} // loadFromDisk
+
+void SVGCache::saveToDisk(const std::string& _key, const Raster& _raster)
+{
+	const std::string path     = getDiskPath(_key);
+	const std::string tempPath = path + ".tmp";
+
+	{
+		std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if(!stream.is_open())
+		{
+			LOG(LogError) << "Error writing SVG cache file \"" << tempPath << "\"";
+			return;
+		}
+
+		const uint32_t keyLength = (uint32_t)_key.length();
+		const uint32_t width     = (uint32_t)_raster.width;
+		const uint32_t height    = (uint32_t)_raster.height;
+
+		stream.write(DISK_MAGIC, 4);
+		stream.write((const char*)&keyLength, sizeof(keyLength));
+		stream.write(_key.c_str(), keyLength);
+		stream.write((const char*)&width, sizeof(width));
+		stream.write((const char*)&height, sizeof(height));
+		stream.write((const char*)&_raster.sourceWidth, sizeof(_raster.sourceWidth));
+		stream.write((const char*)&_raster.sourceHeight, sizeof(_raster.sourceHeight));
+		stream.write((const char*)_raster.dataRGBA.data(), _raster.dataRGBA.size());
+	}
+
+	// readers never see a partially written file
+	if(rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		remove(tempPath.c_str());
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mDiskMutex);
+
+	// the directory is only listed once a raster is written, not at startup
+	if(mDiskSizeKnown)
+		mDiskSize += 24 + _key.length() + _raster.dataRGBA.size();
+
+	if(!mDiskSizeKnown || (mDiskSize > mMaxDiskSize))
+		trimDisk();
+
+} // saveToDisk
+
+void SVGCache::trimDisk()
+{
+	// mDiskMutex must be held by the caller
+	const Utils::FileSystem::stringList content = Utils::FileSystem::getDirContent(Utils::FileSystem::getHomePath() + "/.emulationstation/cache/svg");
+
+	std::vector<std::pair<time_t, std::pair<std::string, size_t>>> files;
+	files.reserve(content.size());
+	mDiskSize = 0;
+
+	for(auto it = content.cbegin(); it != content.cend(); ++it)
+	{
+		std::ifstream stream(*it, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+		if(!stream.is_open())
+			continue;
+
+		const size_t size = (size_t)stream.tellg();
+		files.push_back(std::make_pair(Utils::FileSystem::getModificationTime(*it), std::make_pair(*it, size)));
+		mDiskSize += size;
+	}
+
+	mDiskSizeKnown = true;
+
+	if(mDiskSize <= mMaxDiskSize)
+		return;
+
+	// written longest ago first, rasters of other themes and resolutions are never written again
+	std::sort(files.begin(), files.end());
+
+	const size_t target  = mMaxDiskSize / 100 * DISK_TRIM_TARGET_PERCENT;
+	size_t       removed = 0;
+
+	for(auto it = files.cbegin(); (it != files.cend()) && (mDiskSize > target); ++it)
+	{
+		if(remove(it->second.first.c_str()) != 0)
+			continue;
+
+		mDiskSize -= it->second.second;
+		++removed;
+	}
+
+	LOG(LogDebug) << "Removed " << removed << " files from the SVG cache, " << (mDiskSize / 1024) << " KiB left";
+
+} // trimDisk
+
+void SVGCache::insert(const std::string& _key, const std::shared_ptr<const Raster>& _raster)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	// another thread may have rasterized the same image meanwhile
+	if(mRasters.find(_key) != mRasters.cend())
+		return;
+
+	mRasterLRU.push_front(_key);
+	RasterEntry& entry = mRasters[_key];
+	entry.raster = _raster;
+	entry.lru    = mRasterLRU.begin();
+	mRasterSize += _raster->dataRGBA.size();
+
+	// textures keep their own copy of the pixels, evicting only costs a future rasterization
+	while((mRasterSize > mMaxRasterSize) && (mRasterLRU.size() > 1))
+	{
+		auto it = mRasters.find(mRasterLRU.back());
+		mRasterSize -= it->second.raster->dataRGBA.size();
+		mRasters.erase(it);
+		mRasterLRU.pop_back();
+	}
+
+} // insert
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_SVG_CACHE_H
+#define ES_CORE_RESOURCES_SVG_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <vector>
+
+struct NSVGimage;
+
+//
+// Shares rasterized SVG images between all textures, keyed by canonical path and target height,
+// so the same logo at the same size is only rasterized once no matter how many components use it
+// or how often the textures are reloaded.
+//
+// Parsed documents are kept as well so rasterizing a known image at a new size skips parsing.
+// Both caches are bounded and evict the least recently used entries. Rasters can optionally be
+// stored in ~/.emulationstation/cache/svg to survive restarts. That directory is bounded too, the
+// files written longest ago go first, which takes care of those left behind by older themes and
+// resolutions. All functions are thread safe, parsing and rasterizing happen on the calling
+// thread, normally the texture loader.
+//
+class SVGCache
+{
+public:
+
+	struct Raster
+	{
+		std::vector<unsigned char> dataRGBA; // flipped vertically, ready to be uploaded
+		size_t                     width;
+		size_t                     height;
+		float                      sourceWidth;
+		float                      sourceHeight;
+	};
+
+	static void      init       ();
+	static void      deinit     ();
+	static SVGCache* getInstance();
+
+	// Returns the image rasterized _height pixels high, at the height of the document if _height is 0
+	std::shared_ptr<const Raster> get  (const std::string& _path, float _height);
+	void                          clear();
+
+private:
+
+	struct RasterEntry
+	{
+		std::shared_ptr<const Raster>    raster;
+		std::list<std::string>::iterator lru;
+	};
+
+	struct DocumentEntry
+	{
+		std::shared_ptr<NSVGimage>       image;
+		time_t                           modTime;
+		std::list<std::string>::iterator lru;
+	};
+
+	 SVGCache();
+	~SVGCache();
+
+	static std::string getDiskPath(const std::string& _key);
+
+	std::shared_ptr<NSVGimage>    getDocument (const std::string& _path, time_t _modTime);
+	std::shared_ptr<const Raster> rasterize   (NSVGimage* _image, float _height);
+	std::shared_ptr<const Raster> loadFromDisk(const std::string& _key);
+	void                          saveToDisk  (const std::string& _key, const Raster& _raster);
+	void                          insert      (const std::string& _key, const std::shared_ptr<const Raster>& _raster);
+	void                          trimDisk    ();
+
+	static SVGCache* sInstance;
+
+	std::map<std::string, RasterEntry>   mRasters;
+	std::list<std::string>               mRasterLRU;   // most recently used first
+	size_t                               mRasterSize;  // bytes of pixel data held by mRasters
+	std::map<std::string, DocumentEntry> mDocuments;
+	std::list<std::string>               mDocumentLRU; // most recently used first
+	std::mutex                           mMutex;
+
+	size_t     mMaxRasterSize;
+	bool       mDiskCache;
+	size_t     mMaxDiskSize;
+	size_t     mDiskSize;      // bytes in the disk cache directory, counted on the first write
+	bool       mDiskSizeKnown;
+	std::mutex mDiskMutex;     // held while counting and trimming the disk cache
+
+}; // SVGCache
+
+#endif // ES_CORE_RESOURCES_SVG_CACHE_H
@@ -1,17 +1,13 @@
 #include "resources/TextureData.h"
 
-#include "math/Misc.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
+#include "resources/SVGCache.h"
+#include "utils/ProfilingUtil.h"
 #include "ImageIO.h"
 #include "Log.h"
-#include <nanosvg/nanosvg.h>
-#include <nanosvg/nanosvgrast.h>
-#include <assert.h>
 #include <string.h>
 
-#define DPI 96
-
 TextureData::TextureData(bool tile) : mTile(tile), mTextureID(0), mDataRGBA(nullptr), mScalable(false),
 									  mWidth(0), mHeight(0), mSourceWidth(0.0f), mSourceHeight(0.0f)
 {
@@ -31,49 +27,36 @@ void TextureData::initFromPath(const std::string& path)
 	mReloadable = true;
 }
 
-bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length)
+bool TextureData::initSVGFromCache()
 {
-	// If already initialised then don't read again
-	std::unique_lock<std::mutex> lock(mMutex);
-	if (mDataRGBA)
-		return true;
+	float sourceHeight;
 
-	// nsvgParse excepts a modifiable, null-terminated string
-	char* copy = (char*)malloc(length + 1);
-	assert(copy != NULL);
-	memcpy(copy, fileData, length);
-	copy[length] = '\0';
-
-	NSVGimage* svgImage = nsvgParse(copy, "px", DPI);
-	free(copy);
-	if (!svgImage || (svgImage->width == 0) || (svgImage->height == 0))
+	// If already initialised then don't read again
 	{
-		LOG(LogError) << "Error parsing SVG image.";
-		nsvgDelete(svgImage);
-		return false;
-	}
-
-	// We want to rasterise this texture at a specific resolution. If the source size
-	// variables are set then use them otherwise set them from the parsed file
-	if (mSourceHeight == 0.0f)
-		mSourceHeight = svgImage->height;
-
-	mSourceWidth = (mSourceHeight * svgImage->width) / svgImage->height;
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mDataRGBA)
+			return true;
 
-	mWidth = (size_t)Math::round(mSourceWidth);
-	mHeight = (size_t)Math::round(mSourceHeight);
+		sourceHeight = mSourceHeight;
+	}
 
-	unsigned char* dataRGBA = new unsigned char[mWidth * mHeight * 4];
+	// Don't hold the lock while rasterizing, uploadAndBind() on the render thread would wait for it
+	std::shared_ptr<const SVGCache::Raster> raster = SVGCache::getInstance()->get(mPath, sourceHeight);
+	if (!raster)
+		return false;
 
-	NSVGrasterizer* rast = nsvgCreateRasterizer();
-	float scale = Math::min(mHeight / svgImage->height, mWidth / svgImage->width);
-	nsvgRasterize(rast, svgImage, 0, 0, scale, dataRGBA, (int)mWidth, (int)mHeight, (int)mWidth * 4);
-	nsvgDeleteRasterizer(rast);
-	nsvgDelete(svgImage);
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mDataRGBA)
+		return true;
 
-	ImageIO::flipPixelsVert(dataRGBA, mWidth, mHeight);
+	mSourceWidth = raster->sourceWidth;
+	mSourceHeight = raster->sourceHeight;
+	mWidth = raster->width;
+	mHeight = raster->height;
 
-	mDataRGBA = dataRGBA;
+	// The cached pixels are shared, take a copy
+	mDataRGBA = new unsigned char[raster->dataRGBA.size()];
+	memcpy(mDataRGBA, raster->dataRGBA.data(), raster->dataRGBA.size());
 
 	return true;
 }
@@ -120,21 +103,25 @@ bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size
 
 bool TextureData::load()
 {
+	ProfileZone("texture load");
+
 	bool retval = false;
 
 	// Need to load. See if there is a file
 	if (!mPath.empty())
 	{
-		std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
-		const ResourceData& data = rm->getFileData(mPath);
 		// is it an SVG?
 		if (mPath.substr(mPath.size() - 4, std::string::npos) == ".svg")
 		{
 			mScalable = true;
-			retval = initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
+			retval = initSVGFromCache();
 		}
 		else
+		{
+			std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
+			const ResourceData& data = rm->getFileData(mPath);
 			retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length);
+		}
 	}
 	return retval;
 }
@@ -167,6 +154,7 @@ bool TextureData::uploadAndBind()
 			return false;
 
 		// Upload texture
+		ProfileZone("texture upload");
 		mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, true, mTile, (int)mWidth, (int)mHeight, mDataRGBA);
 	}
 	return true;
@@ -238,3 +226,18 @@ size_t TextureData::getVRAMUsage()
 	else
 		return 0;
 }
+
+size_t TextureData::getRAMUsage()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	if (mDataRGBA != nullptr)
+		return mWidth * mHeight * 4;
+	else
+		return 0;
+}
+
+bool TextureData::isUploaded()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return (mTextureID != 0);
+}
@@ -17,7 +17,8 @@ public:
 
 	//!!!! Needs to be canonical path. Caller should check for duplicates before calling this
 	void initFromPath(const std::string& path);
-	bool initSVGFromMemory(const unsigned char* fileData, size_t length);
+	// Takes the rasterized image from the shared SVGCache, only rasterizes on a cache miss
+	bool initSVGFromCache();
 	bool initImageFromMemory(const unsigned char* fileData, size_t length);
 	bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
 
@@ -38,6 +39,10 @@ public:
 
 	// Get the amount of VRAM currenty used by this texture
 	size_t getVRAMUsage();
+	// Get the amount of RAM held by the decoded pixels
+	size_t getRAMUsage();
+	// Whether the texture is in VRAM, i.e. it was bound since it was loaded
+	bool isUploaded();
 
 	size_t width();
 	size_t height();
@@ -3,6 +3,7 @@
 #include "resources/TextureData.h"
 #include "resources/TextureResource.h"
 #include "Settings.h"
+#include "Window.h"
 
 TextureDataManager::TextureDataManager()
 {
@@ -171,6 +172,9 @@ void TextureLoader::threadProc()
 		{
 			textureData->load();
 
+			// the texture gets uploaded on its next bind, make sure there is a frame to do that
+			Window::invalidate();
+
 			// See if there is another item in the queue
 			textureData = nullptr;
 			std::unique_lock<std::mutex> lock(mMutex);
@@ -104,11 +104,11 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 {
 	std::shared_ptr<ResourceManager>& rm = ResourceManager::getInstance();
 
-	const std::string canonicalPath = Utils::FileSystem::getCanonicalPath(path);
+	const std::string canonicalPath = rm->getCanonicalPath(path);
 	if(canonicalPath.empty())
 	{
 		std::shared_ptr<TextureResource> tex(new TextureResource("", tile, false));
-		rm->addReloadable(tex); //make sure we get properly deinitialized even though we do nothing on reinitialization
+		rm->addReloadable(tex.get()); //make sure we get properly deinitialized even though we do nothing on reinitialization
 		return tex;
 	}
 
@@ -133,7 +133,7 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	}
 
 	// Add it to the reloadable list
-	rm->addReloadable(tex);
+	rm->addReloadable(tex.get());
 
 	// Force load it if necessary. Note that it may get dumped from VRAM if we run low
 	if (forceLoad)
@@ -185,6 +185,11 @@ size_t TextureResource::getTotalMemUsage()
 	return total;
 }
 
+bool TextureResource::isLoading()
+{
+	return (sTextureDataManager.getQueueSize() != 0);
+}
+
 size_t TextureResource::getTotalTextureSize()
 {
 	size_t total = 0;
@@ -219,6 +224,29 @@ bool TextureResource::unload()
 	return false;
 }
 
+bool TextureResource::suspend(size_t& budget)
+{
+	std::shared_ptr<TextureData> data;
+	if (mTextureData == nullptr)
+		data = sTextureDataManager.get(this, false);
+	else
+		data = mTextureData;
+
+	// Textures that were on display keep their decoded pixels, they are uploaded again on their next bind
+	if (data != nullptr && data->isUploaded())
+	{
+		const size_t size = data->getRAMUsage();
+		if ((size > 0) && (size <= budget))
+		{
+			data->releaseVRAM();
+			budget -= size;
+			return false;
+		}
+	}
+
+	return unload();
+}
+
 void TextureResource::reload()
 {
 	// For dynamically loaded textures the texture manager will load them on demand.
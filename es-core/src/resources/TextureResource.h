@@ -34,11 +34,14 @@ public:
 
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static bool isLoading(); // returns true while textures are waiting to be loaded in the background
 
 protected:
 	TextureResource(const std::string& path, bool tile, bool dynamic);
 	virtual bool unload();
+	virtual bool suspend(size_t& budget);
 	virtual void reload();
+	virtual bool reloadsInRAM() const { return true; } // decodes, the upload happens on the next bind
 
 private:
 	// mTextureData is used for textures that are not loaded from a file - these ones
@@ -762,6 +762,21 @@ namespace Utils
 
 		} // isHidden
 
+//////////////////////////////////////////////////////////////////////////
+
+		time_t getModificationTime(const std::string& _path)
+		{
+			const std::string path = getGenericPath(_path);
+			struct stat64     info;
+
+			// check if stat64 succeeded
+			if(stat64(path.c_str(), &info) != 0)
+				return 0;
+
+			return info.st_mtime;
+
+		} // getModificationTime
+
 //////////////////////////////////////////////////////////////////////////
 
 #if !defined(_WIN32)
@@ -4,6 +4,7 @@
 
 #include <list>
 #include <string>
+#include <time.h>
 
 namespace Utils
 {
@@ -39,6 +40,7 @@ namespace Utils
 		bool        isDirectory        (const std::string& _path);
 		bool        isSymlink          (const std::string& _path);
 		bool        isHidden           (const std::string& _path);
+		time_t      getModificationTime(const std::string& _path);
 #if !defined(_WIN32)
 		bool        isExecutable       (const std::string& _path);
 #endif // !_WIN32
@@ -1,12 +1,274 @@
-
-#if defined(USE_PROFILING)
-
 #include "utils/ProfilingUtil.h"
 
-#include "math/Misc.h"
 #include "Log.h"
-
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string.h>
+
+#define ZONE_BUFFER_SIZE 8192 // events per thread, must be a power of two
+
+namespace Utils
+{
+	namespace Profiling
+	{
+		struct ZoneEvent
+		{
+			const char* name; // nullptr marks the end of a zone
+			uint64_t    time;
+
+		}; // ZoneEvent
+
+		struct ZoneBuffer
+		{
+			ZoneEvent                 events[ZONE_BUFFER_SIZE];
+			std::atomic<unsigned int> head;  // number of events written, wraps around
+			std::atomic<bool>         full;  // head went past ZONE_BUFFER_SIZE at least once
+			std::atomic<bool>         inUse; // owned by a running thread
+			unsigned int              thread;
+
+		}; // ZoneBuffer
+
+		// hands the buffer back for reuse when its thread exits, buffers themselves are never freed
+		struct ZoneBufferOwner
+		{
+			 ZoneBufferOwner(void) : buffer(nullptr) { }
+			~ZoneBufferOwner(void)                   { if(buffer) buffer->inUse = false; }
+
+			ZoneBuffer* buffer;
+
+		}; // ZoneBufferOwner
+
+		static std::vector<ZoneBuffer*>     zoneBuffers;
+		static std::mutex                   zoneBuffersMutex;
+		static thread_local ZoneBufferOwner zoneBufferOwner;
+
+//////////////////////////////////////////////////////////////////////////
+
+		static uint64_t getMicroseconds(void)
+		{
+			return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		} // getMicroseconds
+
+//////////////////////////////////////////////////////////////////////////
+
+		static ZoneBuffer* getZoneBuffer(void)
+		{
+			if(zoneBufferOwner.buffer)
+				return zoneBufferOwner.buffer;
+
+			// first zone on this thread, only happens once per thread
+			std::unique_lock<std::mutex> lock(zoneBuffersMutex);
+			ZoneBuffer*                  buffer = nullptr;
+
+			for(ZoneBuffer* bufferIt : zoneBuffers)
+			{
+				if(!bufferIt->inUse)
+				{
+					buffer = bufferIt;
+					break;
+				}
+			}
+
+			if(!buffer)
+			{
+				buffer         = new ZoneBuffer;
+				buffer->head   = 0;
+				buffer->full   = false;
+				buffer->thread = (unsigned int)zoneBuffers.size() + 1;
+
+				zoneBuffers.push_back(buffer);
+			}
+
+			buffer->inUse          = true;
+			zoneBufferOwner.buffer = buffer;
+
+			return buffer;
+
+		} // getZoneBuffer
+
+//////////////////////////////////////////////////////////////////////////
+
+		static void pushZoneEvent(const char* _name, const uint64_t _time)
+		{
+			ZoneBuffer*        buffer = getZoneBuffer();
+			const unsigned int head   = buffer->head.load(std::memory_order_relaxed);
+			ZoneEvent&         event  = buffer->events[head & (ZONE_BUFFER_SIZE - 1)];
+
+			event.name = _name;
+			event.time = _time;
+
+			if(head == (ZONE_BUFFER_SIZE - 1))
+				buffer->full.store(true, std::memory_order_relaxed);
+
+			buffer->head.store(head + 1, std::memory_order_release);
+
+		} // pushZoneEvent
+
+//////////////////////////////////////////////////////////////////////////
+
+		static void readZoneBuffer(ZoneBuffer* _buffer, std::vector<ZoneEvent>* _events)
+		{
+			const unsigned int head  = _buffer->head.load(std::memory_order_acquire);
+			const unsigned int count = _buffer->full.load(std::memory_order_relaxed) ? ZONE_BUFFER_SIZE : head;
+
+			_events->resize(count);
+			for(unsigned int i = 0; i < count; ++i)
+				(*_events)[i] = _buffer->events[(head - count + i) & (ZONE_BUFFER_SIZE - 1)];
+
+			// the owning thread keeps writing while we copy, drop the oldest events it may have overwritten
+			const unsigned int written = _buffer->head.load(std::memory_order_acquire) - head;
+			_events->erase(_events->begin(), _events->begin() + std::min(written, count));
+
+		} // readZoneBuffer
+
+//////////////////////////////////////////////////////////////////////////
+
+		static void buildZoneRecords(const std::vector<ZoneEvent>& _events, const unsigned int _thread, std::vector<ZoneRecord>* _records)
+		{
+			std::vector<size_t> stack;
+			const size_t        first = _records->size();
+
+			// records end up sorted by their begin time, ends without a begin were cut off by the ring buffer
+			for(const ZoneEvent& event : _events)
+			{
+				if(event.name)
+				{
+					const ZoneRecord record = { event.name, event.time, 0, (unsigned int)stack.size(), _thread };
+					stack.push_back(_records->size());
+					_records->push_back(record);
+				}
+				else if(!stack.empty())
+				{
+					(*_records)[stack.back()].timeEnd = event.time;
+					stack.pop_back();
+				}
+			}
+
+			// zones that are still open have no duration yet
+			_records->erase(std::remove_if(_records->begin() + first, _records->end(), [](const ZoneRecord& _record) { return _record.timeEnd == 0; }), _records->end());
+
+		} // buildZoneRecords
+
+//////////////////////////////////////////////////////////////////////////
+
+		void _zoneBegin(const char* _name)
+		{
+			pushZoneEvent(_name, getMicroseconds());
+
+		} // _zoneBegin
+
+//////////////////////////////////////////////////////////////////////////
+
+		void _zoneEnd(void)
+		{
+			pushZoneEvent(nullptr, getMicroseconds());
+
+		} // _zoneEnd
+
+//////////////////////////////////////////////////////////////////////////
+
+		bool getLastZone(const char* _name, std::vector<ZoneRecord>* _zones)
+		{
+			ZoneBuffer*             buffer = getZoneBuffer();
+			std::vector<ZoneEvent>  events;
+			std::vector<ZoneRecord> records;
+
+			_zones->clear();
+
+			readZoneBuffer(buffer, &events);
+			buildZoneRecords(events, buffer->thread, &records);
+
+			for(size_t i = records.size(); i > 0; --i)
+			{
+				const ZoneRecord& zone = records[i - 1];
+
+				if(strcmp(zone.name, _name) != 0)
+					continue;
+
+				// the zone is directly followed by everything nested inside it
+				for(size_t j = i - 1; j < records.size(); ++j)
+				{
+					if((j != (i - 1)) && ((records[j].depth <= zone.depth) || (records[j].timeBegin > zone.timeEnd)))
+						break;
+
+					ZoneRecord record = records[j];
+					record.depth -= zone.depth;
+					_zones->push_back(record);
+				}
+
+				return true;
+			}
+
+			return false;
+
+		} // getLastZone
+
+//////////////////////////////////////////////////////////////////////////
+
+		bool dumpTrace(const std::string& _path, const unsigned int _windowMs)
+		{
+			const uint64_t           timeEnd   = getMicroseconds();
+			const uint64_t           window    = (uint64_t)_windowMs * 1000;
+			const uint64_t           timeBegin = (timeEnd > window) ? (timeEnd - window) : 0;
+			std::vector<ZoneBuffer*> buffers;
+			std::vector<ZoneEvent>   events;
+			std::vector<ZoneRecord>  records;
+
+			{
+				std::unique_lock<std::mutex> lock(zoneBuffersMutex);
+				buffers = zoneBuffers;
+			}
+
+			for(ZoneBuffer* buffer : buffers)
+			{
+				readZoneBuffer(buffer, &events);
+				buildZoneRecords(events, buffer->thread, &records);
+			}
+
+			std::ofstream stream(_path.c_str(), std::ios_base::out | std::ios_base::trunc);
+			if(!stream.is_open())
+			{
+				LOG(LogError) << "Error opening trace file \"" << _path << "\" for writing";
+				return false;
+			}
+
+			// Chrome trace event format, complete events with timestamp and duration in microseconds
+			unsigned int count = 0;
+			stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+			for(const ZoneRecord& record : records)
+			{
+				if(record.timeEnd < timeBegin)
+					continue;
+
+				std::string name(record.name);
+				for(size_t i = name.find_first_of("\"\\"); i != std::string::npos; i = name.find_first_of("\"\\", i + 2))
+					name.insert(i, 1, '\\');
+
+				stream << (count++ ? ",\n" : "\n");
+				stream << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.thread
+				       << ",\"ts\":" << record.timeBegin << ",\"dur\":" << (record.timeEnd - record.timeBegin) << "}";
+			}
+
+			stream << "\n]}\n";
+			stream.close();
+
+			LOG(LogInfo) << "Wrote " << count << " profiling zones of the last " << _windowMs << "ms to \"" << _path << "\"";
+			return true;
+
+		} // dumpTrace
+
+	} // Profiling::
+
+} // Utils::
+
+#if defined(USE_PROFILING)
+
+#include "math/Misc.h"
 
 #if defined(_WIN32)
 // because windows...
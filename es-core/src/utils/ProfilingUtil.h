@@ -2,13 +2,65 @@
 #ifndef ES_CORE_UTILS_PROFILING_UTIL_H
 #define ES_CORE_UTILS_PROFILING_UTIL_H
 
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define _profilingUnique(_name, _line) _name ## _line
+#define _profilingUniqueIndex(_line)   _profilingUnique(uniqueIndex, _line)
+#define _profilingUniqueScope(_line)   _profilingUnique(uniqueScope, _line)
+#define _profilingUniqueZone(_line)    _profilingUnique(uniqueZone, _line)
+#define __profilingUniqueIndex         _profilingUniqueIndex(__LINE__)
+#define __profilingUniqueScope         _profilingUniqueScope(__LINE__)
+#define __profilingUniqueZone          _profilingUniqueZone(__LINE__)
+
+namespace Utils
+{
+	namespace Profiling
+	{
+		// Zones are always compiled in. Each thread records the begin and end of its zones in its own
+		// ring buffer without taking a lock, the buffers are only read by the overlay and trace dumps.
+
+		struct ZoneRecord
+		{
+			const char*  name;
+			uint64_t     timeBegin; // microseconds
+			uint64_t     timeEnd;   // microseconds
+			unsigned int depth;
+			unsigned int thread;
+
+		}; // ZoneRecord
+
+//////////////////////////////////////////////////////////////////////////
+
+		void _zoneBegin (const char* _name);
+		void _zoneEnd   (void);
+		bool getLastZone(const char* _name, std::vector<ZoneRecord>* _zones);
+		bool dumpTrace  (const std::string& _path, const unsigned int _windowMs);
+
+//////////////////////////////////////////////////////////////////////////
+
+		class Zone
+		{
+		public:
+
+			 Zone(const char* _name) { _zoneBegin(_name); }
+			~Zone(void)              { _zoneEnd(); }
+
+		}; // Zone
+
+	}; // Profiling::
+
+} // Utils::
+
+// _name must be a string literal, only the pointer is recorded
+#define ProfileZone(_name) const Utils::Profiling::Zone __profilingUniqueZone(_name)
+
 #if defined(USE_PROFILING)
 
 #include <mutex>
 #include <stack>
-#include <string>
 #include <thread>
-#include <vector>
 
 namespace Utils
 {
@@ -60,12 +112,6 @@ namespace Utils
 
 } // Utils::
 
-#define _profilingUnique(_name, _line) _name ## _line
-#define _profilingUniqueIndex(_line)   _profilingUnique(uniqueIndex, _line)
-#define _profilingUniqueScope(_line)   _profilingUnique(uniqueScope, _line)
-#define __profilingUniqueIndex         _profilingUniqueIndex(__LINE__)
-#define __profilingUniqueScope         _profilingUniqueScope(__LINE__)
-
 #define ProfileBegin(_message) static const unsigned int __profilingUniqueIndex = Utils::Profiling::_generateIndex(); Utils::Profiling::_begin(__profilingUniqueIndex, _message)
 #define ProfileEnd()           Utils::Profiling::_end()
 #define ProfileScope(_message) static const unsigned int __profilingUniqueIndex = Utils::Profiling::_generateIndex(); const Utils::Profiling::Scope __profilingUniqueScope(__profilingUniqueIndex, _message)
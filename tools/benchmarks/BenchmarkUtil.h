@@ -0,0 +1,83 @@
+#pragma once
+#ifndef TOOLS_BENCHMARKS_BENCHMARK_UTIL_H
+#define TOOLS_BENCHMARKS_BENCHMARK_UTIL_H
+
+#include "utils/FileSystemUtil.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+namespace Benchmark
+{
+	// Points the home path at a scratch folder next to the working directory, so settings, logs and
+	// gamelists written by a benchmark never touch the real ~/.emulationstation. Must run before anything
+	// asks for the home path, the first answer is cached.
+	inline std::string setScratchHome(const std::string& _name)
+	{
+		const std::string home = Utils::FileSystem::getCWDPath() + "/" + _name;
+
+		Utils::FileSystem::createDirectory(home + "/.emulationstation");
+		Utils::FileSystem::setHomePath(home);
+
+		return home;
+
+	} // setScratchHome
+
+	inline int getArgument(int _argc, char* _argv[], int _index, int _default)
+	{
+		return (_argc > _index) ? atoi(_argv[_index]) : _default;
+
+	} // getArgument
+
+	// Writes a gamelist.xml of _games scraped looking games, one in ten of them in a "Hacks" sub folder
+	inline bool writeGeneratedGamelist(const std::string& _path, int _games)
+	{
+		FILE* file = fopen(_path.c_str(), "w");
+		if(!file)
+			return false;
+
+		fprintf(file, "<?xml version=\"1.0\"?>\n<gameList>\n");
+
+		for(int i = 0; i < _games; ++i)
+		{
+			const char* folder = (i % 10) ? "" : "Hacks/";
+
+			fprintf(file, "\t<game>\n");
+			fprintf(file, "\t\t<path>./%sSome Game Title %06d (USA) (Rev 1).sfc</path>\n", folder, i);
+			fprintf(file, "\t\t<name>Some Game Title %06d</name>\n", i);
+			fprintf(file, "\t\t<desc>A generated game for the benchmarks, the description is about as long as a scraped one usually is. It goes on for a while to give the parser and the writer some text to copy around.</desc>\n");
+			fprintf(file, "\t\t<image>./images/Some Game Title %06d (USA) (Rev 1)-image.png</image>\n", i);
+			fprintf(file, "\t\t<rating>0.7</rating>\n");
+			fprintf(file, "\t\t<releasedate>19920101T000000</releasedate>\n");
+			fprintf(file, "\t\t<developer>Developer Inc.</developer>\n");
+			fprintf(file, "\t\t<publisher>Publisher Co.</publisher>\n");
+			fprintf(file, "\t\t<genre>Platform</genre>\n");
+			fprintf(file, "\t\t<players>2</players>\n");
+			fprintf(file, "\t</game>\n");
+		}
+
+		fprintf(file, "</gameList>\n");
+
+		return (fclose(file) == 0);
+
+	} // writeGeneratedGamelist
+
+	class Stopwatch
+	{
+	public:
+
+		Stopwatch() : mStart(std::chrono::steady_clock::now()) { }
+
+		void   restart() { mStart = std::chrono::steady_clock::now(); }
+		double getMs  () const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count(); }
+
+	private:
+
+		std::chrono::steady_clock::time_point mStart;
+
+	}; // Stopwatch
+
+} // Benchmark::
+
+#endif // TOOLS_BENCHMARKS_BENCHMARK_UTIL_H
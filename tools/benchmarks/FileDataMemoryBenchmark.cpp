@@ -0,0 +1,127 @@
+//
+// Reports the heap bytes per game of FileData and CollectionFileData nodes.
+//
+// usage: bench_filedata_memory [games]
+//
+// Counts every allocation through a replaced operator new with the real size of the heap block, then builds a
+// synthetic system of the given number of games (100000 by default) and an "all games" collection cloning
+// every one of them. It runs once with bare games as a folder scan creates them and once with the metadata a
+// scrape usually fills in.
+//
+
+#include "BenchmarkUtil.h"
+#include "FileData.h"
+#include "Log.h"
+#include "SystemData.h"
+#include <malloc.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#if defined(_WIN32)
+#define getBlockSize _msize
+#else // _WIN32
+#define getBlockSize malloc_usable_size
+#endif // !_WIN32
+
+static size_t sAllocated = 0;
+
+void* operator new(size_t _size)
+{
+	void* block = malloc(_size ? _size : 1);
+	if(!block)
+		throw std::bad_alloc();
+
+	sAllocated += getBlockSize(block);
+	return block;
+}
+
+void operator delete(void* _block) noexcept
+{
+	if(!_block)
+		return;
+
+	sAllocated -= getBlockSize(_block);
+	free(_block);
+}
+
+void* operator new[](size_t _size)                 { return operator new(_size); }
+void  operator delete[](void* _block) noexcept     { operator delete(_block); }
+void  operator delete(void* _block, size_t) noexcept   { operator delete(_block); }
+void  operator delete[](void* _block, size_t) noexcept { operator delete(_block); }
+
+static void run(int _games, bool _scraped)
+{
+	SystemEnvironmentData env;
+	env.mStartPath = "/home/pi/RetroPie/roms/snes";
+
+	// created as collections, so their constructors neither scan the disk nor parse a gamelist
+	SystemData* system = new SystemData("snes", "Super Nintendo", &env, "", true);
+	SystemData* all    = new SystemData("all", "All Games", &env, "", true);
+
+	FileData* root = new FileData(FOLDER, env.mStartPath, &env, system);
+	char      path[256];
+
+	size_t start = sAllocated;
+	for(int i = 0; i < _games; ++i)
+	{
+		snprintf(path, sizeof(path), "%s/Some Game Title %06d (USA) (Rev 1).sfc", env.mStartPath.c_str(), i);
+		FileData* game = new FileData(GAME, path, &env, system);
+
+		if(_scraped)
+		{
+			game->metadata.set("name", "Some Game Title " + std::to_string(i));
+			game->metadata.set("desc", std::string(320, 'x'));
+			game->metadata.set("image", "./images/Some Game Title (USA)-image.png");
+			game->metadata.set("video", "./videos/Some Game Title (USA)-video.mp4");
+			game->metadata.set("rating", "0.7");
+			game->metadata.set("releasedate", "19920101T000000");
+			game->metadata.set("developer", "Developer Inc.");
+			game->metadata.set("publisher", "Publisher Co.");
+			game->metadata.set("genre", "Platform");
+			game->metadata.set("players", "2");
+		}
+
+		root->addChild(game);
+	}
+	const size_t games = sAllocated - start;
+
+	FileData* allRoot = new FileData(FOLDER, "all", &env, all);
+
+	start = sAllocated;
+	const std::vector<FileData*>& children = root->getChildren();
+	for(auto it = children.cbegin(); it != children.cend(); ++it)
+		allRoot->addChild(new CollectionFileData(*it, all));
+	const size_t clones = sAllocated - start;
+
+	printf("%-8s %10d %12zu %12.1f %12zu %12.1f\n", _scraped ? "scraped" : "bare", _games,
+		games / _games, games / 1048576.0, clones / _games, clones / 1048576.0);
+
+	delete allRoot;
+	delete root;
+	delete all;
+	delete system;
+
+} // run
+
+int main(int argc, char* argv[])
+{
+	Benchmark::setScratchHome("bench_filedata_memory");
+
+	const int games = Benchmark::getArgument(argc, argv, 1, 100000);
+
+	Log::open();
+	Log::setReportingLevel(LogWarning);
+
+	printf("sizeof(FileData) %zu, sizeof(CollectionFileData) %zu\n", sizeof(FileData), sizeof(CollectionFileData));
+	printf("%-8s %10s %12s %12s %12s %12s\n", "games", "count", "bytes/game", "MiB", "bytes/clone", "MiB");
+
+	run(games, false);
+	run(games, true);
+
+	Log::close();
+
+	return 0;
+
+} // main
@@ -0,0 +1,112 @@
+//
+// Times the gamelist merge of GamelistWriter on a generated gamelist.
+//
+// usage: bench_gamelist_merge [games] [changed]
+//
+// Writes a gamelist.xml with the given number of scraped looking games, one in ten in a sub folder, loads it
+// into a SystemData, changes the given number of games spread over the list and times queueing and writing
+// them back. Without arguments a series of sizes is run with every game changed, the time per changed game
+// should stay flat as long as the merge is linear.
+//
+
+#include "BenchmarkUtil.h"
+#include "FileData.h"
+#include "GamelistWriter.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <pugixml.hpp>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static int countGames(const std::string& _path)
+{
+	pugi::xml_document doc;
+	if(!doc.load_file(_path.c_str()))
+		return -1;
+
+	int count = 0;
+	for(pugi::xml_node node = doc.child("gameList").child("game"); node; node = node.next_sibling("game"))
+		++count;
+
+	return count;
+
+} // countGames
+
+static bool run(const std::string& _home, int _games, int _changed)
+{
+	const std::string name = "bench" + std::to_string(_games);
+
+	SystemEnvironmentData env;
+	env.mStartPath = _home + "/roms/" + name;
+	env.mSearchExtensions.push_back(".sfc");
+
+	Utils::FileSystem::createDirectory(env.mStartPath);
+
+	const std::string gamelistPath = env.mStartPath + "/gamelist.xml";
+	if(!Benchmark::writeGeneratedGamelist(gamelistPath, _games))
+	{
+		printf("could not write %s\n", gamelistPath.c_str());
+		return false;
+	}
+
+	Benchmark::Stopwatch stopwatch;
+	SystemData*          system = new SystemData(name, name, &env, "", false);
+	const double         loadMs = stopwatch.getMs();
+
+	std::vector<FileData*> games = system->getRootFolder()->getFilesRecursive(GAME);
+	if(_changed > (int)games.size())
+		_changed = (int)games.size();
+
+	for(int i = 0; i < _changed; ++i)
+		games[(size_t)i * games.size() / _changed]->metadata.set("playcount", std::to_string(i + 1));
+
+	stopwatch.restart();
+	GamelistWriter::getInstance()->queue(system);
+	const bool   written = GamelistWriter::getInstance()->flush(system);
+	const double mergeMs = stopwatch.getMs();
+
+	const int count = countGames(gamelistPath);
+
+	printf("%8d %8d %10.1f %10.1f %12.2f %s\n", _games, _changed, loadMs, mergeMs, _changed ? (mergeMs * 1000.0 / _changed) : 0.0,
+		!written ? "write failed" : (count != _games) ? "game count changed" : "ok");
+
+	delete system;
+
+	return written && (count == _games);
+
+} // run
+
+int main(int argc, char* argv[])
+{
+	const std::string home = Benchmark::setScratchHome("bench_gamelist_merge");
+
+	Log::open();
+	Log::setReportingLevel(LogWarning);
+
+	Settings::getInstance()->setBool("ParseGamelistOnly", true);
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+
+	printf("%8s %8s %10s %10s %12s\n", "games", "changed", "load ms", "merge ms", "us/changed");
+
+	bool ok = true;
+
+	if(argc > 1)
+	{
+		const int games = Benchmark::getArgument(argc, argv, 1, 10000);
+		ok = run(home, games, Benchmark::getArgument(argc, argv, 2, games));
+	}
+	else
+	{
+		const int sizes[] = { 1000, 2500, 5000, 10000, 20000 };
+		for(int size : sizes)
+			ok &= run(home, size, size);
+	}
+
+	GamelistWriter::deinit();
+	Log::close();
+
+	return ok ? 0 : 1;
+
+} // main
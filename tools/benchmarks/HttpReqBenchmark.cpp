@@ -0,0 +1,124 @@
+//
+// Measures HttpReq throughput against a local test server.
+//
+// usage: bench_http [url] [requests] [--http2]
+//
+// Start tools/benchmarks/http_test_server.py first, the url defaults to it. The same number of requests is
+// run with 1, 4, 16 and 64 of them in flight, waiting on the completion callbacks. With 1 in flight every
+// request pays the full latency of the server, with more the I/O thread has to keep the transfers going at
+// once. --http2 sets UseHttp2 before the first request, the test server only speaks HTTP/1.1 though.
+//
+
+#include "BenchmarkUtil.h"
+#include "HttpReq.h"
+#include "Log.h"
+#include "Settings.h"
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+class Completions
+{
+public:
+
+	void push(HttpReq* _req)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.push_back(_req);
+		mEvent.notify_one();
+
+	} // push
+
+	HttpReq* wait()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mEvent.wait(lock, [this] { return !mDone.empty(); });
+
+		HttpReq* req = mDone.back();
+		mDone.pop_back();
+		return req;
+
+	} // wait
+
+private:
+
+	std::mutex              mMutex;
+	std::condition_variable mEvent;
+	std::vector<HttpReq*>   mDone;
+
+}; // Completions
+
+static bool run(const std::string& _url, int _requests, int _inFlight)
+{
+	Completions completions;
+	int         started  = 0;
+	int         finished = 0;
+	int         failed   = 0;
+	size_t      bytes    = 0;
+
+	Benchmark::Stopwatch stopwatch;
+
+	while(finished < _requests)
+	{
+		for(; (started < _requests) && ((started - finished) < _inFlight); ++started)
+			new HttpReq(_url, std::vector<std::string>(), [&completions](HttpReq* _req) { completions.push(_req); });
+
+		HttpReq* req = completions.wait();
+		if((req->status() == HttpReq::REQ_SUCCESS) && (req->getResponseCode() == 200))
+			bytes += req->getContent().size();
+		else
+			++failed;
+
+		delete req;
+		++finished;
+	}
+
+	const double ms = stopwatch.getMs();
+
+	printf("%9d %9d %10.1f %10.1f %10.2f %8d\n", _inFlight, _requests, ms, _requests * 1000.0 / ms, bytes / 1048576.0 * 1000.0 / ms, failed);
+
+	return (failed == 0);
+
+} // run
+
+int main(int argc, char* argv[])
+{
+	Benchmark::setScratchHome("bench_http");
+
+	std::string url      = "http://127.0.0.1:8000/";
+	int         requests = 500;
+	bool        http2    = false;
+	int         position = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--http2") == 0)
+			http2 = true;
+		else if(position++ == 0)
+			url = argv[i];
+		else
+			requests = atoi(argv[i]);
+	}
+
+	Log::open();
+	Log::setReportingLevel(LogWarning);
+
+	Settings::getInstance()->setBool("UseHttp2", http2);
+
+	printf("%s, %d requests per run%s\n", url.c_str(), requests, http2 ? ", HTTP/2 allowed" : "");
+	printf("%9s %9s %10s %10s %10s %8s\n", "in flight", "requests", "ms", "req/s", "MiB/s", "failed");
+
+	bool ok = true;
+
+	const int inFlight[] = { 1, 4, 16, 64 };
+	for(int count : inFlight)
+		ok &= run(url, requests, count);
+
+	Log::close();
+
+	return ok ? 0 : 1;
+
+} // main
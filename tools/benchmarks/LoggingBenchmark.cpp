@@ -0,0 +1,119 @@
+//
+// Measures what logging costs the loading path at the Info and Debug reporting levels.
+//
+// usage: bench_logging [messages] [games]
+//
+// First logs the given number of the messages parseGamelist and findOrCreateFile write, at both reporting
+// levels. It reports the time the logging thread spends per message and the time until the writer thread has
+// them in the file. Then it loads a generated gamelist of the given size at both levels. At the Debug level the
+// writer echoes every message to stderr like --debug does, stderr is sent to /dev/null to keep the terminal
+// out of the numbers.
+//
+
+#include "BenchmarkUtil.h"
+#include "GamelistWriter.h"
+#include "Log.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <stdio.h>
+#include <string>
+
+static const char* getLevelName(LogLevel _level)
+{
+	return (_level == LogDebug) ? "Debug" : "Info";
+
+} // getLevelName
+
+static void logMessages(LogLevel _reportingLevel, LogLevel _messageLevel, int _messages)
+{
+	Log::setReportingLevel(_reportingLevel);
+	Log::flush();
+
+	const std::string systemPath = "/home/pi/RetroPie/roms/snes";
+
+	Benchmark::Stopwatch stopwatch;
+
+	for(int i = 0; i < _messages; ++i)
+	{
+		const std::string path = systemPath + "/Hacks/Some Game Title " + std::to_string(i) + " (USA) (Rev 1).sfc";
+
+		// LOG is an if without braces, an else would bind to it
+		if(_messageLevel == LogDebug)
+		{
+			LOG(LogDebug) << "file " << path << " found in gamelist, but has unregistered extension";
+		}
+		else
+		{
+			LOG(LogInfo) << "Parsing XML file \"" << path << "\"...";
+		}
+	}
+
+	const double queuedMs = stopwatch.getMs();
+	Log::flush();
+	const double writtenMs = stopwatch.getMs();
+
+	printf("%-10s %-10s %10d %12.1f %12.1f\n", getLevelName(_reportingLevel), getLevelName(_messageLevel), _messages,
+		queuedMs * 1000000.0 / _messages, writtenMs * 1000000.0 / _messages);
+
+} // logMessages
+
+static void loadGamelist(LogLevel _reportingLevel, const std::string& _home, int _games)
+{
+	const std::string name = "bench" + std::to_string(_games);
+
+	SystemEnvironmentData env;
+	env.mStartPath = _home + "/roms/" + name;
+	env.mSearchExtensions.push_back(".sfc");
+
+	Utils::FileSystem::createDirectory(env.mStartPath);
+	if(!Benchmark::writeGeneratedGamelist(env.mStartPath + "/gamelist.xml", _games))
+	{
+		printf("could not write the gamelist of %s\n", name.c_str());
+		return;
+	}
+
+	Log::setReportingLevel(_reportingLevel);
+	Log::flush();
+
+	Benchmark::Stopwatch stopwatch;
+	SystemData*          system = new SystemData(name, name, &env, "", false);
+	const double         loadMs = stopwatch.getMs();
+	Log::flush();
+	const double writtenMs = stopwatch.getMs();
+
+	printf("%-10s %10d %12.1f %12.1f\n", getLevelName(_reportingLevel), _games, loadMs, writtenMs);
+
+	delete system;
+
+} // loadGamelist
+
+int main(int argc, char* argv[])
+{
+	const std::string home     = Benchmark::setScratchHome("bench_logging");
+	const int         messages = Benchmark::getArgument(argc, argv, 1, 200000);
+	const int         games    = Benchmark::getArgument(argc, argv, 2, 10000);
+
+	if(!freopen("/dev/null", "w", stderr))
+		printf("could not send stderr to /dev/null, the Debug numbers include the terminal\n");
+
+	Log::open();
+
+	Settings::getInstance()->setBool("ParseGamelistOnly", true);
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+
+	printf("%-10s %-10s %10s %12s %12s\n", "reporting", "message", "messages", "ns queued", "ns written");
+	logMessages(LogInfo,  LogInfo,  messages);
+	logMessages(LogInfo,  LogDebug, messages);
+	logMessages(LogDebug, LogInfo,  messages);
+	logMessages(LogDebug, LogDebug, messages);
+
+	printf("\n%-10s %10s %12s %12s\n", "reporting", "games", "load ms", "written ms");
+	loadGamelist(LogInfo,  home, games);
+	loadGamelist(LogDebug, home, games);
+
+	GamelistWriter::deinit();
+	Log::close();
+
+	return 0;
+
+} // main
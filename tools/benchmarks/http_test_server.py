@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""
+Minimal local HTTP server for bench_http.
+
+Answers every GET with a body of --size bytes after waiting --latency-ms, which stands in for the round trip
+to a scraper API. Connections are kept alive (HTTP/1.1 with Content-Length), so connection reuse by the client
+shows in the numbers. Plain HTTP only, TLS session reuse and HTTP/2 are not covered.
+
+Usage: http_test_server.py [--port 8000] [--size 16384] [--latency-ms 20]
+"""
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+import argparse
+import time
+
+parser = argparse.ArgumentParser(description="Minimal local HTTP server for bench_http")
+parser.add_argument("--port", type=int, default=8000)
+parser.add_argument("--size", type=int, default=16384, help="bytes per response body")
+parser.add_argument("--latency-ms", type=int, default=20, help="delay before each response")
+args = parser.parse_args()
+
+body = bytes(i % 251 for i in range(args.size))
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        if args.latency_ms > 0:
+            time.sleep(args.latency_ms / 1000.0)
+
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        pass
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+    request_queue_size = 128
+
+
+print(f"Serving {args.size} bytes with {args.latency_ms} ms latency on http://127.0.0.1:{args.port}/")
+Server(("127.0.0.1", args.port), Handler).serve_forever()
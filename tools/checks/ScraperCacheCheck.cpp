@@ -0,0 +1,289 @@
+//
+// Checks ScraperCache on its own and behind the image downloads, against scraper_standin_server.py.
+//
+// usage: check_scraper_cache [server]
+//
+// The server defaults to http://127.0.0.1:8001. getKey() and the response cache are checked directly: which
+// parameters count as credentials, hits within the TTL, the ETag handed out once stale, the index surviving
+// deinit()/init() and the least recently used files going first when the cache outgrows ScraperCacheSize.
+// Images are fetched with downloadImageAsync() like the scrapers do, the server log shows whether a download
+// was served from the cache, revalidated with a 304 or fetched again after the server changed the image.
+//
+
+#include "scrapers/Scraper.h"
+#include "scrapers/ScraperCache.h"
+#include "GamelistWriter.h"
+#include "Log.h"
+#include "ScraperCheck.h"
+#include "Settings.h"
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdio.h>
+#include <string>
+
+#define TIMEOUT_MS      10000
+#define EVICT_BLOB_SIZE (300 * 1024)
+
+static const std::string sUrl      = "https://api.example.com/api2/jeuInfos.php?devid=dev&devpassword=secret&softname=es&output=xml&ssid=user&sspassword=pass&romnom=Super%20Mario%20World%20(USA).sfc";
+static const std::string sOtherUrl = "https://api.example.com/api2/jeuInfos.php?devid=dev2&devpassword=other&softname=es&output=xml&ssid=user2&sspassword=word&romnom=Super%20Mario%20World%20(USA).sfc";
+
+// Recreates the cache so it picks up changed settings, the index is written and read again on the way
+static ScraperCache* restartCache()
+{
+	ScraperCache::deinit();
+	ScraperCache::init();
+	return ScraperCache::getInstance();
+
+} // restartCache
+
+static std::string readFile(const std::string& _path)
+{
+	std::ifstream stream(_path, std::ios_base::in | std::ios_base::binary);
+	return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+} // readFile
+
+static size_t getCacheSize(const std::string& _home)
+{
+	size_t size = 0;
+
+	Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(_home + "/.emulationstation/scrapers", true);
+	for(auto it = files.cbegin(); it != files.cend(); ++it)
+	{
+		if(Utils::FileSystem::isRegularFile(*it) && (Utils::FileSystem::getFileName(*it) != "index"))
+			size += readFile(*it).size();
+	}
+
+	return size;
+
+} // getCacheSize
+
+static int countFiles(const std::string& _path)
+{
+	Utils::FileSystem::stringList files = Utils::FileSystem::getDirContent(_path);
+	return (int)files.size();
+
+} // countFiles
+
+// Downloads _url to _path the way the scrapers do, returns false if that failed or timed out
+static bool download(const std::string& _url, const std::string& _path)
+{
+	std::unique_ptr<ImageDownloadHandle> handle = downloadImageAsync(_url, _path);
+
+	const auto start = std::chrono::steady_clock::now();
+	while((handle->status() == ASYNC_IN_PROGRESS) && ((std::chrono::steady_clock::now() - start) < std::chrono::milliseconds(TIMEOUT_MS)))
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	if(handle->status() != ASYNC_DONE)
+	{
+		printf("   download of %s failed: %s\n", _url.c_str(), handle->getStatusString().c_str());
+		return false;
+	}
+
+	return true;
+
+} // download
+
+static void checkKey()
+{
+	printf("getKey()\n");
+
+	CHECK(ScraperCache::getKey(sUrl) == "https://api.example.com/api2/jeuInfos.php?softname=es&output=xml&romnom=Super%20Mario%20World%20(USA).sfc");
+	CHECK(ScraperCache::getKey(sUrl) == ScraperCache::getKey(sOtherUrl));
+	CHECK(ScraperCache::getKey("https://api.example.com/v1/Genres?apikey=123") == "https://api.example.com/v1/Genres");
+	CHECK(ScraperCache::getKey("https://api.example.com/v1/Games/ByGameName?apikey=123&name=Donkey%20Kong") == "https://api.example.com/v1/Games/ByGameName?name=Donkey%20Kong");
+	CHECK(ScraperCache::getKey("https://api.example.com/v1/Games/ByGameName?name=Donkey%20Kong&apikey=123") == "https://api.example.com/v1/Games/ByGameName?name=Donkey%20Kong");
+
+	// only whole parameter names are credentials, everything else stays as it was
+	CHECK(ScraperCache::getKey("https://api.example.com/search?apikeys=1&ssidx=2&name=a") == "https://api.example.com/search?apikeys=1&ssidx=2&name=a");
+	CHECK(ScraperCache::getKey("https://example.com/images/large/boxart.png") == "https://example.com/images/large/boxart.png");
+	CHECK(ScraperCache::getKey("https://api.example.com/search?name=a&name=b") == "https://api.example.com/search?name=a&name=b");
+	CHECK(ScraperCache::getKey("https://api.example.com/search?name=a&name=b") != ScraperCache::getKey("https://api.example.com/search?name=a"));
+
+} // checkKey
+
+static void checkResponses()
+{
+	printf("responses\n");
+
+	Settings::getInstance()->setInt("ScraperCacheTTL", 24);
+	ScraperCache* cache = restartCache();
+
+	std::string content;
+	std::string etag;
+
+	CHECK(!cache->getResponse(sUrl, content, etag));
+	CHECK(etag.empty());
+
+	cache->putResponse(sUrl, "<Data>cached</Data>", "\"v1\"");
+
+	// other credentials ask for the same thing
+	CHECK(cache->getResponse(sOtherUrl, content, etag));
+	CHECK(content == "<Data>cached</Data>");
+	CHECK(etag.empty());
+
+	// still there after the index was written and read again
+	cache = restartCache();
+	content.clear();
+	CHECK(cache->getResponse(sUrl, content, etag));
+	CHECK(content == "<Data>cached</Data>");
+
+	// once stale the ETag is handed out, a 304 then confirms the cached content
+	Settings::getInstance()->setInt("ScraperCacheTTL", 0);
+	cache = restartCache();
+	content.clear();
+	CHECK(!cache->getResponse(sUrl, content, etag));
+	CHECK(content.empty());
+	CHECK(etag == "\"v1\"");
+	CHECK(cache->revalidateResponse(sUrl, content));
+	CHECK(content == "<Data>cached</Data>");
+
+	// nothing to revalidate what was never stored
+	etag.clear();
+	CHECK(!cache->getResponse("https://api.example.com/unknown", content, etag));
+	CHECK(etag.empty());
+	CHECK(!cache->revalidateResponse("https://api.example.com/unknown", content));
+
+	Settings::getInstance()->setInt("ScraperCacheTTL", 24);
+
+} // checkResponses
+
+static void checkEviction(const std::string& _home)
+{
+	printf("eviction\n");
+
+	Settings::getInstance()->setInt("ScraperCacheSize", 1);
+	ScraperCache* cache = restartCache();
+
+	// last used times have a resolution of seconds, the waits keep the order of use unambiguous
+	const std::string content(EVICT_BLOB_SIZE, 'x');
+	std::string       read;
+	std::string       etag;
+
+	for(int i = 0; i < 3; ++i)
+		cache->putResponse("https://api.example.com/evict?n=" + std::to_string(i), content, "");
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	CHECK(cache->getResponse("https://api.example.com/evict?n=0", read, etag));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+	for(int i = 3; i < 5; ++i)
+		cache->putResponse("https://api.example.com/evict?n=" + std::to_string(i), content, "");
+
+	// the two least recently used went, the one read in between stayed
+	CHECK(!cache->getResponse("https://api.example.com/evict?n=1", read, etag));
+	CHECK(!cache->getResponse("https://api.example.com/evict?n=2", read, etag));
+	CHECK(etag.empty());
+	CHECK(cache->getResponse("https://api.example.com/evict?n=0", read, etag));
+	CHECK(cache->getResponse("https://api.example.com/evict?n=3", read, etag));
+	CHECK(cache->getResponse("https://api.example.com/evict?n=4", read, etag));
+	CHECK(read == content);
+
+	CHECK(getCacheSize(_home) <= 1024 * 1024);
+	printf("   %u KiB on disk\n", (unsigned int)(getCacheSize(_home) / 1024));
+
+	Settings::getInstance()->setInt("ScraperCacheSize", 100);
+
+} // checkEviction
+
+static void checkMedia(const std::string& _home, const std::string& _server)
+{
+	printf("media\n");
+
+	const std::string url       = _server + "/images/large/cache-check.png";
+	const std::string imagePath = _home + "/images";
+	const std::string mediaPath = _home + "/.emulationstation/scrapers/media";
+
+	Utils::FileSystem::createDirectory(imagePath);
+	Settings::getInstance()->setInt("ScraperCacheMediaTTL", 24);
+	ScraperCache* cache = restartCache();
+
+	// first download goes to the server
+	ScraperCheck::takeServerLog(_server);
+	CHECK(download(url, imagePath + "/a.png"));
+	std::string log = ScraperCheck::takeServerLog(_server);
+	CHECK(ScraperCheck::countLines(log, "200 /images/large/cache-check.png") == 1);
+
+	const std::string original = readFile(imagePath + "/a.png");
+	CHECK(!original.empty());
+
+	// the same image for another file comes from the cache, a file already written from it needs nothing at all
+	CHECK(download(url, imagePath + "/b.png"));
+	CHECK(download(url, imagePath + "/a.png"));
+	CHECK(ScraperCheck::takeServerLog(_server).empty());
+	CHECK(readFile(imagePath + "/b.png") == original);
+	CHECK(cache->isMediaWritten(url, imagePath + "/a.png"));
+	CHECK(!cache->isMediaWritten(url, imagePath + "/c.png"));
+
+	// the same content behind another URL is stored once
+	const int files = countFiles(mediaPath);
+	CHECK(files > 0);
+	cache->putMedia(_server + "/images/large/same-content.png", original, "");
+	CHECK(countFiles(mediaPath) == files);
+
+	// once stale it is revalidated with its ETag, the server confirms it
+	Settings::getInstance()->setInt("ScraperCacheMediaTTL", 0);
+	cache = restartCache();
+	CHECK(!cache->isMediaWritten(url, imagePath + "/a.png"));
+	CHECK(download(url, imagePath + "/c.png"));
+	log = ScraperCheck::takeServerLog(_server);
+	CHECK(ScraperCheck::countLines(log, "304 /images/large/cache-check.png") == 1);
+	CHECK(ScraperCheck::countLines(log, "200 ") == 0);
+	CHECK(readFile(imagePath + "/c.png") == original);
+
+	// after the image changed on the server the revalidation downloads and stores the new one
+	std::string generation;
+	CHECK(ScraperCheck::fetch(_server + "/_media?bump=1", generation));
+	CHECK(download(url, imagePath + "/d.png"));
+	log = ScraperCheck::takeServerLog(_server);
+	CHECK(ScraperCheck::countLines(log, "200 /images/large/cache-check.png") == 1);
+
+	const std::string changed = readFile(imagePath + "/d.png");
+	CHECK(!changed.empty());
+	CHECK(changed != original);
+
+	std::string content;
+	std::string etag;
+	CHECK(!cache->getMedia(url, content, etag));
+	CHECK(!etag.empty());
+	CHECK(cache->revalidateMedia(url, content));
+	CHECK(content == changed);
+
+	Settings::getInstance()->setInt("ScraperCacheMediaTTL", 30 * 24);
+
+} // checkMedia
+
+int main(int argc, char* argv[])
+{
+	const std::string home   = ScraperCheck::setScratchHome("check_scraper_cache");
+	const std::string server = (argc > 1) ? argv[1] : "http://127.0.0.1:8001";
+
+	Log::open();
+	Log::setReportingLevel(LogWarning);
+
+	std::string log;
+	if(!ScraperCheck::fetch(server + "/_log?reset=1", log))
+	{
+		printf("The stand-in server does not answer at %s, start tools/checks/scraper_standin_server.py first\n", server.c_str());
+		return 2;
+	}
+
+	// the images are checked byte for byte, they must not be resized on the way
+	Settings::getInstance()->setInt("ScraperResizeWidth", 0);
+	Settings::getInstance()->setInt("ScraperResizeHeight", 0);
+
+	checkKey();
+	checkResponses();
+	checkEviction(home);
+	checkMedia(home, server);
+
+	ScraperCache::deinit();
+	GamelistWriter::deinit();
+	Log::close();
+
+	printf("%s\n", ScraperCheck::getFailures() ? "FAILED" : "passed");
+
+	return ScraperCheck::getFailures() ? 1 : 0;
+
+} // main
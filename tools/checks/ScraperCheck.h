@@ -0,0 +1,97 @@
+#pragma once
+#ifndef TOOLS_CHECKS_SCRAPER_CHECK_H
+#define TOOLS_CHECKS_SCRAPER_CHECK_H
+
+#include "utils/FileSystemUtil.h"
+#include "HttpReq.h"
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <thread>
+
+// Reports a failed condition and counts it, the check goes on so one run shows every failure
+#define CHECK(_condition) ScraperCheck::check((_condition), #_condition, __FILE__, __LINE__)
+
+namespace ScraperCheck
+{
+	inline int& getFailures()
+	{
+		static int failures = 0;
+		return failures;
+
+	} // getFailures
+
+	inline bool check(bool _passed, const char* _condition, const char* _file, int _line)
+	{
+		if(!_passed)
+		{
+			printf("FAILED %s:%d: %s\n", _file, _line, _condition);
+			++getFailures();
+		}
+
+		return _passed;
+
+	} // check
+
+	// Points the home path at a scratch folder next to the working directory, so settings, the scraper cache,
+	// images and gamelists never touch the real ~/.emulationstation. Must run before anything asks for the
+	// home path, the first answer is cached.
+	inline std::string setScratchHome(const std::string& _name)
+	{
+		const std::string home = Utils::FileSystem::getCWDPath() + "/" + _name;
+
+		Utils::FileSystem::createDirectory(home + "/.emulationstation");
+		Utils::FileSystem::setHomePath(home);
+
+		return home;
+
+	} // setScratchHome
+
+	// Blocks until _url was fetched, returns false if the request failed
+	inline bool fetch(const std::string& _url, std::string& _content)
+	{
+		HttpReq req(_url);
+
+		while(req.status() == HttpReq::REQ_IN_PROGRESS)
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+		if(req.status() != HttpReq::REQ_SUCCESS)
+			return false;
+
+		_content = req.getContent();
+		return true;
+
+	} // fetch
+
+	// The requests the stand-in server answered since the last call, one "<code> <path and query>" line each
+	inline std::string takeServerLog(const std::string& _server)
+	{
+		std::string log;
+		fetch(_server + "/_log?reset=1", log);
+		return log;
+
+	} // takeServerLog
+
+	inline int countLines(const std::string& _log, const std::string& _part)
+	{
+		int count = 0;
+
+		for(size_t start = 0; start < _log.size(); )
+		{
+			size_t end = _log.find('\n', start);
+			if(end == std::string::npos)
+				end = _log.size();
+
+			if(_log.substr(start, end - start).find(_part) != std::string::npos)
+				++count;
+
+			start = end + 1;
+		}
+
+		return count;
+
+	} // countLines
+
+} // ScraperCheck::
+
+#endif // TOOLS_CHECKS_SCRAPER_CHECK_H
@@ -0,0 +1,239 @@
+//
+// Drives ScraperPipeline against scraper_standin_server.py with both scrapers.
+//
+// usage: check_scraper_pipeline [server]
+//
+// The server defaults to http://127.0.0.1:8001 and is set as ScraperHostOverride. For each scraper a system of
+// ten roms is scraped, two of them have canned responses, the others are unknown to the server. The first run
+// calls stop() right after the first update(), while the searches are still waiting on the server, and commits
+// whatever was done. The second run goes through update() until everything is done and commits once.
+// run_checks.sh starts the server, runs the checks in a fresh scratch folder and stops it again.
+//
+
+#include "scrapers/ScraperCache.h"
+#include "scrapers/ScraperPipeline.h"
+#include "utils/StringUtil.h"
+#include "FileData.h"
+#include "GamelistWriter.h"
+#include "Log.h"
+#include "ScraperCheck.h"
+#include "Settings.h"
+#include "SystemData.h"
+#include <pugixml.hpp>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define TIMEOUT_MS       30000
+#define UPDATE_PERIOD_MS 10
+#define UNKNOWN_ROMS     8
+
+// rom file name -> name in the canned responses of both scrapers
+static const std::map<std::string, std::string> sCannedGames =
+{
+	{ "Super Mario World (USA).sfc",            "Super Mario World"   },
+	{ "Donkey Kong Country (USA) (Rev 2).sfc",  "Donkey Kong Country" },
+};
+
+static SystemData* createSystem(const std::string& _home, const std::string& _name)
+{
+	// the system keeps a pointer to it for its whole life
+	SystemEnvironmentData* env = new SystemEnvironmentData;
+	env->mStartPath = _home + "/roms/" + _name;
+	env->mSearchExtensions.push_back(".sfc");
+	env->mPlatformIds.push_back(PlatformIds::SUPER_NINTENDO);
+
+	Utils::FileSystem::createDirectory(env->mStartPath);
+
+	std::vector<std::string> roms;
+	for(auto it = sCannedGames.cbegin(); it != sCannedGames.cend(); ++it)
+		roms.push_back(it->first);
+	for(int i = 0; i < UNKNOWN_ROMS; ++i)
+		roms.push_back("Unknown Homebrew " + std::to_string(i) + " (PD).sfc");
+
+	for(auto it = roms.cbegin(); it != roms.cend(); ++it)
+	{
+		FILE* file = fopen((env->mStartPath + "/" + *it).c_str(), "w");
+		if(file)
+			fclose(file);
+	}
+
+	return new SystemData(_name, "Super Nintendo", env, "", false);
+
+} // createSystem
+
+static std::queue<ScraperSearchParams> getSearches(SystemData* _system)
+{
+	std::queue<ScraperSearchParams> searches;
+
+	std::vector<FileData*> games = _system->getRootFolder()->getFilesRecursive(GAME);
+	for(auto it = games.cbegin(); it != games.cend(); ++it)
+	{
+		ScraperSearchParams params;
+		params.system = _system;
+		params.game   = *it;
+		searches.push(params);
+	}
+
+	return searches;
+
+} // getSearches
+
+// The games with a description in the written gamelist. The path is asked for as for writing, the one for
+// reading may have been looked up before the file existed and Utils::FileSystem::exists() remembers that
+static int countScrapedInGamelist(SystemData* _system)
+{
+	pugi::xml_document doc;
+	if(!CHECK(doc.load_file(_system->getGamelistPath(true).c_str())))
+		return -1;
+
+	int scraped = 0;
+	for(pugi::xml_node node = doc.child("gameList").child("game"); node; node = node.next_sibling("game"))
+	{
+		if(!node.child("desc").text().empty())
+			++scraped;
+	}
+
+	return scraped;
+
+} // countScrapedInGamelist
+
+static void checkScrapedGame(FileData* _game)
+{
+	auto canned = sCannedGames.find(Utils::FileSystem::getFileName(_game->getPath()));
+	if(!CHECK(canned != sCannedGames.cend()))
+		return;
+
+	CHECK(_game->metadata.get("name") == canned->second);
+	CHECK(!_game->metadata.get("desc").empty());
+	CHECK(!_game->metadata.get("image").empty());
+	CHECK(Utils::FileSystem::isRegularFile(_game->metadata.get("image")));
+
+} // checkScrapedGame
+
+static void checkStopped(const std::string& _home, const std::string& _server, const std::string& _scraper)
+{
+	printf("%s: stop() while searching\n", _scraper.c_str());
+
+	SystemData* system    = createSystem(_home, "snes-stop-" + Utils::String::toLower(_scraper));
+	int         completed = 0;
+	int         scraped   = 0;
+
+	ScraperPipeline pipeline(getSearches(system));
+	pipeline.setCompletedCallback([&completed, &scraped](const ScraperSearchParams& _params, bool _scraped)
+	{
+		++completed;
+		if(_scraped)
+		{
+			++scraped;
+			checkScrapedGame(_params.game);
+		}
+	});
+
+	ScraperCheck::takeServerLog(_server);
+
+	pipeline.update();
+	CHECK(pipeline.getInFlightCount() > 0);
+
+	pipeline.stop();
+	CHECK(pipeline.isDone());
+	CHECK(pipeline.getInFlightCount() == 0);
+	CHECK(pipeline.getCompletedCount() == (unsigned int)completed);
+	CHECK(pipeline.getSuccessfulCount() == (unsigned int)scraped);
+	CHECK(pipeline.getCompletedCount() < pipeline.getTotalCount());
+
+	// further updates have nothing left to do
+	pipeline.update();
+	CHECK(pipeline.isDone());
+	CHECK(pipeline.getCompletedCount() == (unsigned int)completed);
+
+	pipeline.commit();
+	CHECK(GamelistWriter::getInstance()->flush(system));
+	if(scraped > 0)
+		CHECK(countScrapedInGamelist(system) == scraped);
+
+	printf("   %d of %u done before stop(), %d scraped\n", completed, pipeline.getTotalCount(), scraped);
+
+} // checkStopped
+
+static void checkCompleted(const std::string& _home, const std::string& _server, const std::string& _scraper)
+{
+	printf("%s: update() until done\n", _scraper.c_str());
+
+	SystemData* system    = createSystem(_home, "snes-" + Utils::String::toLower(_scraper));
+	int         completed = 0;
+
+	ScraperPipeline pipeline(getSearches(system));
+	pipeline.setCompletedCallback([&completed](const ScraperSearchParams& _params, bool _scraped)
+	{
+		++completed;
+		if(_scraped)
+			checkScrapedGame(_params.game);
+	});
+
+	ScraperCheck::takeServerLog(_server);
+
+	const auto start = std::chrono::steady_clock::now();
+	while(!pipeline.isDone() && ((std::chrono::steady_clock::now() - start) < std::chrono::milliseconds(TIMEOUT_MS)))
+	{
+		pipeline.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_PERIOD_MS));
+	}
+
+	CHECK(pipeline.isDone());
+	CHECK(pipeline.getTotalCount() == sCannedGames.size() + UNKNOWN_ROMS);
+	CHECK(pipeline.getSuccessfulCount() == sCannedGames.size());
+	CHECK(pipeline.getSkippedCount() == UNKNOWN_ROMS);
+	CHECK(completed == (int)pipeline.getTotalCount());
+
+	// every image was downloaded once, nothing is written before commit()
+	const std::string log = ScraperCheck::takeServerLog(_server);
+	CHECK(ScraperCheck::countLines(log, (_scraper == "ScreenScraper") ? "/api2/mediaJeu.php" : "/images/large/") == (int)sCannedGames.size());
+	CHECK(!Utils::FileSystem::isRegularFile(system->getGamelistPath(true)));
+
+	pipeline.commit();
+	CHECK(GamelistWriter::getInstance()->flush(system));
+	CHECK(countScrapedInGamelist(system) == (int)sCannedGames.size());
+
+	printf("   %u scraped, %u skipped\n", pipeline.getSuccessfulCount(), pipeline.getSkippedCount());
+
+} // checkCompleted
+
+int main(int argc, char* argv[])
+{
+	const std::string home   = ScraperCheck::setScratchHome("check_scraper_pipeline");
+	const std::string server = (argc > 1) ? argv[1] : "http://127.0.0.1:8001";
+
+	Log::open();
+	Log::setReportingLevel(LogWarning);
+
+	std::string log;
+	if(!ScraperCheck::fetch(server + "/_log?reset=1", log))
+	{
+		printf("The stand-in server does not answer at %s, start tools/checks/scraper_standin_server.py first\n", server.c_str());
+		return 2;
+	}
+
+	Settings::getInstance()->setString("ScraperHostOverride", server);
+	Settings::getInstance()->setInt("ScraperHostInterval", 0);
+	Settings::getInstance()->setString("SaveGamelistsMode", "never");
+
+	const char* scrapers[] = { "ScreenScraper", "TheGamesDB" };
+	for(const char* scraper : scrapers)
+	{
+		Settings::getInstance()->setString("Scraper", scraper);
+
+		checkStopped(home, server, scraper);
+		checkCompleted(home, server, scraper);
+	}
+
+	ScraperCache::deinit();
+	GamelistWriter::deinit();
+	Log::close();
+
+	printf("%s\n", ScraperCheck::getFailures() ? "FAILED" : "passed");
+
+	return ScraperCheck::getFailures() ? 1 : 0;
+
+} // main
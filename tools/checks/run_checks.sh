@@ -0,0 +1,39 @@
+#!/bin/bash
+# Runs the scraper checks against the stand-in server.
+#
+# usage: run_checks.sh <directory with the check binaries> [port]
+#
+# Starts scraper_standin_server.py, runs every check_* binary in a fresh scratch folder below the build
+# directory and stops the server again. Exits non-zero if a check failed.
+
+CHECKS_DIR=$(cd "${1:?usage: run_checks.sh <directory with the check binaries> [port]}" && pwd)
+PORT=${2:-8001}
+SERVER="http://127.0.0.1:${PORT}"
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+
+python3 "${SCRIPT_DIR}/scraper_standin_server.py" --port "${PORT}" &
+SERVER_PID=$!
+trap 'kill ${SERVER_PID} 2>/dev/null' EXIT
+
+# wait for the server to listen
+for i in $(seq 50); do
+    python3 -c "import urllib.request; urllib.request.urlopen('${SERVER}/_log')" 2>/dev/null && break
+    sleep 0.1
+done
+
+failed=0
+for check in "${CHECKS_DIR}"/check_*; do
+    [ -x "${check}" ] || continue
+
+    name=$(basename "${check}")
+    work="${CHECKS_DIR}/work/${name}"
+    rm -rf "${work}"
+    mkdir -p "${work}"
+
+    echo "== ${name}"
+    if ! (cd "${work}" && "${check}" "${SERVER}"); then
+        failed=1
+    fi
+done
+
+exit ${failed}
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""
+Stand-in for the ScreenScraper and TheGamesDB APIs, serving the canned responses in responses/.
+
+Point the scrapers at it with the ScraperHostOverride setting, e.g. "http://127.0.0.1:8001". Scheme and host of
+every API URL are replaced by it, the paths stay the same:
+
+* /api2/jeuInfos.php?...&romnom=<rom file name>     responses/screenscraper/<rom file name without extension>.xml,
+                                                     HTTP 404 like the real API if there is none
+* /v1/Games/ByGameName?...&name=<clean name>        responses/thegamesdb/games/<clean name>.json,
+                                                     an empty result if there is none
+* /v1/Genres, /v1/Developers, /v1/Publishers        responses/thegamesdb/<Endpoint>.json
+* /api2/mediaJeu.php?...&media=..., /images/...     a small PNG generated from the URL, with an ETag.
+                                                     If-None-Match with the current ETag is answered with 304
+
+"{base}" in a canned response is replaced with the server's own URL, so media URLs lead back to it.
+
+Control endpoints for the checks, not logged themselves:
+
+* /_log               every request since the last reset, one "<code> <path and query>" line each
+* /_log?reset=1       the same, then clears the log
+* /_media?bump=1      changes every generated image and its ETag, revalidations then get a 200
+
+API answers wait --latency-ms first, like a remote server would, so requests are still in flight when a check
+stops the pipeline.
+
+Usage: scraper_standin_server.py [--port 8001] [--latency-ms 50]
+"""
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlsplit, parse_qs
+import argparse
+import hashlib
+import os
+import struct
+import threading
+import time
+import zlib
+
+parser = argparse.ArgumentParser(description="Stand-in for the ScreenScraper and TheGamesDB APIs")
+parser.add_argument("--port", type=int, default=8001)
+parser.add_argument("--latency-ms", type=int, default=50, help="delay before each API answer")
+parser.add_argument("--responses", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "responses"))
+args = parser.parse_args()
+
+base = f"http://127.0.0.1:{args.port}"
+lock = threading.Lock()
+log = []
+generation = 0
+
+EMPTY_GAMESDB_RESULT = """{
+	"code": 200,
+	"status": "Success",
+	"data": { "count": 0, "games": [] },
+	"include": { "boxart": { "base_url": { "original": "{base}/images/original", "thumb": "{base}/images/thumb", "large": "{base}/images/large" }, "data": {} } }
+}"""
+
+
+def make_png(seed):
+    """An 8x8 single colour PNG, the colour taken from seed."""
+    color = hashlib.sha1(seed.encode()).digest()[:3]
+    rows = b"".join(b"\x00" + color * 8 for _ in range(8))
+
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data) & 0xffffffff)
+
+    return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", struct.pack(">IIBBBBB", 8, 8, 8, 2, 0, 0, 0)) +
+            chunk(b"IDAT", zlib.compress(rows)) + chunk(b"IEND", b""))
+
+
+def read_response(*parts):
+    path = os.path.join(args.responses, *parts)
+    if not os.path.isfile(path):
+        return None
+    with open(path, encoding="utf-8") as f:
+        return f.read().replace("{base}", base)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        url = urlsplit(self.path)
+        query = parse_qs(url.query)
+
+        if url.path == "/_log":
+            with lock:
+                text = "".join(line + "\n" for line in log)
+                if "reset" in query:
+                    log.clear()
+            return self.reply(200, text.encode(), "text/plain", record=False)
+
+        if url.path == "/_media":
+            global generation
+            with lock:
+                if "bump" in query:
+                    generation += 1
+                text = f"{generation}\n"
+            return self.reply(200, text.encode(), "text/plain", record=False)
+
+        if url.path == "/api2/mediaJeu.php" or url.path.startswith("/images/"):
+            return self.media()
+
+        time.sleep(args.latency_ms / 1000.0)
+
+        if url.path == "/api2/jeuInfos.php":
+            romnom = query.get("romnom", [""])[0]
+            content = read_response("screenscraper", os.path.splitext(romnom)[0] + ".xml")
+            if content is None:
+                return self.reply(404, "Erreur : Rom/Iso/Dossier non trouvée !".encode(), "text/plain")
+            return self.reply(200, content.encode(), "text/xml")
+
+        if url.path in ("/v1/Games/ByGameName", "/v1/Games/ByGameID"):
+            name = query.get("name", [""])[0]
+            content = read_response("thegamesdb", "games", name + ".json") if name else None
+            if content is None:
+                content = EMPTY_GAMESDB_RESULT.replace("{base}", base)
+            return self.reply(200, content.encode(), "application/json")
+
+        if url.path in ("/v1/Genres", "/v1/Developers", "/v1/Publishers"):
+            content = read_response("thegamesdb", url.path[len("/v1/"):] + ".json")
+            return self.reply(200, content.encode(), "application/json")
+
+        self.reply(404, b"not found", "text/plain")
+
+    def media(self):
+        with lock:
+            seed = f"{generation}:{self.path}"
+        body = make_png(seed)
+        etag = '"' + hashlib.sha1(body).hexdigest()[:16] + '"'
+
+        if self.headers.get("If-None-Match") == etag:
+            return self.reply(304, b"", None, etag)
+        self.reply(200, body, "image/png", etag)
+
+    def reply(self, code, body, content_type, etag=None, record=True):
+        if record:
+            with lock:
+                log.append(f"{code} {self.path}")
+
+        self.send_response(code)
+        if content_type:
+            self.send_header("Content-Type", content_type)
+        if etag:
+            self.send_header("ETag", etag)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        pass
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+
+
+print(f"Scraper stand-in serving {args.responses} on {base}/", flush=True)
+Server(("127.0.0.1", args.port), Handler).serve_forever()